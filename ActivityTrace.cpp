@@ -0,0 +1,301 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include "Param.h"
+#include "NeuroSim.h"
+#include "IO.h"
+#include "Simulator.h"
+#include "ActivityTrace.h"
+
+static_assert(sizeof(ActivityTraceHeader) % 8 == 0 && sizeof(ActivityTraceLayer) % 8 == 0 && sizeof(ActivitySection) % 8 == 0 && sizeof(ActivityRecord) % 8 == 0,
+		"Activity trace records must keep the doubles aligned");
+static_assert(offsetof(ActivityRecord, weight) + sizeof(double) == sizeof(ActivityRecord), "ActivityRecord::weight must be the last field");
+
+ActivityTrace::ActivityTrace() {
+	fp = NULL;
+}
+
+ActivityTrace::~ActivityTrace() {
+	Close();
+}
+
+/* The weight is not part of the key, so identical events share one record */
+bool ActivityTrace::RecordLess::operator()(const ActivityRecord& a, const ActivityRecord& b) const {
+	return memcmp(&a, &b, offsetof(ActivityRecord, weight)) < 0;
+}
+
+/* Start a trace (after Simulator::Initialize, which sets the final param->numColMuxed) */
+void ActivityTrace::Open(const char *fileName, const Param& param, const std::vector<Layer*>& layers) {
+	Close();
+	fp = fopen(fileName, "wb");
+	if (!fp) {
+		printf("[ActivityTrace] Error: cannot open %s\n", fileName);
+		exit(-1);
+	}
+	ActivityTraceHeader header;
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, ACTIVITY_TRACE_MAGIC);
+	header.version = ACTIVITY_TRACE_VERSION;
+	header.headerSize = sizeof(ActivityTraceHeader);
+	header.sectionSize = sizeof(ActivitySection);
+	header.recordSize = sizeof(ActivityRecord);
+	header.layerSize = sizeof(ActivityTraceLayer);
+	header.numLayers = layers.size();
+	header.numBitInput = param.numBitInput;
+	header.numWeightBit = param.numWeightBit;
+	header.numWriteColMuxed = param.numWriteColMuxed;
+	header.useHardwareInTraining = param.useHardwareInTraining;
+	header.numBitPartialSum = param.numBitPartialSum;
+	header.numColMuxed = param.numColMuxed;
+	std::vector<ActivityTraceLayer> layerRecords(layers.size());
+	for (int l=0; l<layers.size(); l++) {
+		memset(&layerRecords[l], 0, sizeof(ActivityTraceLayer));
+		layerRecords[l].numInput = layers[l]->numInput;
+		layerRecords[l].numOutput = layers[l]->numOutput;
+		layerRecords[l].deviceType = layers[l]->deviceType;
+		layerRecords[l].tileRows = layers[l]->tileRows;
+		layerRecords[l].tileCols = layers[l]->tileCols;
+	}
+	if (fwrite(&header, sizeof(header), 1, fp) != 1
+			|| fwrite(&layerRecords[0], sizeof(ActivityTraceLayer), layerRecords.size(), fp) != layerRecords.size()) {
+		printf("[ActivityTrace] Error: cannot write %s\n", fileName);
+		exit(-1);
+	}
+	events.clear();
+}
+
+void ActivityTrace::AddRead(int layer, double activityRowRead, bool batched, bool timed, double weight) {
+	ActivityRecord record;
+	memset(&record, 0, sizeof(record));	// The padding-free record is compared bytewise
+	record.type = ACTIVITY_READ;
+	record.layer = layer;
+	record.batched = batched;
+	record.timed = timed;
+	record.activityRowRead = activityRowRead;
+	Add(record, weight);
+}
+
+void ActivityTrace::AddWriteRow(int layer, const SubArray *core, int numWriteOperationPerRow, int numWriteCellPerOperation) {
+	ActivityRecord record;
+	memset(&record, 0, sizeof(record));
+	record.type = ACTIVITY_WRITE_ROW;
+	record.layer = layer;
+	record.numWriteOperationPerRow = numWriteOperationPerRow;
+	record.numWriteCellPerOperation = numWriteCellPerOperation;
+	record.numWritePulse = core->numWritePulse;
+	record.writeVoltage = core->cell.writeVoltage;
+	Add(record, 1);
+}
+
+void ActivityTrace::AddWriteArray(int layer, const SubArray *core, double numWriteOperation, double sumWriteLatency) {
+	ActivityRecord record;
+	memset(&record, 0, sizeof(record));
+	record.type = ACTIVITY_WRITE_ARRAY;
+	record.layer = layer;
+	record.numWriteOperation = numWriteOperation;
+	record.sumWriteLatency = sumWriteLatency;
+	record.numWritePulse = core->numWritePulse;
+	record.writeVoltage = core->cell.writeVoltage;
+	Add(record, 1);
+}
+
+void ActivityTrace::Add(const ActivityRecord& record, double weight) {
+	events[record] += weight;
+}
+
+void ActivityTrace::EndSection(int epoch, double accuracy, double arrayReadEnergy, double arrayWriteEnergy) {
+	if (!fp)
+		return;
+	ActivitySection section;
+	memset(&section, 0, sizeof(section));
+	section.epoch = epoch;
+	section.numRecords = events.size();
+	section.accuracy = accuracy;
+	section.arrayReadEnergy = arrayReadEnergy;
+	section.arrayWriteEnergy = arrayWriteEnergy;
+	std::vector<ActivityRecord> records;
+	records.reserve(events.size());
+	for (std::map<ActivityRecord, double, RecordLess>::const_iterator it = events.begin(); it != events.end(); ++it) {
+		records.push_back(it->first);
+		records.back().weight = it->second;
+	}
+	if (fwrite(&section, sizeof(section), 1, fp) != 1
+			|| (!records.empty() && fwrite(&records[0], sizeof(ActivityRecord), records.size(), fp) != records.size())) {
+		puts("[ActivityTrace] Error: cannot write the trace");
+		exit(-1);
+	}
+	fflush(fp);
+	events.clear();
+}
+
+void ActivityTrace::Close() {
+	if (fp)
+		fclose(fp);
+	fp = NULL;
+	events.clear();
+}
+
+/* # of iterations of the column batch loops of Train.cpp and Test.cpp */
+static int NumReadBatches(int numCol, int numColMuxed) {
+	int numBatchReadSynapse = (int)ceil((double)numCol / numColMuxed);
+	return (numCol + numBatchReadSynapse - 1) / numBatchReadSynapse;
+}
+
+void ReplayActivityTrace(const char *fileName, Simulator *simulator, std::vector<ReplayResult> *results) {
+	FILE *fp = fopen(fileName, "rb");
+	if (!fp) {
+		printf("[ActivityTrace] Error: cannot open %s\n", fileName);
+		exit(-1);
+	}
+	ActivityTraceHeader header;
+	if (fread(&header, sizeof(header), 1, fp) != 1 || strncmp(header.magic, ACTIVITY_TRACE_MAGIC, sizeof(header.magic)) != 0) {
+		printf("[ActivityTrace] Error: %s is not an activity trace\n", fileName);
+		exit(-1);
+	}
+	if (header.version != ACTIVITY_TRACE_VERSION || header.headerSize != sizeof(ActivityTraceHeader)
+			|| header.sectionSize != sizeof(ActivitySection) || header.recordSize != sizeof(ActivityRecord)) {
+		printf("[ActivityTrace] Error: %s has version %u, expected %d\n", fileName, header.version, ACTIVITY_TRACE_VERSION);
+		exit(-1);
+	}
+	const Param *param = simulator->param;
+	const std::vector<Layer*>& layers = simulator->layers;
+	std::vector<ActivityTraceLayer> layerRecords(layers.size());
+	bool sameNetwork = header.numLayers == (int)layers.size() && header.layerSize == sizeof(ActivityTraceLayer)
+			&& fread(&layerRecords[0], sizeof(ActivityTraceLayer), layers.size(), fp) == layers.size();
+	for (int l=0; l<layers.size() && sameNetwork; l++) {
+		sameNetwork = layerRecords[l].numInput == layers[l]->numInput && layerRecords[l].numOutput == layers[l]->numOutput
+				&& layerRecords[l].deviceType == layers[l]->deviceType
+				&& layerRecords[l].tileRows == layers[l]->tileRows && layerRecords[l].tileCols == layers[l]->tileCols;
+	}
+	if (!sameNetwork || header.numBitInput != param->numBitInput || header.numWeightBit != param->numWeightBit
+			|| header.numWriteColMuxed != param->numWriteColMuxed || header.useHardwareInTraining != param->useHardwareInTraining
+			|| header.numBitPartialSum != param->numBitPartialSum) {
+		printf("[ActivityTrace] Error: %s was recorded with other network, device, tiling, write or partial sum parameters\n", fileName);
+		exit(-1);
+	}
+
+	/* A batched read was recorded once per column batch of a tile of the recording run */
+	std::vector<double> batchScale(layers.size());
+	for (int l=0; l<layers.size(); l++) {
+		batchScale[l] = (double)NumReadBatches(layers[l]->tileCols, param->numColMuxed) / NumReadBatches(layers[l]->tileCols, header.numColMuxed);
+	}
+
+	double readLatency = 0, writeLatency = 0, readEnergy = 0, writeEnergy = 0;	// NeuroSim part
+	ActivitySection section;
+	std::vector<ActivityRecord> records;
+	while (fread(&section, sizeof(section), 1, fp) == 1) {
+		records.resize(section.numRecords);
+		if (section.numRecords > 0 && fread(&records[0], sizeof(ActivityRecord), section.numRecords, fp) != section.numRecords) {
+			printf("[ActivityTrace] Error: %s is truncated\n", fileName);
+			exit(-1);
+		}
+		for (int i=0; i<records.size(); i++) {
+			const ActivityRecord& r = records[i];
+			if (r.layer < 0 || r.layer >= layers.size()) {
+				printf("[ActivityTrace] Error: unknown layer %d in %s\n", r.layer, fileName);
+				exit(-1);
+			}
+			Layer *layer = layers[r.layer];
+			SubArray *core = layer->subArray;
+			switch (r.type) {
+				case ACTIVITY_READ: {
+					double weight = r.weight * (r.batched? batchScale[r.layer] : 1);
+					double latency = 0, energy = 0;
+					layer->ReadCost(r.activityRowRead, r.timed, &energy, &latency, NULL);
+					readLatency += latency * weight;
+					readEnergy += energy * weight;
+					break;
+				}
+				case ACTIVITY_WRITE_ROW:
+					core->numWritePulse = r.numWritePulse;
+					core->cell.writeVoltage = r.writeVoltage;
+					writeEnergy += NeuroSimSubArrayWriteEnergy(core, r.numWriteOperationPerRow, r.numWriteCellPerOperation) * r.weight;
+					break;
+				case ACTIVITY_WRITE_ARRAY:
+					core->numWritePulse = r.numWritePulse;
+					core->cell.writeVoltage = r.writeVoltage;
+					writeLatency += NeuroSimSubArrayWriteLatency(core, r.numWriteOperation, r.sumWriteLatency) * r.weight;
+					break;
+				default:
+					printf("[ActivityTrace] Error: unknown record type %d in %s\n", r.type, fileName);
+					exit(-1);
+			}
+		}
+		ReplayResult result;
+		result.epoch = section.epoch;
+		result.accuracy = section.accuracy;
+		result.readLatency = readLatency;
+		result.writeLatency = writeLatency;
+		result.readEnergy = section.arrayReadEnergy + readEnergy;
+		result.writeEnergy = section.arrayWriteEnergy + writeEnergy;
+		results->push_back(result);
+	}
+	fclose(fp);
+}
+
+void ReplayActivityTrace(const char *fileName, const Param& param, ReplayConfiguration *configuration) {
+	/* Only the NeuroSim cores are used, so the dataset stays empty */
+	Param datasetParam(param);
+	datasetParam.numMnistTrainImages = 0;
+	datasetParam.numMnistTestImages = 0;
+	Dataset dataset(datasetParam);
+	Simulator *simulator = new Simulator(param, dataset);
+	simulator->Initialize();
+
+	/* Same sums as Simulator::Run */
+	double subArrayArea = 0, neuronArea = 0, subArrayLeakage = 0, neuronLeakage = 0;
+	for (int l=0; l<simulator->layers.size(); l++) {
+		Layer *layer = simulator->layers[l];
+		subArrayArea += layer->SubArrayArea();
+		neuronArea += layer->NeuronArea();
+		subArrayLeakage += layer->SubArrayLeakagePower();
+		neuronLeakage += layer->NeuronLeakagePower();
+	}
+	configuration->area = subArrayArea + neuronArea;
+	configuration->leakage = subArrayLeakage + neuronLeakage;
+
+	configuration->results.clear();
+	ReplayActivityTrace(fileName, simulator, &configuration->results);
+	delete simulator;
+}
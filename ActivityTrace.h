@@ -0,0 +1,169 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef ACTIVITYTRACE_H_
+#define ACTIVITYTRACE_H_
+
+#include <stdint.h>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+class Param;
+class SubArray;
+class Simulator;
+class Layer;
+
+/* Binary trace of the activity that drives the NeuroSim cost functions during Train and
+ * Validate (param->activityTraceFile), so the read/write latency and energy can be
+ * re-evaluated for other circuit parameters without simulating the devices again (./replay).
+ * Layout, all fields in native byte order:
+ *   ActivityTraceHeader
+ *   numLayers ActivityTraceLayer, from the input side
+ *   one section per validation of Simulator::Run: ActivitySection, then numRecords ActivityRecord
+ * Identical events of a section are merged into one record whose weight counts them.
+ * ACTIVITY_TRACE_VERSION must be bumped whenever one of the structs below changes. */
+#define ACTIVITY_TRACE_MAGIC	"MLPACTV"
+#define ACTIVITY_TRACE_VERSION	3
+
+/* The records of a section are sorted by type, which is also the order of the replay: the NeuroSim
+ * cost functions leave state in the peripheries, and in Train.cpp the write energy of a row follows
+ * the read and write latency of the previous image */
+enum ActivityRecordType {
+	ACTIVITY_READ,			// Layer::ReadCost of one tile row for one input vector
+	ACTIVITY_WRITE_ARRAY,	// NeuroSimSubArrayWriteLatency of one weight update of the array
+	ACTIVITY_WRITE_ROW		// NeuroSimSubArrayWriteEnergy of one row
+};
+
+struct ActivityTraceHeader {
+	char magic[8];		// ACTIVITY_TRACE_MAGIC
+	uint32_t version;	// ACTIVITY_TRACE_VERSION
+	uint32_t headerSize, sectionSize, recordSize, layerSize;	// sizeof of the structs below
+	int32_t numLayers;	// # of ActivityTraceLayer records
+	/* Parameters that change the recorded activity (a replay must use the same values) */
+	int32_t numBitInput, numWeightBit;
+	int32_t numWriteColMuxed;
+	int32_t useHardwareInTraining;
+	int32_t numBitPartialSum;	// Digitization of the partial sums, changes the accuracy
+	int32_t numColMuxed;	// After the upper bound of NeuroSimNeuronInitialize, decides the # of read batches
+};
+
+/* Shape, device and tiling of one layer (a replay must use the same values) */
+struct ActivityTraceLayer {
+	int32_t numInput, numOutput;
+	int32_t deviceType;
+	int32_t tileRows, tileCols;
+	int32_t reserved;	// Keeps the record a multiple of 8 bytes
+};
+
+struct ActivitySection {
+	int32_t epoch;		// # of trained epochs at the validation that closed the section
+	int32_t numRecords;
+	double accuracy;	// Accuracy (%) of that validation
+	/* Cumulative cell level energy (not NeuroSim), only reported along with the replay */
+	double arrayReadEnergy, arrayWriteEnergy;
+};
+
+struct ActivityRecord {
+	int32_t type;		// ActivityRecordType
+	int16_t layer;		// Index of the layer whose core and neuron peripheries the cost functions are evaluated on
+	int8_t batched;		// ACTIVITY_READ repeated for every column batch (numColMuxed) of the core
+	int8_t timed;		// ACTIVITY_READ on the busiest tile row, which adds the latency (see Layer::ReadCost)
+	int32_t numWriteOperationPerRow;	// ACTIVITY_WRITE_ROW
+	int32_t numWriteCellPerOperation;	// ACTIVITY_WRITE_ROW
+	double activityRowRead;	// ACTIVITY_READ: subArray->activityRowRead
+	double numWriteOperation;	// ACTIVITY_WRITE_ARRAY: average # of write batches per row
+	double sumWriteLatency;		// ACTIVITY_WRITE_ARRAY: sum of the device write latency of analog eNVM
+	double numWritePulse;	// subArray->numWritePulse at the event
+	double writeVoltage;	// subArray->cell.writeVoltage at the event
+	double weight;		// # of identical events (scaled by the validation subset)
+};
+
+/* Records the events of one Simulator. Every call is a no-op unless Open succeeded; the
+ * calls from OpenMP loops are made inside the critical sections around the NeuroSim calls. */
+class ActivityTrace {
+public:
+	ActivityTrace();
+	~ActivityTrace();
+	void Open(const char *fileName, const Param& param, const std::vector<Layer*>& layers);
+	void Read(int layer, double activityRowRead, bool batched, bool timed, double weight=1) {
+		if (fp) AddRead(layer, activityRowRead, batched, timed, weight);
+	}
+	void WriteRow(int layer, const SubArray *core, int numWriteOperationPerRow, int numWriteCellPerOperation) {
+		if (fp) AddWriteRow(layer, core, numWriteOperationPerRow, numWriteCellPerOperation);
+	}
+	void WriteArray(int layer, const SubArray *core, double numWriteOperation, double sumWriteLatency) {
+		if (fp) AddWriteArray(layer, core, numWriteOperation, sumWriteLatency);
+	}
+	void EndSection(int epoch, double accuracy, double arrayReadEnergy, double arrayWriteEnergy);	// Write the events since the last section
+	void Close();
+
+private:
+	struct RecordLess {
+		bool operator()(const ActivityRecord& a, const ActivityRecord& b) const;
+	};
+	void AddRead(int layer, double activityRowRead, bool batched, bool timed, double weight);
+	void AddWriteRow(int layer, const SubArray *core, int numWriteOperationPerRow, int numWriteCellPerOperation);
+	void AddWriteArray(int layer, const SubArray *core, double numWriteOperation, double sumWriteLatency);
+	void Add(const ActivityRecord& record, double weight);
+	FILE *fp;
+	std::map<ActivityRecord, double, RecordLess> events;	// Events of the open section (weight not part of the key)
+};
+
+/* NeuroSim latency and energy of a trace replayed on the cores of a simulator */
+struct ReplayResult {
+	int epoch;
+	double accuracy;	// Recorded accuracy (%)
+	double readLatency, writeLatency;	// Cumulative latency (s)
+	double readEnergy, writeEnergy;		// Cumulative energy (J), including the recorded cell level energy
+};
+
+/* Replay fileName on simulator (Initialize must have been called), one result per section.
+ * Exits if the simulator's parameters would have produced a different activity. */
+void ReplayActivityTrace(const char *fileName, Simulator *simulator, std::vector<ReplayResult> *results);
+
+/* Area, leakage and replayed cost of one configuration */
+struct ReplayConfiguration {
+	double area, leakage;
+	std::vector<ReplayResult> results;
+};
+
+/* Replay fileName on the cores of a new simulator with param (the dataset is not needed) */
+void ReplayActivityTrace(const char *fileName, const Param& param, ReplayConfiguration *configuration);
+
+#endif
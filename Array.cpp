@@ -36,6 +36,8 @@
 *   Xiaochen Peng   Email: xpeng15 at asu dot edu
 ********************************************************************************/
 
+#include <cmath>
+#include <algorithm>
 #include "formula.h"
 #include "Array.h"
 
@@ -46,15 +48,15 @@ double Array::ReadCell(int x, int y) {
 		if (static_cast<AnalogNVM*>(cell[x][y])->PCMON) {
 			if (static_cast<eNVM*>(cell[x][y])->cmosAccess) {
 				if (static_cast<AnalogNVM*>(cell[x][y])->FeFET) {	// FeFET
-					totalWireResistance = (x + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol;
+					totalWireResistance = (x % tileColSize + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol;
 				}
 				else {	// Normal
-					totalWireResistance = (x + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol + static_cast<eNVM*>(cell[x][y])->resistanceAccess;
+					totalWireResistance = (x % tileColSize + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol + static_cast<eNVM*>(cell[x][y])->resistanceAccess;
 					// 2 cell ̷Ƿ
 				}
 			}
 			else {
-				totalWireResistance = (x + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol;
+				totalWireResistance = (x % tileColSize + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol;
 			}
 			double cellCurrentGp;
 			double cellCurrentGn;
@@ -78,9 +80,8 @@ double Array::ReadCell(int x, int y) {
 			}
 			else {	// No nonlinearity
 				if (static_cast<eNVM*>(cell[x][y])->readNoise) {
-					extern std::mt19937 gen;
-					cellCurrentGp = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductanceGp * (1 + (*static_cast<eNVM*>(cell[x][y])->gaussian_dist)(gen)) + totalWireResistance);
-					cellCurrentGn = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductanceGn * (1 + (*static_cast<eNVM*>(cell[x][y])->gaussian_dist)(gen)) + totalWireResistance);
+					cellCurrentGp = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductanceGp * (1 + (*static_cast<eNVM*>(cell[x][y])->gaussian_dist)(*gen)) + totalWireResistance);
+					cellCurrentGn = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductanceGn * (1 + (*static_cast<eNVM*>(cell[x][y])->gaussian_dist)(*gen)) + totalWireResistance);
 					cellCurrentRef = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductanceRef);
 					cellCurrent = cellCurrentGp-cellCurrentGn+cellCurrentRef;
 	
@@ -98,14 +99,14 @@ double Array::ReadCell(int x, int y) {
 		else {
 		if (static_cast<eNVM*>(cell[x][y])->cmosAccess) {
 			if (static_cast<AnalogNVM*>(cell[x][y])->FeFET) {	// FeFET
-				totalWireResistance = (x + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol;
+				totalWireResistance = (x % tileColSize + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol;
 			}
 			else {	// Normal
-				totalWireResistance = (x + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol + static_cast<eNVM*>(cell[x][y])->resistanceAccess;
+				totalWireResistance = (x % tileColSize + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol + static_cast<eNVM*>(cell[x][y])->resistanceAccess;
 			}
 		}
 		else {
-			totalWireResistance = (x + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol;
+			totalWireResistance = (x % tileColSize + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol;
 		}
 		double cellCurrent;
 		if (static_cast<eNVM*>(cell[x][y])->nonlinearIV) {
@@ -126,8 +127,7 @@ double Array::ReadCell(int x, int y) {
 		}
 		else {	// No nonlinearity
 			if (static_cast<eNVM*>(cell[x][y])->readNoise) {
-				extern std::mt19937 gen;
-				cellCurrent = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductance * (1 + (*static_cast<eNVM*>(cell[x][y])->gaussian_dist)(gen)) + totalWireResistance);
+				cellCurrent = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductance * (1 + (*static_cast<eNVM*>(cell[x][y])->gaussian_dist)(*gen)) + totalWireResistance);
 			}
 			else {
 				cellCurrent = readVoltage / (1 / static_cast<eNVM*>(cell[x][y])->conductance + totalWireResistance);
@@ -139,43 +139,18 @@ double Array::ReadCell(int x, int y) {
 }
  else {	// SRAM or digital eNVM
 		int weightDigits = 0;
+		if (weightPlane && !flipProbability) {	// Packed and noiseless
+			for (int n=0; n<numCellPerSynapse; n++) {   // n=0 is LSB
+				weightDigits += ((weightPlane[(x * numCellPerSynapse + n) * numPlaneWords + (y >> 6)] >> (y & 63)) & 1) << n;
+			}
+			return weightDigits;
+		}
 		if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(**cell)) {	// Digital eNVM
 			for (int n=0; n<numCellPerSynapse; n++) {   // n=0 is LSB
 				int colIndex = (x+1) * numCellPerSynapse - (n+1);
-				double readVoltage = static_cast<eNVM*>(cell[colIndex][y])->readVoltage;
-				double totalWireResistance;
-				if (static_cast<eNVM*>(cell[colIndex][y])->cmosAccess) {
-					totalWireResistance = (colIndex + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol + static_cast<eNVM*>(cell[colIndex][y])->resistanceAccess;
-				} else {
-					totalWireResistance = (colIndex + 1) * wireResistanceRow + (arrayRowSize - y) * wireResistanceCol;
-				}
-				double cellCurrent;
-				if (static_cast<eNVM*>(cell[colIndex][y])->nonlinearIV) {
-					/* Bisection method to calculate read current with nonlinearity */
-					int maxIter = 30;
-					double v1 = 0, v2 = readVoltage, v3;
-					double wireCurrent;
-					for (int iter=0; iter<maxIter; iter++) {
-						//printf("iter: %d, %f\t%f\n", iter, v1, v2);
-						v3 = (v1 + v2)/2;
-						wireCurrent = (readVoltage - v3)/totalWireResistance;
-						cellCurrent = static_cast<DigitalNVM*>(cell[colIndex][y])->Read(v3);
-						if (wireCurrent > cellCurrent)
-							v1 = v3;
-						else
-							v2 = v3;
-					}
-				} else {    // No nonlinearity
-					if (static_cast<eNVM*>(cell[colIndex][y])->readNoise) {
-						extern std::mt19937 gen;
-						cellCurrent = readVoltage / (1/static_cast<eNVM*>(cell[colIndex][y])->conductance * (1 + (*static_cast<eNVM*>(cell[colIndex][y])->gaussian_dist)(gen)) + totalWireResistance);
-					} else {
-						cellCurrent = readVoltage / (1/static_cast<eNVM*>(cell[colIndex][y])->conductance + totalWireResistance);
-					}
-				}
 				// Current sensing
 				int bit;
-				if (cellCurrent >= static_cast<DigitalNVM*>(cell[colIndex][y])->refCurrent) {
+				if (DigitalCellCurrent(colIndex, y) >= static_cast<DigitalNVM*>(cell[colIndex][y])->refCurrent) {
 					bit = 1;
 				} else {
 					bit = 0;
@@ -191,6 +166,45 @@ double Array::ReadCell(int x, int y) {
 	}
 }
 
+/* Wire (and access transistor) resistance in series with the digital eNVM cell */
+double Array::DigitalCellWireResistance(int colIndex, int y) {
+	if (static_cast<eNVM*>(cell[colIndex][y])->cmosAccess) {
+		return (colIndex % (tileColSize * numCellPerSynapse) + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol + static_cast<eNVM*>(cell[colIndex][y])->resistanceAccess;
+	} else {
+		return (colIndex % (tileColSize * numCellPerSynapse) + 1) * wireResistanceRow + (tileRowSize - y % tileRowSize) * wireResistanceCol;
+	}
+}
+
+/* Read current of the digital eNVM cell, with read noise if the device has it */
+double Array::DigitalCellCurrent(int colIndex, int y) {
+	double readVoltage = static_cast<eNVM*>(cell[colIndex][y])->readVoltage;
+	double totalWireResistance = DigitalCellWireResistance(colIndex, y);
+	double cellCurrent;
+	if (static_cast<eNVM*>(cell[colIndex][y])->nonlinearIV) {
+		/* Bisection method to calculate read current with nonlinearity */
+		int maxIter = 30;
+		double v1 = 0, v2 = readVoltage, v3;
+		double wireCurrent;
+		for (int iter=0; iter<maxIter; iter++) {
+			//printf("iter: %d, %f\t%f\n", iter, v1, v2);
+			v3 = (v1 + v2)/2;
+			wireCurrent = (readVoltage - v3)/totalWireResistance;
+			cellCurrent = static_cast<DigitalNVM*>(cell[colIndex][y])->Read(v3);
+			if (wireCurrent > cellCurrent)
+				v1 = v3;
+			else
+				v2 = v3;
+		}
+	} else {    // No nonlinearity
+		if (static_cast<eNVM*>(cell[colIndex][y])->readNoise) {
+			cellCurrent = readVoltage / (1/static_cast<eNVM*>(cell[colIndex][y])->conductance * (1 + (*static_cast<eNVM*>(cell[colIndex][y])->gaussian_dist)(*gen)) + totalWireResistance);
+		} else {
+			cellCurrent = readVoltage / (1/static_cast<eNVM*>(cell[colIndex][y])->conductance + totalWireResistance);
+		}
+	}
+	return cellCurrent;
+}
+
 void Array::WriteCell(int x, int y, double deltaWeight, double maxWeight, double minWeight, 
 						bool regular /* False: ideal write, True: regular write considering device properties */) {
 	// TODO: include wire resistance
@@ -275,6 +289,10 @@ void Array::WriteCell(int x, int y, double deltaWeight, double maxWeight, double
 				static_cast<eNVM*>(cell[x][y])->conductance = conductance;
 			}
 		}
+		if (regular) {	// LTP and the Gp/Gn updates of PCM are SET pulses, LTD RESET pulses
+			int numPulse = static_cast<AnalogNVM*>(cell[x][y])->numPulse;
+			CountPulses(x, y, numPulse > 0? numPulse : 0, numPulse < 0? -numPulse : 0);
+		}
 	} else {    // SRAM or digital eNVM
 		int numLevel = pow(2, numCellPerSynapse);
 		deltaWeightNormalized = truncate(deltaWeightNormalized, numLevel - 1);
@@ -295,12 +313,16 @@ void Array::WriteCell(int x, int y, double deltaWeight, double maxWeight, double
 		if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(**cell)) { // Digital eNVM
 			for (int n=0; n<numCellPerSynapse; n++) {	// n=0 is LSB
 				int bitNew = ((targetWeightDigits >> n) & 1);
+				int bit = static_cast<DigitalNVM*>(cell[(x+1) * numCellPerSynapse - (n+1)][y])->bit;
 				/* Write new weight */
 				if (static_cast<eNVM*>(cell[x][y])->cmosAccess) {  // 1T1R
 					static_cast<DigitalNVM*>(cell[(x+1) * numCellPerSynapse - (n+1)][y])->Write(bitNew, wireCapBLCol);
 				} else {	// Cross-point
 					static_cast<DigitalNVM*>(cell[(x+1) * numCellPerSynapse - (n+1)][y])->Write(bitNew, wireCapCol);
 				}
+				if (bit != bitNew) {
+					CountPulses((x+1) * numCellPerSynapse - (n+1), y, bitNew, !bitNew);
+				}
 			}
 		} else {
 			static_cast<SRAM*>(cell[x * numCellPerSynapse][y])->writeEnergy = 0;    // Use the MSB cell to store the info of the write energy of the synapse
@@ -315,6 +337,11 @@ void Array::WriteCell(int x, int y, double deltaWeight, double maxWeight, double
 				static_cast<SRAM*>(cell[(x+1) * numCellPerSynapse - (n+1)][y])->bit = bitNew;	// If the rightmost is LSB
 			}
 		}
+		if (weightPlane) {
+			for (int n=0; n<numCellPerSynapse; n++) {
+				PackCell((x+1) * numCellPerSynapse - (n+1), y);
+			}
+		}
 	}
 }
 
@@ -345,6 +372,7 @@ void Array::EraseCell(int x, int y, double maxWeight, double minWeight) {
 	if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(**cell)) {
 		if (static_cast<AnalogNVM*>(cell[x][y])->PCMON) {
 			static_cast<AnalogNVM*>(cell[x][y])->Erase();
+			CountPulses(x, y, 0, 1);	// One RESET of both devices
 		}
 	}
 }
@@ -354,4 +382,114 @@ void Array::ReWriteCell(int x, int y, double deltaWeight, double maxWeight, doub
 	static_cast<AnalogNVM*>(cell[x][y])->ReWrite(deltaWeight);
 }
 
+void Array::EnableEnduranceCounters() {
+	int numCol = arrayColSize * numCellPerSynapse;
+	numSetPulse = new uint32_t*[arrayRowSize];
+	numResetPulse = new uint32_t*[arrayRowSize];
+	for (int row=0; row<arrayRowSize; row++) {
+		numSetPulse[row] = new uint32_t[numCol]();
+		numResetPulse[row] = new uint32_t[numCol]();
+	}
+}
+
+/* Probability that a read with the gaussian noise of sigma on the cell resistance senses the other bit than the
+ * noiseless read. The read senses 1 if the noisy resistance (1+e)/G stays positive and below V/Iref - Rw. */
+static double FlipProbability(double conductance, double wireResistance, double readVoltage, double refCurrent, double sigma) {
+	bool bit = readVoltage / (1/conductance + wireResistance) >= refCurrent;
+	if (sigma <= 0) {
+		return 0;
+	}
+	double upper = conductance * (readVoltage / refCurrent - wireResistance) - 1;
+	double lower = -1 - conductance * wireResistance;
+	double probabilityOne = upper > lower? 0.5 * (erfc(-upper / sigma / sqrt(2)) - erfc(-lower / sigma / sqrt(2))) : 0;
+	return std::max(0.0, bit? 1 - probabilityOne : probabilityOne);
+}
+
+/* Sense every SRAM or digital eNVM cell into weightPlane. Digital eNVM with read noise keeps the noiseless bits
+ * and draws the noise in PackedColumnSum, except with I-V nonlinearity where the noise enters the bisection and
+ * ReadCell stays the only model. */
+void Array::PackWeights() {
+	if (dynamic_cast<AnalogNVM*>(**cell)) {
+		return;
+	}
+	DigitalNVM *digital = dynamic_cast<DigitalNVM*>(**cell);
+	bool readNoise = digital && digital->readNoise;
+	if (readNoise && digital->nonlinearIV) {
+		return;
+	}
+	int numPlanes = arrayColSize * numCellPerSynapse;
+	if (!weightPlane) {
+		numPlaneWords = (arrayRowSize + 63) / 64;
+		weightPlane = new uint64_t[(size_t)numPlanes * numPlaneWords]();
+		if (readNoise) {
+			flipProbability = new float[(size_t)numPlanes * arrayRowSize];
+		}
+	}
+	if (readNoise) {	// Bound over both states of every cell, so that the writes never exceed it
+		maxFlipProbability = 0;
+		for (int col=0; col<numPlanes; col++) {
+			for (int row=0; row<arrayRowSize; row++) {
+				DigitalNVM *c = static_cast<DigitalNVM*>(cell[col][row]);
+				double wireResistance = DigitalCellWireResistance(col, row);
+				maxFlipProbability = std::max(maxFlipProbability, FlipProbability(c->maxConductance, wireResistance, c->readVoltage, c->refCurrent, c->sigmaReadNoise));
+				maxFlipProbability = std::max(maxFlipProbability, FlipProbability(c->minConductance, wireResistance, c->readVoltage, c->refCurrent, c->sigmaReadNoise));
+			}
+		}
+	}
+	#pragma omp parallel for
+	for (int row=0; row<arrayRowSize; row++) {
+		for (int col=0; col<numPlanes; col++) {
+			PackCell(col, row);
+		}
+	}
+}
+
+/* Update the packed bit (and the flip probability) of the cell after it has been written */
+void Array::PackCell(int colIndex, int y) {
+	int plane = colIndex / numCellPerSynapse * numCellPerSynapse + numCellPerSynapse - 1 - colIndex % numCellPerSynapse;
+	int bit;
+	if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(cell[colIndex][y])) {
+		if (flipProbability) {
+			double wireResistance = DigitalCellWireResistance(colIndex, y);
+			bit = temp->readVoltage / (1/temp->conductance + wireResistance) >= temp->refCurrent;
+			flipProbability[(size_t)plane * arrayRowSize + y] = FlipProbability(temp->conductance, wireResistance, temp->readVoltage, temp->refCurrent, temp->sigmaReadNoise);
+		} else {
+			bit = DigitalCellCurrent(colIndex, y) >= temp->refCurrent;
+		}
+	} else {
+		bit = static_cast<SRAM*>(cell[colIndex][y])->bit;
+	}
+	uint64_t *word = &weightPlane[(size_t)plane * numPlaneWords + (y >> 6)];
+	uint64_t mask = 1ULL << (y & 63);
+	if (bit) {
+		#pragma omp atomic	// Neighbouring rows share the word
+		*word |= mask;
+	} else {
+		#pragma omp atomic
+		*word &= ~mask;
+	}
+}
 
+/* Sum of the sensed digits of synapse column x over the rows in [rowStart, rowEnd) whose bit is set in inputMask:
+ * the popcount of every bit plane against the input. With read noise, candidate rows are drawn at the rate of
+ * maxFlipProbability and each is kept with its own flip probability, which flips every active bit with exactly
+ * its probability while drawing random numbers only for the few candidates. */
+int Array::PackedColumnSum(int x, const uint64_t *inputMask, int rowStart, int rowEnd) {
+	int sum = 0;
+	for (int n=0; n<numCellPerSynapse; n++) {   // n=0 is LSB
+		int plane = x * numCellPerSynapse + n;
+		const uint64_t *bits = weightPlane + (size_t)plane * numPlaneWords;
+		int count = PopcountRange(inputMask, bits, rowStart, rowEnd);
+		if (flipProbability && maxFlipProbability > 0) {
+			std::geometric_distribution<int> skip(std::min(maxFlipProbability, 1.0));
+			std::uniform_real_distribution<double> accept(0, maxFlipProbability);
+			for (int64_t y = rowStart + (int64_t)skip(*gen); y < rowEnd; y += 1 + (int64_t)skip(*gen)) {
+				if (((inputMask[y >> 6] >> (y & 63)) & 1) && accept(*gen) < flipProbability[(size_t)plane * arrayRowSize + y]) {
+					count += ((bits[y >> 6] >> (y & 63)) & 1)? -1 : 1;
+				}
+			}
+		}
+		sum += count << n;
+	}
+	return sum;
+}
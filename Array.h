@@ -39,6 +39,7 @@
 #ifndef ARRAY_H_
 #define ARRAY_H_
 
+#include <stdint.h>
 #include <cstdlib>
 #include "Cell.h"
 
@@ -46,6 +47,7 @@ class Array {
 public:
 	Cell ***cell;
 	int arrayColSize, arrayRowSize, wireWidth;
+	int tileColSize, tileRowSize;	// Synapse columns and rows of one subarray tile, the wires only run within a tile
 	double unitLengthWireResistance;
 	double wireResistanceRow, wireResistanceCol;
 	double wireCapRow;	// Cap of the WL (cross-point) or BL (1T1R)
@@ -56,14 +58,34 @@ public:
 	int numCellPerSynapse;	// For SRAM to use redundant cells to represent one synapse
 	double writeEnergySRAMCell;	// Write energy per SRAM cell (will move this to SRAM cell level in the future)
 	bool **weightChange;	// Specify if the weight value will change or not during weight update (for SRAM and digital eNVM)
+	std::mt19937 *gen;	// Random number engine of the owning simulator
+	/* Saturating SET and RESET pulse counters of every cell (NULL unless EnableEnduranceCounters), indexed
+	 * [row][column of cell] so that the threads of the row parallel weight update write their own lines */
+	uint32_t **numSetPulse, **numResetPulse;
+	/* Sensed bits of the SRAM or digital eNVM synapses packed 64 rows per word (NULL unless PackWeights): bit y of
+	 * plane x * numCellPerSynapse + n holds bit n (n=0 is LSB) of synapse (x, y), every plane has numPlaneWords words */
+	uint64_t *weightPlane;
+	int numPlaneWords;
+	float *flipProbability;	// Probability that a noisy digital eNVM read senses the other bit, per plane and row (NULL: no read noise)
+	double maxFlipProbability;	// Upper bound of flipProbability for any state of the cells
 	
 	/* Constructor */
-	Array(int arrayColSize, int arrayRowSize, int wireWidth) {
+	Array(int arrayColSize, int arrayRowSize, int wireWidth, std::mt19937 *gen) {
 		this->arrayColSize = arrayColSize;
 		this->arrayRowSize = arrayRowSize;
+		this->tileColSize = arrayColSize;
+		this->tileRowSize = arrayRowSize;
 		this->wireWidth = wireWidth;
+		this->gen = gen;
+		cell = NULL;
+		numCellPerSynapse = 1;
 		readEnergy = 0;
 		writeEnergy = 0;
+		numSetPulse = numResetPulse = NULL;
+		weightPlane = NULL;
+		numPlaneWords = 0;
+		flipProbability = NULL;
+		maxFlipProbability = 0;
 		/* Initialize weightChange */
 		weightChange = new bool*[arrayColSize];
 		for (int col=0; col<arrayColSize; col++) {
@@ -71,6 +93,33 @@ public:
 		}
 	}
 
+	/* Destructor */
+	~Array() {
+		if (cell) {
+			for (int col=0; col<arrayColSize*numCellPerSynapse; col++) {
+				for (int row=0; row<arrayRowSize; row++) {
+					delete cell[col][row];
+				}
+				delete[] cell[col];
+			}
+			delete[] cell;
+		}
+		for (int col=0; col<arrayColSize; col++) {
+			delete[] weightChange[col];
+		}
+		delete[] weightChange;
+		if (numSetPulse) {
+			for (int row=0; row<arrayRowSize; row++) {
+				delete[] numSetPulse[row];
+				delete[] numResetPulse[row];
+			}
+			delete[] numSetPulse;
+			delete[] numResetPulse;
+		}
+		delete[] weightPlane;
+		delete[] flipProbability;
+	}
+
 	template <class memoryType>
 	void Initialization(int numCellPerSynapse=1) {
 		/* Determine number of cells per synapse (SRAM only now) */
@@ -82,6 +131,7 @@ public:
 			cell[col] = new Cell*[arrayRowSize];
 			for (int row=0; row<arrayRowSize; row++) {
 				cell[col][row] = new memoryType(col, row);
+				cell[col][row]->gen = gen;
 			}
 		}
 		
@@ -121,6 +171,37 @@ public:
 	double ConductanceToWeight(int x, int y, double maxWeight, double minWeight);
 	void EraseCell(int x, int y,double maxWeight,double minWeight);
 	void ReWriteCell(int x, int y, double deltaWeight, double maxWeight, double minWeight);
+	void EnableEnduranceCounters();	// After Initialization
+	void PackWeights();	// After Initialization and whenever the cells are set without WriteCell
+	int PackedColumnSum(int x, const uint64_t *inputMask, int rowStart, int rowEnd);
+	double DigitalCellCurrent(int colIndex, int y);	// colIndex is the column of the cell (not of the synapse)
+	double DigitalCellWireResistance(int colIndex, int y);
+	void PackCell(int colIndex, int y);
+	/* Add the pulses of a write to cell (x, y), x is the column of the cell (not of the synapse) */
+	void CountPulses(int x, int y, int numSet, int numReset) {
+		if (numSetPulse) {
+			numSetPulse[y][x] = (uint64_t)numSetPulse[y][x] + numSet > UINT32_MAX? UINT32_MAX : numSetPulse[y][x] + numSet;
+			numResetPulse[y][x] = (uint64_t)numResetPulse[y][x] + numReset > UINT32_MAX? UINT32_MAX : numResetPulse[y][x] + numReset;
+		}
+	}
 };
 
+/* Number of rows in [begin, end) whose bits are set in both a and b, packed 64 rows per word */
+inline int PopcountRange(const uint64_t *a, const uint64_t *b, int begin, int end) {
+	if (begin >= end) {
+		return 0;
+	}
+	int first = begin >> 6, last = (end - 1) >> 6;
+	uint64_t firstMask = ~0ULL << (begin & 63);
+	uint64_t lastMask = ~0ULL >> (63 - ((end - 1) & 63));
+	if (first == last) {
+		return __builtin_popcountll(a[first] & b[first] & firstMask & lastMask);
+	}
+	int count = __builtin_popcountll(a[first] & b[first] & firstMask);
+	for (int w = first + 1; w < last; w++) {
+		count += __builtin_popcountll(a[w] & b[w]);
+	}
+	return count + __builtin_popcountll(a[last] & b[last] & lastMask);
+}
+
 #endif
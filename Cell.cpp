@@ -40,6 +40,7 @@
 #include <ctime>
 #include "formula.h"
 #include "Cell.h"
+#include "Config.h"
 
 double AnalogNVM::GetMaxReadCurrent()
 {
@@ -325,49 +326,51 @@ void AnalogNVM::ReWriteEnergyCalculation(double wireCapCol)
 /* Ideal device (no weight update nonlinearity) */
 IdealDevice::IdealDevice(int x, int y) {
 	this->x = x; this->y = y;	// Cell location: x (column) and y (row) start from index 0
-	maxConductance = 5e-6;		// Maximum cell conductance (S)
-	minConductance = 100e-9;	// Minimum cell conductance (S)
+	maxConductance = DeviceParam("IdealDevice", "maxConductance", 5e-6);		// Maximum cell conductance (S)
+	minConductance = DeviceParam("IdealDevice", "minConductance", 100e-9);	// Minimum cell conductance (S)
 	avgMaxConductance = maxConductance; // Average maximum cell conductance (S)
 	avgMinConductance = minConductance; // Average minimum cell conductance (S)
 	conductance = minConductance;	// Current conductance (S) (dynamic variable)
 	conductancePrev = conductance;	// Previous conductance (S) (dynamic variable)
-	readVoltage = 0.5;	// On-chip read voltage (Vr) (V)
-	readPulseWidth = 5e-9;	// Read pulse width (s) (will be determined by ADC)
-	writeVoltageLTP = 2;	// Write voltage (V) for LTP or weight increase
-	writeVoltageLTD = 2;	// Write voltage (V) for LTD or weight decrease
-	writePulseWidthLTP = 10e-9;	// Write pulse width (s) for LTP or weight increase
-	writePulseWidthLTD = 10e-9;	// Write pulse width (s) for LTD or weight decrease
+	conductanceGp = conductanceGn = 0;	// Not a PCM differential pair
+	readVoltage = DeviceParam("IdealDevice", "readVoltage", 0.5);	// On-chip read voltage (Vr) (V)
+	readPulseWidth = DeviceParam("IdealDevice", "readPulseWidth", 5e-9);	// Read pulse width (s) (will be determined by ADC)
+	writeVoltageLTP = DeviceParam("IdealDevice", "writeVoltageLTP", 2);	// Write voltage (V) for LTP or weight increase
+	writeVoltageLTD = DeviceParam("IdealDevice", "writeVoltageLTD", 2);	// Write voltage (V) for LTD or weight decrease
+	writePulseWidthLTP = DeviceParam("IdealDevice", "writePulseWidthLTP", 10e-9);	// Write pulse width (s) for LTP or weight increase
+	writePulseWidthLTD = DeviceParam("IdealDevice", "writePulseWidthLTD", 10e-9);	// Write pulse width (s) for LTD or weight decrease
 	writeEnergy = 0;	// Dynamic variable for calculation of write energy (J)
-	maxNumLevelLTP = 63;	// Maximum number of conductance states during LTP or weight increase
-	maxNumLevelLTD = 63;	// Maximum number of conductance states during LTD or weight decrease
+	maxNumLevelLTP = DeviceParam("IdealDevice", "maxNumLevelLTP", 63);	// Maximum number of conductance states during LTP or weight increase
+	maxNumLevelLTD = DeviceParam("IdealDevice", "maxNumLevelLTD", 63);	// Maximum number of conductance states during LTD or weight decrease
 	numPulse = 0;	// Number of write pulses used in the most recent write operation (dynamic variable)
-	cmosAccess = true;	// True: Pseudo-crossbar (1T1R), false: cross-point
-	FeFET = false;		// True: FeFET structure (Pseudo-crossbar only, should be cmosAccess=1)
+	cmosAccess = DeviceParam("IdealDevice", "cmosAccess", true);	// True: Pseudo-crossbar (1T1R), false: cross-point
+	FeFET = DeviceParam("IdealDevice", "FeFET", false);		// True: FeFET structure (Pseudo-crossbar only, should be cmosAccess=1)
 	gateCapFeFET = 2.1717e-18;	// Gate capacitance of FeFET (F)
-	resistanceAccess = 15e3;	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
-	nonlinearIV = false;	// Consider I-V nonlinearity or not (Currently for cross-point array only)
-	nonIdenticalPulse = false;	// Use non-identical pulse scheme in weight update or not (should be false here)
+	resistanceAccess = DeviceParam("IdealDevice", "resistanceAccess", 15e3);	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
+	nonlinearIV = DeviceParam("IdealDevice", "nonlinearIV", false);	// Consider I-V nonlinearity or not (Currently for cross-point array only)
+	PCMON = false;	// Not a PCM differential pair
+	nonIdenticalPulse = DeviceParam("IdealDevice", "nonIdenticalPulse", false);	// Use non-identical pulse scheme in weight update or not (should be false here)
 								// Don't care other non-identical pulse parameters
-	NL = 10;	// Nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
+	NL = DeviceParam("IdealDevice", "NL", 10);	// Nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
 	if (nonlinearIV) {	// Currently for cross-point array only
 		double Vr_exp = readVoltage;  // XXX: Modify this value to Vr in the reported measurement data (can be different than readVoltage)
 		// Calculation of conductance at on-chip Vr
 		maxConductance = NonlinearConductance(maxConductance, NL, writeVoltageLTP, Vr_exp, readVoltage);
 		minConductance = NonlinearConductance(minConductance, NL, writeVoltageLTP, Vr_exp, readVoltage);
 	}
-	readNoise = false;	// Consider read noise or not
-	sigmaReadNoise = 0.25;	// Sigma of read noise in gaussian distribution
+	readNoise = DeviceParam("IdealDevice", "readNoise", false);	// Consider read noise or not
+	sigmaReadNoise = DeviceParam("IdealDevice", "sigmaReadNoise", 0.25);	// Sigma of read noise in gaussian distribution
 	gaussian_dist = new std::normal_distribution<double>(0, sigmaReadNoise);	// Set up mean and stddev for read noise
 	
 	/* Conductance range variation */	
-	conductanceRangeVar = false;	// Consider variation of conductance range or not
-	maxConductanceVar = 0;	// Sigma of maxConductance variation (S)
-	minConductanceVar = 0;	// Sigma of minConductance variation (S)
-	std::mt19937 localGen;
-	localGen.seed(std::time(0));
+	conductanceRangeVar = DeviceParam("IdealDevice", "conductanceRangeVar", false);	// Consider variation of conductance range or not
+	maxConductanceVar = DeviceParam("IdealDevice", "maxConductanceVar", 0);	// Sigma of maxConductance variation (S)
+	minConductanceVar = DeviceParam("IdealDevice", "minConductanceVar", 0);	// Sigma of minConductance variation (S)
 	gaussian_dist_maxConductance = new std::normal_distribution<double>(0, maxConductanceVar);
 	gaussian_dist_minConductance = new std::normal_distribution<double>(0, minConductanceVar);
 	if (conductanceRangeVar) {
+		std::mt19937 localGen;	// Only seeded here, since seeding dominates the cell construction time
+		localGen.seed(std::time(0));
 		maxConductance += (*gaussian_dist_maxConductance)(localGen);
 		minConductance += (*gaussian_dist_minConductance)(localGen);
 		if (minConductance >= maxConductance || maxConductance < 0 || minConductance < 0 ) {	// Conductance variation check
@@ -386,17 +389,15 @@ IdealDevice::IdealDevice(int x, int y) {
 }
 
 double IdealDevice::Read(double voltage) {
-	extern std::mt19937 gen;
 	// TODO: nonlinear read
 	if (readNoise) {
-		return voltage * conductance * (1 + (*gaussian_dist)(gen));
+		return voltage * conductance * (1 + (*gaussian_dist)(*gen));
 	} else {
 		return voltage * conductance;
 	}
 }
 
 void IdealDevice::Write(double deltaWeightNormalized) {
-	extern std::mt19937 gen;
 	if (deltaWeightNormalized >= 0) {
 		deltaWeightNormalized = truncate(deltaWeightNormalized, maxNumLevelLTP);
 		numPulse = deltaWeightNormalized * maxNumLevelLTP;
@@ -424,31 +425,36 @@ void IdealDevice::Write(double deltaWeightNormalized) {
 	conductance = conductanceNew;
 }
 
+/* One-time device-to-device variation draw, which is 0 when the variation is disabled (no local engine) */
+static double DeviceToDeviceVariation(std::normal_distribution<double> *dist, std::mt19937 *localGen) {
+	return localGen? (*dist)(*localGen) : 0;
+}
+
 /* Real Device */
 RealDevice::RealDevice(int x, int y) {
 	this->x = x; this->y = y;	// Cell location: x (column) and y (row) start from index 0
-	maxConductance = 3.8462e-8;		// Maximum cell conductance (S)
-	minConductance = 3.0769e-9;	// Minimum cell conductance (S)
+	maxConductance = DeviceParam("RealDevice", "maxConductance", 3.8462e-8);		// Maximum cell conductance (S)
+	minConductance = DeviceParam("RealDevice", "minConductance", 3.0769e-9);	// Minimum cell conductance (S)
 	avgMaxConductance = maxConductance; // Average maximum cell conductance (S)
 	avgMinConductance = minConductance; // Average minimum cell conductance (S)
 	conductance = maxConductance;	// Current conductance (S) (dynamic variable)
 	conductancePrev = conductance;	// Previous conductance (S) (dynamic variable)
-	readVoltage = 0.5;	// On-chip read voltage (Vr) (V)
-	readPulseWidth = 5e-9;	// Read pulse width (s) (will be determined by ADC)
-	writeVoltageLTP = 3.2;	// Write voltage (V) for LTP or weight increase
-	writeVoltageLTD = 3.2;	// Write voltage (V) for LTD or weight decrease
-	writePulseWidthLTP = 300e-6;	// Write pulse width (s) for LTP or weight increase
-	writePulseWidthLTD = 300e-6;	// Write pulse width (s) for LTD or weight decrease
-	maxNumLevelLTD = 100;	// Maximum number of conductance states during LTD or weight decrease
+	readVoltage = DeviceParam("RealDevice", "readVoltage", 0.5);	// On-chip read voltage (Vr) (V)
+	readPulseWidth = DeviceParam("RealDevice", "readPulseWidth", 5e-9);	// Read pulse width (s) (will be determined by ADC)
+	writeVoltageLTP = DeviceParam("RealDevice", "writeVoltageLTP", 3.2);	// Write voltage (V) for LTP or weight increase
+	writeVoltageLTD = DeviceParam("RealDevice", "writeVoltageLTD", 3.2);	// Write voltage (V) for LTD or weight decrease
+	writePulseWidthLTP = DeviceParam("RealDevice", "writePulseWidthLTP", 300e-6);	// Write pulse width (s) for LTP or weight increase
+	writePulseWidthLTD = DeviceParam("RealDevice", "writePulseWidthLTD", 300e-6);	// Write pulse width (s) for LTD or weight decrease
+	maxNumLevelLTD = DeviceParam("RealDevice", "maxNumLevelLTD", 100);	// Maximum number of conductance states during LTD or weight decrease
 	numPulse = 0;	// Number of write pulses used in the most recent write operation (dynamic variable)
-	cmosAccess = true;	// True: Pseudo-crossbar (1T1R), false: cross-point
-	FeFET = false;		// True: FeFET structure (Pseudo-crossbar only, should be cmosAccess=1)
+	cmosAccess = DeviceParam("RealDevice", "cmosAccess", true);	// True: Pseudo-crossbar (1T1R), false: cross-point
+	FeFET = DeviceParam("RealDevice", "FeFET", false);		// True: FeFET structure (Pseudo-crossbar only, should be cmosAccess=1)
 	gateCapFeFET = 2.1717e-18;	// Gate capacitance of FeFET (F)
-	resistanceAccess = 15e3;	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
+	resistanceAccess = DeviceParam("RealDevice", "resistanceAccess", 15e3);	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
 	writeEnergy = 0;	// Dynamic variable for calculation of write energy (J)
-	maxNumLevelLTP = 100;	// Maximum number of conductance states during LTP or weight increase1
-	nonlinearIV = false;	// Consider I-V nonlinearity or not (Currently for cross-point array only)
-	NL = 10;    // I-V nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
+	maxNumLevelLTP = DeviceParam("RealDevice", "maxNumLevelLTP", 100);	// Maximum number of conductance states during LTP or weight increase1
+	nonlinearIV = DeviceParam("RealDevice", "nonlinearIV", false);	// Consider I-V nonlinearity or not (Currently for cross-point array only)
+	NL = DeviceParam("RealDevice", "NL", 10);    // I-V nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
 	//PCM properties
 	conductanceGn = minConductance;
 	conductanceGp = minConductance;
@@ -468,8 +474,8 @@ RealDevice::RealDevice(int x, int y) {
 		maxConductance = NonlinearConductance(maxConductance, NL, writeVoltageLTP, Vr_exp, readVoltage);
 		minConductance = NonlinearConductance(minConductance, NL, writeVoltageLTP, Vr_exp, readVoltage);
 	}
-	nonlinearWrite = true;	// Consider weight update nonlinearity or not
-	nonIdenticalPulse = false;	// Use non-identical pulse scheme in weight update or not
+	nonlinearWrite = DeviceParam("RealDevice", "nonlinearWrite", true);	// Consider weight update nonlinearity or not
+	nonIdenticalPulse = DeviceParam("RealDevice", "nonIdenticalPulse", false);	// Use non-identical pulse scheme in weight update or not
 	if (nonIdenticalPulse) {
 		VinitLTP = 2.85;	// Initial write voltage for LTP or weight increase (V)
 		VstepLTP = 0.05;	// Write voltage step for LTP or weight increase (V)
@@ -481,50 +487,50 @@ RealDevice::RealDevice(int x, int y) {
 		PWstepLTD = 5e-9;	// Write pulse width for LTD or weight decrease (s)
 		writeVoltageSquareSum = 0;	// Sum of V^2 of non-identical pulses (dynamic variable)
 	}
-	readNoise = false;		// Consider read noise or not
-	sigmaReadNoise = 0;		// Sigma of read noise in gaussian distribution
+	readNoise = DeviceParam("RealDevice", "readNoise", false);		// Consider read noise or not
+	sigmaReadNoise = DeviceParam("RealDevice", "sigmaReadNoise", 0);		// Sigma of read noise in gaussian distribution
 	gaussian_dist = new std::normal_distribution<double>(0, sigmaReadNoise);	// Set up mean and stddev for read noise
 
-	std::mt19937 localGen;	// It's OK not to use the external gen, since here the device-to-device vairation is a one-time deal
-	localGen.seed(std::time(0));
 	/*PCM Properties*/
-	PCMActivity = 0.3;
-	PCMActivityOn =false;
-	PCMON = true;
-	SaturationPCM = false;
-	RESETVoltage = 10;
-	RESETPulseWidth = 5e-9;
-	maxRESETLEVEL = 10;
+	PCMActivity = DeviceParam("RealDevice", "PCMActivity", 0.3);
+	PCMActivityOn = DeviceParam("RealDevice", "PCMActivityOn", false);
+	PCMON = DeviceParam("RealDevice", "PCMON", true);
+	SaturationPCM = DeviceParam("RealDevice", "SaturationPCM", false);
+	RESETVoltage = DeviceParam("RealDevice", "RESETVoltage", 10);
+	RESETPulseWidth = DeviceParam("RealDevice", "RESETPulseWidth", 5e-9);
+	maxRESETLEVEL = DeviceParam("RealDevice", "maxRESETLEVEL", 10);
 	/* Device-to-device weight update variation */
-	NL_LTP =0;	// LTP nonlinearity
-	NL_LTD =5.0;	// LTD nonlinearity
-	NL_LTP_Gp = 0;
-	NL_LTP_Gn = -2.0;
-	sigmaDtoD = 0;	// Sigma of device-to-device weight update vairation in gaussian distribution
+	NL_LTP = DeviceParam("RealDevice", "NL_LTP", 0);	// LTP nonlinearity
+	NL_LTD = DeviceParam("RealDevice", "NL_LTD", 5.0);	// LTD nonlinearity
+	NL_LTP_Gp = DeviceParam("RealDevice", "NL_LTP_Gp", 0);
+	NL_LTP_Gn = DeviceParam("RealDevice", "NL_LTP_Gn", -2.0);
+	sigmaDtoD = DeviceParam("RealDevice", "sigmaDtoD", 0);	// Sigma of device-to-device weight update vairation in gaussian distribution
 	gaussian_dist2 = new std::normal_distribution<double>(0, sigmaDtoD);	// Set up mean and stddev for device-to-device weight update vairation
-	paramALTP = getParamA(NL_LTP + (*gaussian_dist2)(localGen)) * maxNumLevelLTP;	// Parameter A for LTP nonlinearity
-	paramALTD = getParamA(NL_LTD + (*gaussian_dist2)(localGen)) * maxNumLevelLTD;	// Parameter A for LTD nonlinearity
-	paramA_Gp_LTP= getParamA(NL_LTP_Gp + (*gaussian_dist2)(localGen)) * maxNumLevelLTP;
-	paramA_Gn_LTP= getParamA(NL_LTP_Gn + (*gaussian_dist2)(localGen)) * maxNumLevelLTP;
+	conductanceRangeVar = DeviceParam("RealDevice", "conductanceRangeVar", false);    // Consider variation of conductance range or not
+	/* It's OK not to use the external gen, since here the device-to-device vairation is a one-time deal.
+	   Seeding the local engine dominates the cell construction time, so it is skipped when there is no variation. */
+	std::mt19937 *localGen = (sigmaDtoD != 0 || conductanceRangeVar)? new std::mt19937(std::time(0)) : NULL;
+	paramALTP = getParamA(NL_LTP + DeviceToDeviceVariation(gaussian_dist2, localGen)) * maxNumLevelLTP;	// Parameter A for LTP nonlinearity
+	paramALTD = getParamA(NL_LTD + DeviceToDeviceVariation(gaussian_dist2, localGen)) * maxNumLevelLTD;	// Parameter A for LTD nonlinearity
+	paramA_Gp_LTP= getParamA(NL_LTP_Gp + DeviceToDeviceVariation(gaussian_dist2, localGen)) * maxNumLevelLTP;
+	paramA_Gn_LTP= getParamA(NL_LTP_Gn + DeviceToDeviceVariation(gaussian_dist2, localGen)) * maxNumLevelLTP;
 
 	/*PCM weight update variation*/
-	NL_RESET = -9;
-	paramA_RESET = getParamA(NL_RESET + (*gaussian_dist2)(localGen))*maxRESETLEVEL;
-	RandGen.seed(std::time(0));
+	NL_RESET = DeviceParam("RealDevice", "NL_RESET", -9);
+	paramA_RESET = getParamA(NL_RESET + DeviceToDeviceVariation(gaussian_dist2, localGen))*maxRESETLEVEL;
 	/* Cycle-to-cycle weight update variation */
 	//sigmaCtoC = 0.009*(maxConductance - minConductance);	// Sigma of cycle-to-cycle weight update vairation: defined as the percentage of conductance range
-	sigmaCtoC = 0;
+	sigmaCtoC = DeviceParam("RealDevice", "sigmaCtoC", 0);
 	gaussian_dist3 = new std::normal_distribution<double>(0, sigmaCtoC);    // Set up mean and stddev for cycle-to-cycle weight update vairation
 
 	/* Conductance range variation */
-	conductanceRangeVar = false;    // Consider variation of conductance range or not
-	maxConductanceVar = 0;  // Sigma of maxConductance variation (S)
-	minConductanceVar = 0;  // Sigma of minConductance variation (S)
+	maxConductanceVar = DeviceParam("RealDevice", "maxConductanceVar", 0);  // Sigma of maxConductance variation (S)
+	minConductanceVar = DeviceParam("RealDevice", "minConductanceVar", 0);  // Sigma of minConductance variation (S)
 	gaussian_dist_maxConductance = new std::normal_distribution<double>(0, maxConductanceVar);
 	gaussian_dist_minConductance = new std::normal_distribution<double>(0, minConductanceVar);
 	if (conductanceRangeVar) {
-		maxConductance += (*gaussian_dist_maxConductance)(localGen);
-		minConductance += (*gaussian_dist_minConductance)(localGen);
+		maxConductance += (*gaussian_dist_maxConductance)(*localGen);
+		minConductance += (*gaussian_dist_minConductance)(*localGen);
 		if (minConductance >= maxConductance || maxConductance < 0 || minConductance < 0 ) {    // Conductance variation check
 			puts("[Error] Conductance variation check not passed. The variation may be too large.");
 			exit(-1);
@@ -535,23 +541,23 @@ RealDevice::RealDevice(int x, int y) {
 		//  minConductance = avgMinConductance + (*gaussian_dist_minConductance)(localGen);
 		//} while (minConductance >= maxConductance || maxConductance < 0 || minConductance < 0);
 	}
+	delete localGen;
 
 	heightInFeatureSize = cmosAccess? 4 : 2;	// Cell height = 4F (Pseudo-crossbar) or 2F (cross-point)
 	widthInFeatureSize = cmosAccess? (FeFET? 6 : 4) : 2;	// Cell width = 6F (FeFET) or 4F (Pseudo-crossbar) or 2F (cross-point)
 }
 
 double RealDevice::Read(double voltage) {	// Return read current (A)
-	extern std::mt19937 gen;
 	if (nonlinearIV) {
 		// TODO: nonlinear read
 		if (readNoise) {
-			return voltage * conductance * (1 + (*gaussian_dist)(gen));
+			return voltage * conductance * (1 + (*gaussian_dist)(*gen));
 		} else {
 			return voltage * conductance;
 		}
 	} else {
 		if (readNoise) {
-			return voltage * conductance * (1 + (*gaussian_dist)(gen));
+			return voltage * conductance * (1 + (*gaussian_dist)(*gen));
 		} else {
 			return voltage * conductance;
 		}
@@ -653,11 +659,10 @@ void RealDevice::Write(double deltaWeightNormalized) {
 		}
 	}
 	/* Cycle-to-cycle variation */
-	extern std::mt19937 gen;
 	if (PCMON) {
 		if (sigmaCtoC && numPulse != 0) {
 			if (numPulse > 0) {
-				conductanceNewGp += (*gaussian_dist3)(gen) * sqrt(abs(numPulse));	// Absolute variation
+				conductanceNewGp += (*gaussian_dist3)(*gen) * sqrt(abs(numPulse));	// Absolute variation
 				if (conductanceNewGp > maxConductance) {
 					conductanceNewGp = maxConductance;
 				}
@@ -666,7 +671,7 @@ void RealDevice::Write(double deltaWeightNormalized) {
 				}
 			}
 			else {
-				conductanceNewGn += (*gaussian_dist3)(gen)*sqrt(abs(numPulse));
+				conductanceNewGn += (*gaussian_dist3)(*gen)*sqrt(abs(numPulse));
 				if (conductanceNewGn > maxConductance) {
 					conductanceNewGn = maxConductance;
 				}
@@ -677,7 +682,7 @@ void RealDevice::Write(double deltaWeightNormalized) {
 		}
 		//if (sigmaCtoC && numPulse != 0) {
 		//	conductanceNew = conductanceNewGp - conductanceNewGn + conductanceRef;
-		//	conductanceNew += (*gaussian_dist3)(gen) * sqrt(abs(numPulse));	// Absolute variation
+		//	conductanceNew += (*gaussian_dist3)(*gen) * sqrt(abs(numPulse));	// Absolute variation
 		//}
 
 		//if (conductanceNew > PCMavgMaxConductance) {
@@ -689,7 +694,7 @@ void RealDevice::Write(double deltaWeightNormalized) {
 	}
 	else {
 		if (sigmaCtoC && numPulse != 0) {
-			conductanceNew += (*gaussian_dist3)(gen) * sqrt(abs(numPulse));	// Absolute variation
+			conductanceNew += (*gaussian_dist3)(*gen) * sqrt(abs(numPulse));	// Absolute variation
 		}
 
 		if (conductanceNew > maxConductance) {
@@ -782,8 +787,7 @@ void RealDevice::ReWrite(double deltaWeightNormalized)
 		conductancenewGp = NonlinearWeight(xPulseGp + numPulse, maxNumLevelLTP, paramA_Gp_LTP, paramB_Gp, minConductance);
 
 		if (sigmaCtoC&&numPulse != 0) {
-			extern std::mt19937 gen;
-			conductancenewGp+=(*gaussian_dist3)(gen)*sqrt(abs(numPulse));
+			conductancenewGp+=(*gaussian_dist3)(*gen)*sqrt(abs(numPulse));
 		}
 		if (conductancenewGp > maxConductance) {
 			conductancenewGp = maxConductance;
@@ -804,8 +808,7 @@ void RealDevice::ReWrite(double deltaWeightNormalized)
 		conductancenewGn = NonlinearWeight(xPulseGn + numPulse, maxNumLevelLTP, paramA_Gn_LTP, paramB_Gn, minConductance);
 
 		if (sigmaCtoC&&numPulse != 0) {
-			extern std::mt19937 gen;
-			conductancenewGn += (*gaussian_dist3)(gen)*sqrt(abs(numPulse));
+			conductancenewGn += (*gaussian_dist3)(*gen)*sqrt(abs(numPulse));
 		}
 		if (conductancenewGn > maxConductance) {
 			conductancenewGn = maxConductance;
@@ -841,21 +844,22 @@ void RealDevice::ReWrite(double deltaWeightNormalized)
 /* Measured device */
 MeasuredDevice::MeasuredDevice(int x, int y) {
 	this->x = x; this->y = y;	// Cell location: x (column) and y (row) start from index 0
-	readVoltage = 0.5;	// On-chip read voltage (Vr) (V)
-	readPulseWidth = 5e-9;	// Read pulse width (s) (will be determined by ADC)
-	writeVoltageLTP = 2;	// Write voltage (V) for LTP or weight increase
-	writeVoltageLTD = 2;	// Write voltage (V) for LTD or weight decrease
-	writePulseWidthLTP = 100e-9;	// Write pulse width (s) for LTP or weight increase
-	writePulseWidthLTD = 100e-9;	// Write pulse width (s) for LTD or weight decrease
+	readVoltage = DeviceParam("MeasuredDevice", "readVoltage", 0.5);	// On-chip read voltage (Vr) (V)
+	readPulseWidth = DeviceParam("MeasuredDevice", "readPulseWidth", 5e-9);	// Read pulse width (s) (will be determined by ADC)
+	writeVoltageLTP = DeviceParam("MeasuredDevice", "writeVoltageLTP", 2);	// Write voltage (V) for LTP or weight increase
+	writeVoltageLTD = DeviceParam("MeasuredDevice", "writeVoltageLTD", 2);	// Write voltage (V) for LTD or weight decrease
+	writePulseWidthLTP = DeviceParam("MeasuredDevice", "writePulseWidthLTP", 100e-9);	// Write pulse width (s) for LTP or weight increase
+	writePulseWidthLTD = DeviceParam("MeasuredDevice", "writePulseWidthLTD", 100e-9);	// Write pulse width (s) for LTD or weight decrease
 	writeEnergy = 0;	// Dynamic variable for calculation of write energy (J)
 	numPulse = 0;	// Number of write pulses used in the most recent write operation (dynamic variable)
-	cmosAccess = true;	// True: Pseudo-crossbar (1T1R), false: cross-point
-	FeFET = false;		// True: FeFET structure (Pseudo-crossbar only, should be cmosAccess=1)
+	cmosAccess = DeviceParam("MeasuredDevice", "cmosAccess", true);	// True: Pseudo-crossbar (1T1R), false: cross-point
+	FeFET = DeviceParam("MeasuredDevice", "FeFET", false);		// True: FeFET structure (Pseudo-crossbar only, should be cmosAccess=1)
 	gateCapFeFET = 2.1717e-18;	// Gate capacitance of FeFET (F)
-	resistanceAccess = 15e3;	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
-	nonlinearIV = false;	// Currently for cross-point array only
-	nonlinearWrite = false;	// Consider weight update nonlinearity or not
-	nonIdenticalPulse = false;	// Use non-identical pulse scheme in weight update or not
+	resistanceAccess = DeviceParam("MeasuredDevice", "resistanceAccess", 15e3);	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
+	nonlinearIV = DeviceParam("MeasuredDevice", "nonlinearIV", false);	// Currently for cross-point array only
+	nonlinearWrite = DeviceParam("MeasuredDevice", "nonlinearWrite", false);	// Consider weight update nonlinearity or not
+	PCMON = false;	// Not a PCM differential pair
+	nonIdenticalPulse = DeviceParam("MeasuredDevice", "nonIdenticalPulse", false);	// Use non-identical pulse scheme in weight update or not
 	if (nonIdenticalPulse) {
 		VinitLTP = 2.85;    // Initial write voltage for LTP or weight increase (V)
 		VstepLTP = 0.05;    // Write voltage step for LTP or weight increase (V)
@@ -867,11 +871,11 @@ MeasuredDevice::MeasuredDevice(int x, int y) {
 		PWstepLTD = 5e-9;   // Write pulse width for LTD or weight decrease (s)
 		writeVoltageSquareSum = 0;  // Sum of V^2 of non-identical pulses (dynamic variable)
 	}
-	readNoise = false;		// Consider read noise or not
-	sigmaReadNoise = 0.0289;	// Sigma of read noise in gaussian distribution
-	NL = 10;	// Nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
+	readNoise = DeviceParam("MeasuredDevice", "readNoise", false);		// Consider read noise or not
+	sigmaReadNoise = DeviceParam("MeasuredDevice", "sigmaReadNoise", 0.0289);	// Sigma of read noise in gaussian distribution
+	NL = DeviceParam("MeasuredDevice", "NL", 10);	// Nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
 	gaussian_dist = new std::normal_distribution<double>(0, sigmaReadNoise);    // Set up mean and stddev for read noise
-	symLTPandLTD = false;	// True: use LTP conductance data for LTD
+	symLTPandLTD = DeviceParam("MeasuredDevice", "symLTPandLTD", false);	// True: use LTP conductance data for LTD
 
 	/* LTP */
 	double rawDataConductanceLTP[] = {0,1.00e-09,2.00e-09,3.00e-09,4.00e-09,5.00e-09,6.00e-09,7.00e-09,8.00e-09,9.00e-09,1.00e-08,1.10e-08,1.20e-08,1.30e-08,1.40e-08,1.50e-08,1.60e-08,1.70e-08,1.80e-08,1.90e-08,2.00e-08,2.10e-08,2.20e-08,2.30e-08,2.40e-08,2.50e-08,2.60e-08,2.70e-08,2.80e-08,2.90e-08,3.00e-08,3.10e-08,3.20e-08,3.30e-08,3.40e-08,3.50e-08,3.60e-08,3.70e-08,3.80e-08,3.90e-08,4.00e-08,4.10e-08,4.20e-08,4.30e-08,4.40e-08,4.50e-08,4.60e-08,4.70e-08,4.80e-08,4.90e-08,5.00e-08,5.10e-08,5.20e-08,5.30e-08,5.40e-08,5.50e-08,5.60e-08,5.70e-08,5.80e-08,5.90e-08,6.00e-08,6.10e-08,6.20e-08,6.30e-08};
@@ -895,6 +899,7 @@ MeasuredDevice::MeasuredDevice(int x, int y) {
 	avgMinConductance = minConductance; // Average minimum cell conductance (S)
 	conductance = minConductance;
 	conductancePrev = conductance;
+	conductanceGp = conductanceGn = 0;	// Not a PCM differential pair
 
 	// Data check
 	/* Check if the conductance range of LTP and LTD are consistent */
@@ -922,17 +927,16 @@ MeasuredDevice::MeasuredDevice(int x, int y) {
 }
 
 double MeasuredDevice::Read(double voltage) {	// Return read current (A)
-	extern std::mt19937 gen;
 	if (nonlinearIV) {
 		// TODO: nonlinear read
 		if (readNoise) {
-			return voltage * conductance * (1 + (*gaussian_dist)(gen));
+			return voltage * conductance * (1 + (*gaussian_dist)(*gen));
 		} else {
 			return voltage * conductance;
 		}
 	} else {
 		if (readNoise) {
-			return voltage * conductance * (1 + (*gaussian_dist)(gen));
+			return voltage * conductance * (1 + (*gaussian_dist)(*gen));
 		} else {
 			return voltage * conductance;
 		}
@@ -1012,12 +1016,12 @@ SRAM::SRAM(int x, int y) {
 	this->x = x; this->y = y;
 	bit = 0;	// Stored bit (1 or 0) (dynamic variable)
 	bitPrev = 0;	// Previous bit
-	heightInFeatureSize = 14.6;	// Cell height in terms of feature size (F)
-	widthInFeatureSize = 10;	// Cell width in terms of feature size (F)
-	widthSRAMCellNMOS = 2.08;	// Pull-down NMOS width in terms of feature size (F)
-	widthSRAMCellPMOS = 1.23;	// Pull-up PMOS width in terms of feature size (F)
-	widthAccessCMOS = 1.31;		// Access transistor width in terms of feature size (F)
-	minSenseVoltage = 0.1;		// Minimum voltage difference (V) for sensing
+	heightInFeatureSize = DeviceParam("SRAM", "heightInFeatureSize", 14.6);	// Cell height in terms of feature size (F)
+	widthInFeatureSize = DeviceParam("SRAM", "widthInFeatureSize", 10);	// Cell width in terms of feature size (F)
+	widthSRAMCellNMOS = DeviceParam("SRAM", "widthSRAMCellNMOS", 2.08);	// Pull-down NMOS width in terms of feature size (F)
+	widthSRAMCellPMOS = DeviceParam("SRAM", "widthSRAMCellPMOS", 1.23);	// Pull-up PMOS width in terms of feature size (F)
+	widthAccessCMOS = DeviceParam("SRAM", "widthAccessCMOS", 1.31);		// Access transistor width in terms of feature size (F)
+	minSenseVoltage = DeviceParam("SRAM", "minSenseVoltage", 0.1);		// Minimum voltage difference (V) for sensing
 	readEnergy = 0;				// Dynamic variable for calculation of read energy (J)
 	writeEnergy = 0;			// Dynamic variable for calculation of write energy (J)
 	readEnergySRAMCell = 0;		// Read energy (J) per SRAM cell (currently not used, it is included in the peripheral circuits of SRAM array in NeuroSim)
@@ -1029,44 +1033,45 @@ DigitalNVM::DigitalNVM(int x, int y) {
 	this->x = x; this->y = y;	// Cell location: x (column) and y (row) start from index 0	
 	bit = 0;	// Stored bit (1 or 0) (dynamic variable), for internel check only and not be used for read
 	bitPrev = 0;	// Previous bit
-	maxConductance = 5e-6;		// Maximum cell conductance (S)
-	minConductance = 100e-9;	// Minimum cell conductance (S)
+	maxConductance = DeviceParam("DigitalNVM", "maxConductance", 5e-6);		// Maximum cell conductance (S)
+	minConductance = DeviceParam("DigitalNVM", "minConductance", 100e-9);	// Minimum cell conductance (S)
 	avgMaxConductance = maxConductance; // Average maximum cell conductance (S)
 	avgMinConductance = minConductance; // Average minimum cell conductance (S)
 	conductance = minConductance;	// Current conductance (S) (dynamic variable)
 	conductancePrev = conductance;	// Previous conductance (S) (dynamic variable)
-	readVoltage = 0.5;	// On-chip read voltage (Vr) (V)
-	readPulseWidth = 5e-9;	// Read pulse width (s) (will be determined by S/A)
-	writeVoltageLTP = 2.5;	// Write voltage (V) for LTP or weight increase
-	writeVoltageLTD = 2.5;	// Write voltage (V) for LTD or weight decrease
-	writePulseWidthLTP = 10e-9;	// Write pulse width (s) for LTP or weight increase
-	writePulseWidthLTD = 10e-9;	// Write pulse width (s) for LTD or weight decrease
+	conductanceGp = conductanceGn = 0;	// Not a PCM differential pair
+	readVoltage = DeviceParam("DigitalNVM", "readVoltage", 0.5);	// On-chip read voltage (Vr) (V)
+	readPulseWidth = DeviceParam("DigitalNVM", "readPulseWidth", 5e-9);	// Read pulse width (s) (will be determined by S/A)
+	writeVoltageLTP = DeviceParam("DigitalNVM", "writeVoltageLTP", 2.5);	// Write voltage (V) for LTP or weight increase
+	writeVoltageLTD = DeviceParam("DigitalNVM", "writeVoltageLTD", 2.5);	// Write voltage (V) for LTD or weight decrease
+	writePulseWidthLTP = DeviceParam("DigitalNVM", "writePulseWidthLTP", 10e-9);	// Write pulse width (s) for LTP or weight increase
+	writePulseWidthLTD = DeviceParam("DigitalNVM", "writePulseWidthLTD", 10e-9);	// Write pulse width (s) for LTD or weight decrease
 	readEnergy = 0;		// Read pulse width (s) (currently not used)
 	writeEnergy = 0;    // Dynamic variable for calculation of write energy (J)
-	cmosAccess = true;	// True: Pseudo-crossbar (1T1R), false: cross-point
-	resistanceAccess = 15e3;	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
-	nonlinearIV = false;	// Consider I-V nonlinearity or not (Currently for cross-point array only)
-	NL = 10;    // Nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
+	cmosAccess = DeviceParam("DigitalNVM", "cmosAccess", true);	// True: Pseudo-crossbar (1T1R), false: cross-point
+	resistanceAccess = DeviceParam("DigitalNVM", "resistanceAccess", 15e3);	// The resistance of transistor (Ohm) in Pseudo-crossbar array when turned ON
+	nonlinearIV = DeviceParam("DigitalNVM", "nonlinearIV", false);	// Consider I-V nonlinearity or not (Currently for cross-point array only)
+	NL = DeviceParam("DigitalNVM", "NL", 10);    // Nonlinearity in write scheme (the current ratio between Vw and Vw/2), assuming for the LTP side
 	if (nonlinearIV) {  // Currently for cross-point array only
 		double Vr_exp = readVoltage;  // XXX: Modify this value to Vr in the reported measurement data (can be different than readVoltage)
 		// Calculation of conductance at on-chip Vr
 		maxConductance = NonlinearConductance(maxConductance, NL, writeVoltageLTP, Vr_exp, readVoltage);
 		minConductance = NonlinearConductance(minConductance, NL, writeVoltageLTP, Vr_exp, readVoltage);
 	}
-	readNoise = false;		// Consider read noise or not
-	sigmaReadNoise = 0.25;	// Sigma of read noise in gaussian distribution
+	readNoise = DeviceParam("DigitalNVM", "readNoise", false);		// Consider read noise or not
+	sigmaReadNoise = DeviceParam("DigitalNVM", "sigmaReadNoise", 0.25);	// Sigma of read noise in gaussian distribution
 	gaussian_dist = new std::normal_distribution<double>(0, sigmaReadNoise);    // Set up mean and stddev for read noise
 	refCurrent = readVoltage * (avgMaxConductance + avgMinConductance) / 2;	// Set up reference current for sensing
 
 	/* Conductance range variation */
-	conductanceRangeVar = false;    // Consider variation of conductance range or not
-	maxConductanceVar = 0;  // Sigma of maxConductance variation (S)
-	minConductanceVar = 0;  // Sigma of minConductance variation (S)
-	std::mt19937 localGen;
-	localGen.seed(std::time(0));
+	conductanceRangeVar = DeviceParam("DigitalNVM", "conductanceRangeVar", false);    // Consider variation of conductance range or not
+	maxConductanceVar = DeviceParam("DigitalNVM", "maxConductanceVar", 0);  // Sigma of maxConductance variation (S)
+	minConductanceVar = DeviceParam("DigitalNVM", "minConductanceVar", 0);  // Sigma of minConductance variation (S)
 	gaussian_dist_maxConductance = new std::normal_distribution<double>(0, maxConductanceVar);
 	gaussian_dist_minConductance = new std::normal_distribution<double>(0, minConductanceVar);
 	if (conductanceRangeVar) {
+		std::mt19937 localGen;	// Only seeded here, since seeding dominates the cell construction time
+		localGen.seed(std::time(0));
 		maxConductance += (*gaussian_dist_maxConductance)(localGen);
 		minConductance += (*gaussian_dist_minConductance)(localGen);
 		if (minConductance >= maxConductance || maxConductance < 0 || minConductance < 0 ) {    // Conductance variation check
@@ -1085,17 +1090,16 @@ DigitalNVM::DigitalNVM(int x, int y) {
 }
 
 double DigitalNVM::Read(double voltage) {	// Return read current (A)
-	extern std::mt19937 gen;
 	if (nonlinearIV) {
 		// TODO: nonlinear read
 		if (readNoise) {
-			return voltage * conductance * (1 + (*gaussian_dist)(gen));
+			return voltage * conductance * (1 + (*gaussian_dist)(*gen));
 		} else {
 			return voltage * conductance;
 		}
 	} else {
 		if (readNoise) {
-			return voltage * conductance * (1 + (*gaussian_dist)(gen));
+			return voltage * conductance * (1 + (*gaussian_dist)(*gen));
 		} else {
 			return voltage * conductance;
 		}
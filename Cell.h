@@ -47,6 +47,7 @@ public:
 	int x, y;	// Cell location: x (column) and y (row) start from index 0
 	double heightInFeatureSize, widthInFeatureSize;	// Cell height/width in terms of feature size (F)
 	double area;	// Cell area (m^2)
+	std::mt19937 *gen;	// Random number engine of the owning simulator (read noise and cycle-to-cycle variation)
 	virtual ~Cell() {}	// Add a virtual function to enable dynamic_cast
 };
 
@@ -175,6 +176,8 @@ public:
 	IdealDevice(int x, int y);
 	double Read(double voltage);	// Return read current (A)
 	void Write(double deltaWeightNormalized);
+	void Erase() {}	// No RESET operation (PCMON=false)
+	void ReWrite(double deltaWeightNormalized) { Write(deltaWeightNormalized); }
 };
 
 class RealDevice: public AnalogNVM {
@@ -202,7 +205,6 @@ public:
 	double NL_LTP_Gn;
 	double paramA_Gp_LTP;
 	double paramA_Gn_LTP;
-	std::mt19937 RandGen;
 	RealDevice(int x, int y);
 	double Read(double voltage);	// Return read current (A)
 	void Write(double deltaWeightNormalized);
@@ -221,6 +223,8 @@ public:
 	MeasuredDevice(int x, int y);
 	double Read(double voltage);	// Return read current (A)
 	void Write(double deltaWeightNormalized);
+	void Erase() {}	// No RESET operation (PCMON=false)
+	void ReWrite(double deltaWeightNormalized) { Write(deltaWeightNormalized); }
 };
 
 #endif
@@ -0,0 +1,397 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Cell.h"
+#include "Array.h"
+#include "Param.h"
+#include "Simulator.h"
+#include "Checkpoint.h"
+
+static_assert(sizeof(RandomGenerator) <= sizeof(((CheckpointHeader *)0)->rng), "CheckpointHeader::rng is too small");
+static_assert(sizeof(CheckpointHeader) % 8 == 0 && sizeof(CheckpointLayer) % 8 == 0 && sizeof(CheckpointCell) % 8 == 0, "Checkpoint records must keep the doubles aligned");
+
+/* std::mt19937 and std::normal_distribution only expose their state through the stream operators */
+static void SaveEngine(const std::mt19937& engine, uint32_t *state) {
+	std::stringstream ss;
+	ss << engine;
+	for (int i=0; i<625; i++)
+		ss >> state[i];
+}
+
+static void LoadEngine(std::mt19937& engine, const uint32_t *state) {
+	std::stringstream ss;
+	for (int i=0; i<625; i++)
+		ss << state[i] << ' ';
+	ss >> engine;
+}
+
+static void SaveDistribution(const std::normal_distribution<double> *dist, double *saved, int32_t *savedAvailable) {
+	std::stringstream ss;
+	ss << *dist;
+	double mean, stddev;
+	int available = 0;
+	*saved = 0;
+	ss >> mean >> stddev >> available;
+	if (available)
+		ss >> *saved;
+	*savedAvailable = available;
+}
+
+static void LoadDistribution(std::normal_distribution<double> *dist, double saved, int32_t savedAvailable) {
+	std::stringstream ss;
+	ss.precision(17);
+	ss << dist->mean() << ' ' << dist->stddev() << ' ' << savedAvailable;
+	if (savedAvailable)
+		ss << ' ' << saved;
+	ss >> *dist;
+}
+
+static int NumCell(Array *array) {
+	return array->arrayColSize * array->numCellPerSynapse * array->arrayRowSize;
+}
+
+/* The pulse counters exist only with param->enduranceReport (see Array::EnableEnduranceCounters) */
+static int NumCounter(Array *array) {
+	return array->numSetPulse? NumCell(array) : 0;
+}
+
+static void SaveCell(Cell *cell, CheckpointCell *record) {
+	memset(record, 0, sizeof(CheckpointCell));
+	if (SRAM *sram = dynamic_cast<SRAM*>(cell)) {
+		record->readEnergy = sram->readEnergy;
+		record->writeEnergy = sram->writeEnergy;
+		record->bit = sram->bit;
+		record->bitPrev = sram->bitPrev;
+		return;
+	}
+	eNVM *envm = dynamic_cast<eNVM*>(cell);
+	record->conductance = envm->conductance;
+	record->conductancePrev = envm->conductancePrev;
+	record->maxConductance = envm->maxConductance;
+	record->minConductance = envm->minConductance;
+	record->conductanceGp = envm->conductanceGp;
+	record->conductanceGn = envm->conductanceGn;
+	record->conductanceGpPrev = envm->conductanceGpPrev;
+	record->conductanceGnPrev = envm->conductanceGnPrev;
+	record->conductanceRef = envm->conductanceRef;
+	record->readEnergy = envm->readEnergy;
+	record->writeEnergy = envm->writeEnergy;
+	record->writeVoltageLTP = envm->writeVoltageLTP;
+	record->writeVoltageLTD = envm->writeVoltageLTD;
+	record->writePulseWidthLTP = envm->writePulseWidthLTP;
+	record->writePulseWidthLTD = envm->writePulseWidthLTD;
+	SaveDistribution(envm->gaussian_dist, &record->readNoiseSaved, &record->readNoiseSavedAvailable);
+	if (DigitalNVM *digital = dynamic_cast<DigitalNVM*>(cell)) {
+		record->bit = digital->bit;
+		record->bitPrev = digital->bitPrev;
+		return;
+	}
+	AnalogNVM *analog = static_cast<AnalogNVM*>(cell);
+	record->writeLatencyLTP = analog->writeLatencyLTP;
+	record->writeLatencyLTD = analog->writeLatencyLTD;
+	record->writeVoltageSquareSum = analog->writeVoltageSquareSum;
+	record->numPulse = analog->numPulse;
+	if (RealDevice *real = dynamic_cast<RealDevice*>(cell)) {
+		record->xPulse = real->xPulse;
+		record->xPulseGp = real->xPulseGp;
+		record->xPulseGn = real->xPulseGn;
+		record->paramALTP = real->paramALTP;
+		record->paramBLTP = real->paramBLTP;
+		record->paramALTD = real->paramALTD;
+		record->paramBLTD = real->paramBLTD;
+		record->paramA_Gp_LTP = real->paramA_Gp_LTP;
+		record->paramA_Gn_LTP = real->paramA_Gn_LTP;
+		record->paramB_Gp = real->paramB_Gp;
+		record->paramB_Gn = real->paramB_Gn;
+		record->paramA_RESET = real->paramA_RESET;
+		SaveDistribution(real->gaussian_dist3, &record->writeNoiseSaved, &record->writeNoiseSavedAvailable);
+	} else if (MeasuredDevice *measured = dynamic_cast<MeasuredDevice*>(cell)) {
+		record->xPulse = measured->xPulse;
+	}
+}
+
+static void LoadCell(Cell *cell, const CheckpointCell *record) {
+	if (SRAM *sram = dynamic_cast<SRAM*>(cell)) {
+		sram->readEnergy = record->readEnergy;
+		sram->writeEnergy = record->writeEnergy;
+		sram->bit = record->bit;
+		sram->bitPrev = record->bitPrev;
+		return;
+	}
+	eNVM *envm = dynamic_cast<eNVM*>(cell);
+	envm->conductance = record->conductance;
+	envm->conductancePrev = record->conductancePrev;
+	envm->maxConductance = record->maxConductance;
+	envm->minConductance = record->minConductance;
+	envm->conductanceGp = record->conductanceGp;
+	envm->conductanceGn = record->conductanceGn;
+	envm->conductanceGpPrev = record->conductanceGpPrev;
+	envm->conductanceGnPrev = record->conductanceGnPrev;
+	envm->conductanceRef = record->conductanceRef;
+	envm->readEnergy = record->readEnergy;
+	envm->writeEnergy = record->writeEnergy;
+	envm->writeVoltageLTP = record->writeVoltageLTP;
+	envm->writeVoltageLTD = record->writeVoltageLTD;
+	envm->writePulseWidthLTP = record->writePulseWidthLTP;
+	envm->writePulseWidthLTD = record->writePulseWidthLTD;
+	LoadDistribution(envm->gaussian_dist, record->readNoiseSaved, record->readNoiseSavedAvailable);
+	if (DigitalNVM *digital = dynamic_cast<DigitalNVM*>(cell)) {
+		digital->bit = record->bit;
+		digital->bitPrev = record->bitPrev;
+		return;
+	}
+	AnalogNVM *analog = static_cast<AnalogNVM*>(cell);
+	analog->writeLatencyLTP = record->writeLatencyLTP;
+	analog->writeLatencyLTD = record->writeLatencyLTD;
+	analog->writeVoltageSquareSum = record->writeVoltageSquareSum;
+	analog->numPulse = record->numPulse;
+	if (RealDevice *real = dynamic_cast<RealDevice*>(cell)) {
+		real->xPulse = record->xPulse;
+		real->xPulseGp = record->xPulseGp;
+		real->xPulseGn = record->xPulseGn;
+		real->paramALTP = record->paramALTP;
+		real->paramBLTP = record->paramBLTP;
+		real->paramALTD = record->paramALTD;
+		real->paramBLTD = record->paramBLTD;
+		real->paramA_Gp_LTP = record->paramA_Gp_LTP;
+		real->paramA_Gn_LTP = record->paramA_Gn_LTP;
+		real->paramB_Gp = record->paramB_Gp;
+		real->paramB_Gn = record->paramB_Gn;
+		real->paramA_RESET = record->paramA_RESET;
+		LoadDistribution(real->gaussian_dist3, record->writeNoiseSaved, record->writeNoiseSavedAvailable);
+	} else if (MeasuredDevice *measured = dynamic_cast<MeasuredDevice*>(cell)) {
+		measured->xPulse = record->xPulse;
+	}
+}
+
+/* Write the checkpoint to fileName.tmp and rename it, so an interrupted write never leaves a truncated checkpoint behind */
+void Simulator::SaveCheckpoint(const char *fileName) {
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, CHECKPOINT_MAGIC);
+	header.version = CHECKPOINT_VERSION;
+	header.headerSize = sizeof(CheckpointHeader);
+	header.cellSize = sizeof(CheckpointCell);
+	header.layerSize = sizeof(CheckpointLayer);
+	header.epoch = epoch;
+	header.numLayers = layers.size();
+	header.bestAccuracy = bestAccuracy;
+	header.numRoundsNoImprove = numRoundsNoImprove;
+	SaveEngine(gen, header.gen);
+	memcpy(header.rng, &rng, sizeof(RandomGenerator));
+	std::vector<CheckpointLayer> layerRecords(layers.size());
+	for (int l=0; l<layers.size(); l++) {
+		CheckpointLayer& record = layerRecords[l];
+		memset(&record, 0, sizeof(record));
+		record.numInput = layers[l]->numInput;
+		record.numOutput = layers[l]->numOutput;
+		record.deviceType = layers[l]->deviceType;
+		record.numCell = NumCell(layers[l]->array);
+		record.numCounter = NumCounter(layers[l]->array);
+		record.arrayReadEnergy = layers[l]->array->readEnergy;
+		record.arrayWriteEnergy = layers[l]->array->writeEnergy;
+		record.subArrayReadLatency = layers[l]->subArray->readLatency;
+		record.subArrayWriteLatency = layers[l]->subArray->writeLatency;
+		record.subArrayReadDynamicEnergy = layers[l]->subArray->readDynamicEnergy;
+		record.subArrayWriteDynamicEnergy = layers[l]->subArray->writeDynamicEnergy;
+		const CostBreakdown& cost = layers[l]->cost;
+		memcpy(record.costReadEnergy, cost.readEnergy, sizeof(cost.readEnergy));
+		memcpy(record.costWriteEnergy, cost.writeEnergy, sizeof(cost.writeEnergy));
+		memcpy(record.costReadLatency, cost.readLatency, sizeof(cost.readLatency));
+		memcpy(record.costWriteLatency, cost.writeLatency, sizeof(cost.writeLatency));
+		record.readTimingLatency = layers[l]->readTiming.latency;
+		record.readTimingInterval = layers[l]->readTiming.interval;
+		memcpy(record.readTimingBusy, layers[l]->readTiming.busy, sizeof(record.readTimingBusy));
+		record.numTimedReads = layers[l]->numTimedReads;
+	}
+
+	std::string tempFileName = std::string(fileName) + ".tmp";
+	FILE *fp = fopen(tempFileName.c_str(), "wb");
+	if (!fp) {
+		std::cout << "[Checkpoint] Error: cannot open " << tempFileName << std::endl;
+		exit(-1);
+	}
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+	ok = ok && fwrite(&layerRecords[0], sizeof(CheckpointLayer), layerRecords.size(), fp) == layerRecords.size();
+	for (int l=0; l<layers.size() && ok; l++) {
+		for (int i=0; i<layers[l]->numOutput && ok; i++)
+			ok = fwrite(&layers[l]->weight[i][0], sizeof(double), layers[l]->numInput, fp) == layers[l]->numInput;
+	}
+	for (int l=0; l<layers.size() && ok; l++) {
+		Array *array = layers[l]->array;
+		std::vector<CheckpointCell> records(array->arrayRowSize);
+		for (int col=0; col<array->arrayColSize*array->numCellPerSynapse && ok; col++) {
+			for (int row=0; row<array->arrayRowSize; row++) {
+				SaveCell(array->cell[col][row], &records[row]);
+			}
+			ok = fwrite(&records[0], sizeof(CheckpointCell), records.size(), fp) == records.size();
+		}
+	}
+	for (int l=0; l<layers.size() && ok; l++) {
+		Array *array = layers[l]->array;
+		if (!array->numSetPulse)
+			continue;
+		int numCol = array->arrayColSize * array->numCellPerSynapse;
+		for (int row=0; row<array->arrayRowSize && ok; row++)
+			ok = fwrite(array->numSetPulse[row], sizeof(uint32_t), numCol, fp) == numCol;
+		for (int row=0; row<array->arrayRowSize && ok; row++)
+			ok = fwrite(array->numResetPulse[row], sizeof(uint32_t), numCol, fp) == numCol;
+	}
+	ok = ok && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+	ok = (fclose(fp) == 0) && ok;
+	if (!ok || rename(tempFileName.c_str(), fileName) != 0) {
+		std::cout << "[Checkpoint] Error: cannot write " << fileName << std::endl;
+		remove(tempFileName.c_str());
+		exit(-1);
+	}
+}
+
+/* Restore the state saved by SaveCheckpoint (the arrays and NeuroSim cores must be initialized with the same network and devices) */
+void Simulator::LoadCheckpoint(const char *fileName) {
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		std::cout << fileName << " cannot be found!\n";
+		exit(-1);
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)sizeof(CheckpointHeader)) {
+		std::cout << "[Checkpoint] Error: " << fileName << " is not a checkpoint" << std::endl;
+		exit(-1);
+	}
+	void *data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		std::cout << "[Checkpoint] Error: cannot map " << fileName << std::endl;
+		exit(-1);
+	}
+
+	const CheckpointHeader *header = (const CheckpointHeader *)data;
+	if (strcmp(header->magic, CHECKPOINT_MAGIC) != 0 || header->version != CHECKPOINT_VERSION || header->headerSize != sizeof(CheckpointHeader)
+			|| header->cellSize != sizeof(CheckpointCell) || header->layerSize != sizeof(CheckpointLayer)) {
+		std::cout << "[Checkpoint] Error: " << fileName << " is not a version " << CHECKPOINT_VERSION << " checkpoint" << std::endl;
+		exit(-1);
+	}
+	const CheckpointLayer *layerRecords = (const CheckpointLayer *)(header + 1);
+	bool sameNetwork = header->numLayers == (int)layers.size()
+			&& (size_t)fileStat.st_size >= sizeof(CheckpointHeader) + sizeof(CheckpointLayer) * layers.size();
+	size_t expectedSize = sizeof(CheckpointHeader) + sizeof(CheckpointLayer) * layers.size();
+	for (int l=0; l<layers.size() && sameNetwork; l++) {
+		sameNetwork = layerRecords[l].numInput == layers[l]->numInput && layerRecords[l].numOutput == layers[l]->numOutput
+				&& layerRecords[l].deviceType == layers[l]->deviceType && layerRecords[l].numCell == NumCell(layers[l]->array)
+				&& (layerRecords[l].numCounter == 0 || layerRecords[l].numCounter == layerRecords[l].numCell);
+		expectedSize += sizeof(double) * layers[l]->numInput * layers[l]->numOutput + sizeof(CheckpointCell) * (size_t)layerRecords[l].numCell
+				+ sizeof(uint32_t) * 2 * (size_t)layerRecords[l].numCounter;
+	}
+	if (!sameNetwork) {
+		std::cout << "[Checkpoint] Error: " << fileName << " was saved with a different network or device" << std::endl;
+		exit(-1);
+	}
+	for (int l=0; l<layers.size(); l++) {
+		if (NumCounter(layers[l]->array) && !layerRecords[l].numCounter) {	// The report would leave out the pulses before the checkpoint
+			std::cout << "[Checkpoint] Error: " << fileName << " was saved without enduranceReport" << std::endl;
+			exit(-1);
+		}
+	}
+	if ((size_t)fileStat.st_size != expectedSize) {
+		std::cout << "[Checkpoint] Error: " << fileName << " is truncated" << std::endl;
+		exit(-1);
+	}
+
+	epoch = header->epoch;
+	bestAccuracy = header->bestAccuracy;
+	numRoundsNoImprove = header->numRoundsNoImprove;
+	LoadEngine(gen, header->gen);
+	memcpy(&rng, header->rng, sizeof(RandomGenerator));
+	for (int l=0; l<layers.size(); l++) {
+		layers[l]->array->readEnergy = layerRecords[l].arrayReadEnergy;
+		layers[l]->array->writeEnergy = layerRecords[l].arrayWriteEnergy;
+		layers[l]->subArray->readLatency = layerRecords[l].subArrayReadLatency;
+		layers[l]->subArray->writeLatency = layerRecords[l].subArrayWriteLatency;
+		layers[l]->subArray->readDynamicEnergy = layerRecords[l].subArrayReadDynamicEnergy;
+		layers[l]->subArray->writeDynamicEnergy = layerRecords[l].subArrayWriteDynamicEnergy;
+		CostBreakdown& cost = layers[l]->cost;
+		memcpy(cost.readEnergy, layerRecords[l].costReadEnergy, sizeof(cost.readEnergy));
+		memcpy(cost.writeEnergy, layerRecords[l].costWriteEnergy, sizeof(cost.writeEnergy));
+		memcpy(cost.readLatency, layerRecords[l].costReadLatency, sizeof(cost.readLatency));
+		memcpy(cost.writeLatency, layerRecords[l].costWriteLatency, sizeof(cost.writeLatency));
+		layers[l]->readTiming.latency = layerRecords[l].readTimingLatency;
+		layers[l]->readTiming.interval = layerRecords[l].readTimingInterval;
+		memcpy(layers[l]->readTiming.busy, layerRecords[l].readTimingBusy, sizeof(layers[l]->readTiming.busy));
+		layers[l]->numTimedReads = layerRecords[l].numTimedReads;
+	}
+
+	const double *weights = (const double *)(layerRecords + layers.size());
+	for (int l=0; l<layers.size(); l++) {
+		for (int i=0; i<layers[l]->numOutput; i++, weights += layers[l]->numInput)
+			memcpy(&layers[l]->weight[i][0], weights, sizeof(double) * layers[l]->numInput);
+	}
+	const CheckpointCell *record = (const CheckpointCell *)weights;
+	for (int l=0; l<layers.size(); l++) {
+		Array *array = layers[l]->array;
+		for (int col=0; col<array->arrayColSize*array->numCellPerSynapse; col++) {
+			for (int row=0; row<array->arrayRowSize; row++, record++) {
+				LoadCell(array->cell[col][row], record);
+			}
+		}
+		array->PackWeights();
+	}
+	const uint32_t *counter = (const uint32_t *)record;
+	for (int l=0; l<layers.size(); l++) {	// Counters saved with enduranceReport are skipped if it is now off
+		Array *array = layers[l]->array;
+		int numCol = array->arrayColSize * array->numCellPerSynapse;
+		if (array->numSetPulse) {
+			for (int row=0; row<array->arrayRowSize; row++)
+				memcpy(array->numSetPulse[row], counter + row * numCol, sizeof(uint32_t) * numCol);
+			for (int row=0; row<array->arrayRowSize; row++)
+				memcpy(array->numResetPulse[row], counter + layerRecords[l].numCell + row * numCol, sizeof(uint32_t) * numCol);
+		}
+		counter += 2 * layerRecords[l].numCounter;
+	}
+	munmap(data, fileStat.st_size);
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <stdint.h>
+#include "CostBreakdown.h"
+
+/* Binary checkpoint of a Simulator (see Simulator::SaveCheckpoint and Simulator::LoadCheckpoint)
+ * Layout, all fields in native byte order and fixed size so the file can be mmap'ed:
+ *   CheckpointHeader
+ *   numLayers CheckpointLayer, from the input side
+ *   weights of every layer (numOutput x numInput doubles)
+ *   CheckpointCell of the array of every layer (numCell records, column-major like Array::cell)
+ *   SET then RESET pulse counters of every layer with numCounter > 0 (numCounter uint32_t each,
+ *   row-major like Array::numSetPulse)
+ * CHECKPOINT_VERSION must be bumped whenever one of the structs below changes. */
+#define CHECKPOINT_MAGIC	"MLPCKPT"
+#define CHECKPOINT_VERSION	4
+
+struct CheckpointHeader {
+	char magic[8];		// CHECKPOINT_MAGIC
+	uint32_t version;	// CHECKPOINT_VERSION
+	uint32_t headerSize, cellSize, layerSize;	// sizeof(CheckpointHeader), sizeof(CheckpointCell) and sizeof(CheckpointLayer)
+	int32_t epoch;		// # of trained epochs
+	int32_t numLayers;	// # of CheckpointLayer records
+	/* Early stop state */
+	int32_t numRoundsNoImprove;
+	int32_t padding;
+	double bestAccuracy;
+	/* Random number generators */
+	uint32_t gen[625];	// std::mt19937 state words and position
+	uint32_t padding2;
+	char rng[160];		// RandomGenerator (trivially copyable)
+};
+
+/* Shape, device and cumulative energy and latency counters of one layer */
+struct CheckpointLayer {
+	int32_t numInput, numOutput;
+	int32_t deviceType;
+	int32_t numCell;	// # of cell records of the array (columns x cells per synapse x rows)
+	int32_t numCounter;	// # of SET and of RESET pulse counters (numCell with param->enduranceReport, 0 otherwise)
+	int32_t padding;
+	double arrayReadEnergy, arrayWriteEnergy;
+	double subArrayReadLatency, subArrayWriteLatency;
+	double subArrayReadDynamicEnergy, subArrayWriteDynamicEnergy;
+	/* Layer::cost (param->costBreakdown) */
+	double costReadEnergy[NUM_COST_COMPONENTS], costWriteEnergy[NUM_COST_COMPONENTS];
+	double costReadLatency[NUM_COST_COMPONENTS], costWriteLatency[NUM_COST_COMPONENTS];
+	/* Layer::readTiming and Layer::numTimedReads (param->eventDrivenReadTiming) */
+	double readTimingLatency, readTimingInterval;
+	double readTimingBusy[NUM_READ_STAGES];
+	int64_t numTimedReads;
+};
+
+/* Dynamic state of one cell; fields that the cell type does not have are left 0 */
+struct CheckpointCell {
+	/* eNVM */
+	double conductance, conductancePrev;
+	double maxConductance, minConductance;	// Include the conductance range variation drawn at construction
+	double conductanceGp, conductanceGn, conductanceGpPrev, conductanceGnPrev, conductanceRef;
+	double readEnergy, writeEnergy;
+	double writeVoltageLTP, writeVoltageLTD, writePulseWidthLTP, writePulseWidthLTD;
+	/* AnalogNVM */
+	double writeLatencyLTP, writeLatencyLTD, writeVoltageSquareSum;
+	/* RealDevice (the nonlinearity parameters include the device-to-device variation drawn at construction) and MeasuredDevice */
+	double xPulse, xPulseGp, xPulseGn;
+	double paramALTP, paramBLTP, paramALTD, paramBLTD;
+	double paramA_Gp_LTP, paramA_Gn_LTP, paramB_Gp, paramB_Gn, paramA_RESET;
+	/* Cached second value of the read noise and cycle-to-cycle variation distributions */
+	double readNoiseSaved, writeNoiseSaved;
+	int32_t readNoiseSavedAvailable, writeNoiseSavedAvailable;
+	int32_t numPulse;
+	/* SRAM and DigitalNVM */
+	int32_t bit, bitPrev;
+	int32_t padding;
+};
+
+#endif
@@ -0,0 +1,337 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+#include "NeuroSim.h"
+#include "NeuroSim/constant.h"
+#include "NeuroSim/formula.h"
+#include "Param.h"
+#include "Layer.h"
+#include "Chip.h"
+
+Chip::Chip(const std::vector<Layer*>& layers): layers(layers) {
+	param = NULL;
+	globalBuffer = localBuffer = NULL;
+	numTrainImages = 0;
+}
+
+Chip::~Chip() {
+	delete globalBuffer;
+	delete localBuffer;
+}
+
+void Chip::Initialize(const Param *param) {
+	this->param = param;
+	const Layer *first = layers[0];	// The layers share the technology
+	const Technology& tech = first->tech;
+	int numLayers = layers.size();
+	int subArraysPerChipTile = param->subArraysPerChipTile;
+	int busWidth = param->htreeBusWidth;
+
+	/* Map the subarray tiles of every layer in row major order onto its own chip tiles */
+	traffic.assign(numLayers, LayerTraffic());
+	inferenceEnergy.assign(numLayers, 0);
+	inferenceLatency.assign(numLayers, 0);
+	trainEnergy.assign(numLayers, 0);
+	trainReadLatency.assign(numLayers, 0);
+	trainWriteLatency.assign(numLayers, 0);
+	numUsedChipTiles = 0;
+	areaSubArray = areaNeuron = 0;
+	leakage = 0;
+	double maxChipTileContent = 0;	// Subarrays and neuron peripheries of the fullest chip tile
+	int localBufferBits = 0, globalBufferBits = 0;
+	for (int l=0; l<numLayers; l++) {
+		Layer *layer = layers[l];
+		LayerTraffic& t = traffic[l];
+		int numSubArray = layer->numTileRow * layer->numTileCol;
+		double neuronArea = layer->NeuronArea();
+		areaSubArray += layer->SubArrayArea();
+		areaNeuron += neuronArea;
+		leakage += layer->SubArrayLeakagePower() + layer->NeuronLeakagePower();
+		maxChipTileContent = std::max(maxChipTileContent, std::min(subArraysPerChipTile, numSubArray) * (layer->subArray->usedArea + neuronArea / numSubArray));
+
+		t.firstChipTile = numUsedChipTiles;
+		t.numChipTile = (numSubArray + subArraysPerChipTile - 1) / subArraysPerChipTile;
+		numUsedChipTiles += t.numChipTile;
+		t.inputBits = t.outputBits = 0;
+		t.numFlit = 0;
+		for (int c=0; c<t.numChipTile; c++) {
+			/* A chip tile needs the inputs of the tile rows it holds and returns the partial sums of its tile columns */
+			int begin = c * subArraysPerChipTile;
+			int end = std::min(begin + subArraysPerChipTile, numSubArray);
+			std::vector<bool> hostsTileRow(layer->numTileRow, false), hostsTileCol(layer->numTileCol, false);
+			for (int k=begin; k<end; k++) {
+				hostsTileRow[k / layer->numTileCol] = true;
+				hostsTileCol[k % layer->numTileCol] = true;
+			}
+			int rows = 0, cols = 0;
+			for (int r=0; r<layer->numTileRow; r++) {
+				if (hostsTileRow[r])
+					rows += std::min(layer->tileRows, layer->numInput - r * layer->tileRows);
+			}
+			for (int col=0; col<layer->numTileCol; col++) {
+				if (hostsTileCol[col])
+					cols += std::min(layer->tileCols, layer->numOutput - col * layer->tileCols);
+			}
+			int inputBits = rows * param->numBitInput;
+			int outputBits = cols * param->numBitPartialSum;
+			t.inputBits += inputBits;
+			t.outputBits += outputBits;
+			t.numFlit += (inputBits + busWidth - 1) / busWidth + (outputBits + busWidth - 1) / busWidth;
+			localBufferBits = std::max(localBufferBits, inputBits + outputBits);
+		}
+		/* The global buffer holds the inputs of the layer and the partial sums coming back */
+		globalBufferBits = std::max(globalBufferBits, layer->numInput * param->numBitInput + (int)t.outputBits);
+	}
+	if (param->numChipTiles > 0 && param->numChipTiles < numUsedChipTiles) {
+		printf("[Chip] Error: the network needs %d chip tiles of %d subarrays but numChipTiles=%d\n", numUsedChipTiles, subArraysPerChipTile, param->numChipTiles);
+		exit(-1);
+	}
+	numChipTiles = param->numChipTiles > 0? param->numChipTiles : numUsedChipTiles;
+
+	/* Activation buffers */
+	delete globalBuffer;
+	delete localBuffer;
+	globalBuffer = new DFF(first->inputParameter, tech, first->cell);
+	localBuffer = new DFF(first->inputParameter, tech, first->cell);
+	globalBuffer->Initialize(globalBufferBits, param->clkFreq);
+	localBuffer->Initialize(localBufferBits, param->clkFreq);
+	globalBuffer->CalculateArea(NULL, NULL, NONE);
+	localBuffer->CalculateArea(NULL, NULL, NONE);
+	globalBuffer->CalculatePower(1, busWidth);
+	localBuffer->CalculatePower(1, busWidth);
+	bufferEnergyPerFlit = globalBuffer->readDynamicEnergy + localBuffer->readDynamicEnergy;
+	leakage += globalBuffer->leakage + localBuffer->leakage * numChipTiles;
+	areaGlobalBuffer = globalBuffer->area;
+	areaLocalBuffer = localBuffer->area * numChipTiles;
+
+	/* Square floorplan of chip tiles with the global buffer at the center */
+	chipTileWidth = sqrt(maxChipTileContent + localBuffer->area);
+	numTilesPerSide = (int)ceil(sqrt((double)numChipTiles));
+	numHTreeLevels = (int)ceil(log2((double)numTilesPerSide));
+	chipWidth = chipTileWidth * numTilesPerSide;
+
+	/* H-tree: level i has 4^i H shapes of arm length chipWidth/2^(i+2), a flit crosses two arms per level */
+	const double repeaterSize = 20;	// Repeater width in minimum transistor widths
+	double widthRepeaterN = repeaterSize * MIN_NMOS_SIZE * tech.featureSize;
+	double widthRepeaterP = tech.pnSizeRatio * widthRepeaterN;
+	double resRepeater = CalculateOnResistance(widthRepeaterN, NMOS, first->inputParameter.temperature, tech);
+	double capRepeaterInput = CalculateGateCap(widthRepeaterN, tech) + CalculateGateCap(widthRepeaterP, tech);
+	double capRepeaterOutput = CalculateDrainCap(widthRepeaterN, NMOS, tech.featureSize * MAX_TRANSISTOR_HEIGHT, tech)
+								+ CalculateDrainCap(widthRepeaterP, PMOS, tech.featureSize * MAX_TRANSISTOR_HEIGHT, tech);
+	double unitLengthWireCap = 0.2e-15/1e-6;	// Same wires as the synaptic arrays
+	double unitLengthWireResistance = first->array->unitLengthWireResistance;
+	double totalWireLength = 0;
+	hTreeLatency = hTreeEnergyPerBit = 0;
+	for (int i=0; i<numHTreeLevels; i++) {
+		double arm = chipWidth / pow(2, i + 2);
+		double segment = 2 * arm;
+		double capWire = segment * unitLengthWireCap;
+		double resWire = segment * unitLengthWireResistance;
+		double capLoad = capRepeaterOutput + capWire + capRepeaterInput;
+		hTreeLatency += 0.69 * resRepeater * capLoad + resWire * (0.38 * capWire + 0.69 * capRepeaterInput);
+		hTreeEnergyPerBit += capLoad * tech.vdd * tech.vdd / 2;	// Half of the bits toggle
+		totalWireLength += pow(4, i) * 6 * arm;
+	}
+	areaHTree = totalWireLength * busWidth * 2 * tech.featureSize;	// Wire pitch of 2F
+	flitLatency = std::max(1 / param->clkFreq, hTreeLatency);
+
+	for (int l=0; l<numLayers; l++) {
+		LayerTraffic& t = traffic[l];
+		t.energy = (t.inputBits + t.outputBits) * hTreeEnergyPerBit + t.numFlit * bufferEnergyPerFlit;
+		t.latency = t.numFlit * flitLatency;
+	}
+
+	area = numChipTiles * chipTileWidth * chipTileWidth + areaGlobalBuffer + areaHTree;
+	areaUnused = area - areaSubArray - areaNeuron - areaLocalBuffer - areaGlobalBuffer - areaHTree;
+
+	/* Ping-pong buffers for the network input and the output of every stage but the last */
+	stageBufferBits = 2 * layers[0]->numInput * param->numBitInput;
+	for (int l=0; l<numLayers-1; l++) {
+		stageBufferBits += 2 * layers[l]->numOutput * param->numBitInput;
+	}
+	numReplica.assign(numLayers, 1);
+}
+
+/* Total synaptic energy spent so far by a layer */
+static double LayerEnergy(const Layer *layer) {
+	return layer->array->readEnergy + layer->array->writeEnergy + layer->subArray->readDynamicEnergy + layer->subArray->writeDynamicEnergy;
+}
+
+void Chip::BeginTraining() {
+	startEnergy.resize(layers.size());
+	startReadLatency.resize(layers.size());
+	startWriteLatency.resize(layers.size());
+	for (int l=0; l<layers.size(); l++) {
+		startEnergy[l] = LayerEnergy(layers[l]);
+		startReadLatency[l] = layers[l]->subArray->readLatency;
+		startWriteLatency[l] = layers[l]->subArray->writeLatency;
+	}
+}
+
+void Chip::EndTraining(int numImages) {
+	numTrainImages += numImages;
+	for (int l=0; l<layers.size(); l++) {
+		trainEnergy[l] += LayerEnergy(layers[l]) - startEnergy[l];
+		trainReadLatency[l] += layers[l]->subArray->readLatency - startReadLatency[l];
+		trainWriteLatency[l] += layers[l]->subArray->writeLatency - startWriteLatency[l];
+	}
+}
+
+/* Duplicate the weights of the slowest stage while the unused chip tiles can hold another copy and the
+ * stage is slower than the H-tree. The copies take alternate images, the H-tree still carries every transfer. */
+void Chip::BalancePipeline() {
+	int numSpareChipTiles = numChipTiles - numUsedChipTiles;
+	double movementLatency = 0;
+	for (int l=0; l<layers.size(); l++) {
+		movementLatency += traffic[l].latency;
+	}
+	numReplica.assign(layers.size(), 1);
+	while (true) {
+		int slowest = 0;
+		for (int l=1; l<layers.size(); l++) {
+			if ((inferenceLatency[l] + traffic[l].latency) / numReplica[l] > (inferenceLatency[slowest] + traffic[slowest].latency) / numReplica[slowest])
+				slowest = l;
+		}
+		if ((inferenceLatency[slowest] + traffic[slowest].latency) / numReplica[slowest] <= movementLatency || traffic[slowest].numChipTile > numSpareChipTiles)
+			break;	// H-tree bound or no room for another copy
+		numSpareChipTiles -= traffic[slowest].numChipTile;
+		numReplica[slowest]++;
+	}
+}
+
+void Chip::SetInferenceCost(int l, double energy, double latency) {
+	inferenceEnergy[l] = energy;
+	inferenceLatency[l] = latency;
+}
+
+void Chip::PrintReport() {
+	printf("Chip: %d tiles of %d subarrays (%d used, %dx%d floorplan, %d H-tree levels), area=%.4e m^2\n", numChipTiles, param->subArraysPerChipTile, numUsedChipTiles, numTilesPerSide, numTilesPerSide, numHTreeLevels, area);
+	BalancePipeline();
+	double areaReplica = 0, replicaLeakage = 0;	// The extra copies of the weights on the unused chip tiles
+	for (int l=0; l<layers.size(); l++) {
+		areaReplica += (numReplica[l] - 1) * (layers[l]->SubArrayArea() + layers[l]->NeuronArea());
+		replicaLeakage += (numReplica[l] - 1) * (layers[l]->SubArrayLeakagePower() + layers[l]->NeuronLeakagePower());
+	}
+	printf("\tArea breakdown: subarrays=%.4e, neuron peripheries=%.4e, replicas=%.4e, local buffers=%.4e, global buffer=%.4e, H-tree=%.4e, unused=%.4e m^2\n", areaSubArray, areaNeuron, areaReplica, areaLocalBuffer, areaGlobalBuffer, areaHTree, areaUnused - areaReplica);
+	printf("\tLeakage power=%.4e W (replicas %.4e W)\n", leakage, replicaLeakage);
+	double ops = 0;	// Multiply and add of every synapse
+	double movementEnergy = 0, movementLatency = 0;
+	double synapticEnergy = 0, synapticLatency = 0;
+	double trainSynapticEnergy = 0, trainSynapticLatency = 0;
+	for (int l=0; l<layers.size(); l++) {
+		const LayerTraffic& t = traffic[l];
+		printf("\tLayer %s: chip tiles %d-%d, %.0f input bits and %.0f partial sum bits per inference\n", layers[l]->name.c_str(), t.firstChipTile, t.firstChipTile + t.numChipTile - 1, t.inputBits, t.outputBits);
+		ops += 2.0 * layers[l]->numInput * layers[l]->numOutput;
+		movementEnergy += t.energy;
+		movementLatency += t.latency;
+		synapticEnergy += inferenceEnergy[l];
+		synapticLatency += inferenceLatency[l];
+		trainSynapticEnergy += trainEnergy[l];
+		trainSynapticLatency += trainReadLatency[l] + trainWriteLatency[l];
+	}
+	double bufferAreaPerBit = globalBuffer->area / globalBuffer->numDff;
+
+	/* Layer by layer: the layers and the transfers run one after the other */
+	if (synapticLatency > 0) {
+		double latency = synapticLatency + movementLatency;
+		double energy = synapticEnergy + movementEnergy + leakage * latency;
+		printf("\tInference: latency=%.4e s, energy=%.4e J (buffers and H-tree %.4e J), %.4e inferences/s, %.4f TOPS/W\n", latency, energy, movementEnergy, 1 / latency, ops / energy / 1e12);
+
+		/* Pipeline: a new image enters every initiation interval, bounded by the slowest stage and the shared H-tree */
+		double interval = movementLatency;
+		const char *bottleneck = "H-tree";
+		printf("\tPipeline stages:");
+		for (int l=0; l<layers.size(); l++) {
+			double stageLatency = inferenceLatency[l] + traffic[l].latency;
+			printf(" %s=%.4e s (x%d)", layers[l]->name.c_str(), stageLatency, numReplica[l]);
+			if (stageLatency / numReplica[l] > interval) {
+				interval = stageLatency / numReplica[l];
+				bottleneck = layers[l]->name.c_str();
+			}
+		}
+		printf(", H-tree=%.4e s\n", movementLatency);
+		double pipelineLatency = interval * layers.size();	// The stages hand over their images at the interval boundaries
+		double pipelineEnergy = synapticEnergy + movementEnergy + (leakage + replicaLeakage) * interval;
+		printf("\tPipelined inference: initiation interval=%.4e s (%s bound), %.4e inferences/s, latency=%.4e s/image, %.4f TOPS/W\n", interval, bottleneck, 1 / interval, pipelineLatency, ops / pipelineEnergy / 1e12);
+		printf("\tInter-stage buffers: %d bits, %.4e m^2\n", stageBufferBits, stageBufferBits * bufferAreaPerBit);
+	} else {
+		printf("\tInference: not simulated in hardware\n");
+	}
+
+	/* The backpropagation and the weight update move the deltas and the layer inputs again, as much as the forward pass */
+	if (numTrainImages > 0 && trainSynapticLatency > 0) {
+		double latency = trainSynapticLatency / numTrainImages + 2 * movementLatency;
+		double energy = trainSynapticEnergy / numTrainImages + 2 * movementEnergy + leakage * latency;
+		printf("\tTraining: latency=%.4e s/image, energy=%.4e J/image, %.4e images/s\n", latency, energy, 1 / latency);
+
+		/* Training pipeline without weight copies. The deltas of all the layers are known after the forward pass
+		 * (Train.cpp backpropagates with the old weights), so the layers update in parallel, but the forward pass
+		 * of the next image on a layer waits for the update of that layer. Run a few images to the steady state. */
+		int numLayers = layers.size();
+		int numImages = 2 * numLayers + 8;
+		std::vector<double> forward(numLayers), update(numLayers);
+		std::vector<double> endForward(numLayers, 0), endUpdate(numLayers, 0);
+		double stallFree = 0;	// Interval of a pipeline that never waits for the updates
+		for (int l=0; l<numLayers; l++) {
+			forward[l] = trainReadLatency[l] / numTrainImages + traffic[l].latency;
+			update[l] = trainWriteLatency[l] / numTrainImages + traffic[l].latency;
+			stallFree = std::max(stallFree, forward[l] + update[l]);
+		}
+		double start = 0, done = 0, lastDone = 0;
+		for (int n=0; n<numImages; n++) {
+			start = endUpdate[0];
+			for (int l=0; l<numLayers; l++) {
+				endForward[l] = std::max(l? endForward[l-1] : 0, endUpdate[l]) + forward[l];
+			}
+			lastDone = done;
+			for (int l=0; l<numLayers; l++) {
+				endUpdate[l] = std::max(endForward[numLayers-1], endUpdate[l]) + update[l];
+				done = std::max(done, endUpdate[l]);
+			}
+		}
+		double interval = done - lastDone;
+		printf("\tPipelined training: initiation interval=%.4e s, %.4e images/s, latency=%.4e s/image, weight-update stalls %.1f%% of the interval\n", interval, 1 / interval, done - start, (interval - stallFree) / interval * 100);
+	} else {
+		printf("\tTraining: not simulated in hardware\n");
+	}
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef CHIP_H_
+#define CHIP_H_
+
+#include <vector>
+#include "Param.h"
+#include "Layer.h"
+
+/* Chip-level model above the synaptic subarrays (param->chipReport). The subarray tiles of every
+ * layer are placed in chip tiles of param->subArraysPerChipTile subarrays (a chip tile holds one
+ * layer only), every chip tile has a local activation buffer and an H-tree connects the chip tiles
+ * to the global activation buffer at the center of the chip. The layer inputs go from the global
+ * buffer to the chip tiles and the partial sums of the tile columns come back, one transfer at a
+ * time over the param->htreeBusWidth bit bus. The buffers are DFF arrays and the H-tree wires use
+ * the array wires of the technology with one repeater per H-tree level.
+ * The report also models the layers as a pipeline: every layer is a stage working on its own image,
+ * the slowest stages are duplicated on the unused chip tiles and the activations between the stages
+ * are double buffered. In training the forward pass of a layer waits for the weight update of the
+ * previous image on the same layer, which stalls the pipeline. */
+class Chip {
+public:
+	Chip(const std::vector<Layer*>& layers);
+	~Chip();
+	void Initialize(const Param *param);	// After Simulator::Initialize
+	/* Synaptic cost of one inference, measured by Validate for every layer (see Test.cpp) */
+	void SetInferenceCost(int l, double energy, double latency);
+	/* Synaptic cost of the training images of every layer, measured around Train (see Simulator::Run) */
+	void BeginTraining();
+	void EndTraining(int numImages);
+	void PrintReport();
+
+	/* Layout */
+	int numChipTiles;			// # of chip tiles, including the unused ones
+	int numUsedChipTiles;		// # of chip tiles holding subarrays
+	int numTilesPerSide;		// Chip tiles on the side of the square floorplan
+	int numHTreeLevels;			// H-tree levels between the global buffer and a chip tile
+	double chipTileWidth;		// Side of a chip tile (m)
+	double chipWidth;			// Side of the chip (m)
+	/* Area breakdown (m^2) */
+	double areaSubArray, areaNeuron, areaLocalBuffer, areaGlobalBuffer, areaHTree, areaUnused, area;
+	double leakage;				// Standby leakage power of the chip (W)
+
+	/* Interconnect and buffers */
+	double hTreeLatency;		// Delay of one flit from the global buffer to a chip tile (s)
+	double hTreeEnergyPerBit;	// Energy of one bit from the global buffer to a chip tile (J)
+	double bufferEnergyPerFlit;	// Global and local buffer energy of one flit (J)
+	double flitLatency;			// Time between two flits on the H-tree (s)
+
+	/* Data movement of one inference of every layer */
+	struct LayerTraffic {
+		int firstChipTile, numChipTile;	// Chip tiles of the layer
+		double inputBits, outputBits;	// Inputs sent to the chip tiles, partial sums sent back
+		int numFlit;					// Flits of both directions
+		double energy, latency;			// Cost of the buffers and the H-tree
+	};
+	std::vector<LayerTraffic> traffic;
+
+	/* Measured synaptic cost */
+	std::vector<double> inferenceEnergy, inferenceLatency;	// Per inference of every layer (0: not measured)
+	int numTrainImages;
+	std::vector<double> trainEnergy, trainReadLatency, trainWriteLatency;	// Cumulative cost of the numTrainImages images of every layer
+
+	/* Inference pipeline */
+	std::vector<int> numReplica;	// Copies of the weights of every layer (the extra ones on the unused chip tiles)
+	int stageBufferBits;			// Double buffered activations between the stages
+
+private:
+	void BalancePipeline();		// numReplica
+	const std::vector<Layer*>& layers;
+	const Param *param;
+	DFF *globalBuffer, *localBuffer;
+	std::vector<double> startEnergy, startReadLatency, startWriteLatency;	// Layer cost at BeginTraining
+	Chip(const Chip&);	// Not copyable (owns the buffers)
+	Chip& operator=(const Chip&);
+};
+
+#endif
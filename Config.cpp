@@ -0,0 +1,296 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <map>
+#include <set>
+#include "Param.h"
+#include "Config.h"
+
+/* Param whose device parameter overrides are read by the device constructors of this thread (see SetDeviceParams) */
+static thread_local const Param *deviceParamSource = NULL;
+static thread_local std::set<std::string> deviceParamUsed;
+
+static std::string Trim(const std::string& str) {
+	size_t begin = str.find_first_not_of(" \t\r\n");
+	if (begin == std::string::npos)
+		return "";
+	size_t end = str.find_last_not_of(" \t\r\n");
+	return str.substr(begin, end - begin + 1);
+}
+
+static double ToNumber(const std::string& key, const std::string& value) {
+	if (value == "true")
+		return 1;
+	if (value == "false")
+		return 0;
+	char *end;
+	double number = strtod(value.c_str(), &end);
+	if (end == value.c_str() || *end != '\0') {
+		std::cout << "[Config] Error: invalid value \"" << value << "\" for " << key << std::endl;
+		exit(-1);
+	}
+	return number;
+}
+
+static Param::DeviceType ToDeviceType(const std::string& key, const std::string& value) {
+	if (value == "IdealDevice") return Param::IdealDeviceType;
+	if (value == "RealDevice") return Param::RealDeviceType;
+	if (value == "MeasuredDevice") return Param::MeasuredDeviceType;
+	if (value == "SRAM") return Param::SRAMType;
+	if (value == "DigitalNVM") return Param::DigitalNVMType;
+	std::cout << "[Config] Error: unknown device \"" << value << "\" for " << key << std::endl;
+	exit(-1);
+}
+
+static Param::RandomType ToRandomType(const std::string& key, const std::string& value) {
+	if (value == "Line") return Param::Line;
+	if (value == "Sporadic") return Param::Sporadic;
+	if (value == "Sequential") return Param::Sequential;
+	return (Param::RandomType)(int)ToNumber(key, value);
+}
+
+#define SET_INT(name)		if (key == #name) { param->name = (int)ToNumber(key, value); return; }
+#define SET_DOUBLE(name)	if (key == #name) { param->name = ToNumber(key, value); return; }
+#define SET_BOOL(name)		if (key == #name) { param->name = (ToNumber(key, value) != 0); return; }
+#define SET_STRING(name)	if (key == #name) { param->name = value; return; }
+
+static void SetParamValue(Param *param, const std::string& key, const std::string& value) {
+	if (key == "deviceTypeIH") { param->deviceTypeIH = ToDeviceType(key, value); return; }
+	if (key == "deviceTypeHO") { param->deviceTypeHO = ToDeviceType(key, value); return; }
+	if (key == "mode") { param->mode = ToRandomType(key, value); return; }
+	/* MNIST dataset */
+	SET_INT(numMnistTrainImages)
+	SET_INT(numMnistTestImages)
+	/* Algorithm parameters */
+	SET_INT(numTrainImagesPerEpoch)
+	SET_INT(totalNumEpochs)
+	SET_INT(interNumEpochs)
+	SET_INT(nInput)
+	SET_INT(nHide)
+	SET_INT(nOutput)
+	SET_STRING(hiddenLayers)
+	SET_DOUBLE(alpha1)
+	SET_DOUBLE(alpha2)
+	SET_DOUBLE(maxWeight)
+	SET_DOUBLE(minWeight)
+	/* Validation parameters */
+	SET_INT(numValidationSubset)
+	SET_INT(fullValidationInterval)
+	SET_INT(validationSubsetSeed)
+	SET_DOUBLE(validationConfidenceZ)
+	/* Early stop parameters */
+	SET_BOOL(earlyStop)
+	SET_INT(earlyStopMinEpochs)
+	SET_INT(earlyStopPatience)
+	SET_DOUBLE(earlyStopMinDelta)
+	SET_DOUBLE(earlyStopMaxRegression)
+	SET_BOOL(extrapolateEarlyStopCost)
+	/* Checkpoint parameters */
+	SET_STRING(checkpointFile)
+	SET_INT(checkpointInterval)
+	SET_STRING(resumeFile)
+	/* Profiler parameters */
+	SET_BOOL(profile)
+	SET_BOOL(profileHardwareCounters)
+	SET_STRING(profileTraceFile)
+	SET_INT(profileMaxTraceEvents)
+	/* Activity trace parameters */
+	SET_STRING(activityTraceFile)
+	SET_STRING(telemetryFile)
+	SET_INT(telemetryNumBins)
+	/* Hardware parameters */
+	SET_BOOL(useHardwareInTrainingFF)
+	SET_BOOL(useHardwareInTrainingWU)
+	SET_BOOL(useHardwareInTestingFF)
+	SET_INT(numBitInput)
+	SET_INT(numBitPartialSum)
+	SET_INT(numWeightBit)
+	SET_DOUBLE(BWthreshold)
+	SET_DOUBLE(Hthreshold)
+	SET_INT(numColMuxed)
+	SET_INT(numWriteColMuxed)
+	SET_BOOL(writeEnergyReport)
+	SET_BOOL(NeuroSimDynamicPerformance)
+	SET_BOOL(eventDrivenReadTiming)
+	SET_BOOL(enduranceReport)
+	SET_BOOL(costBreakdown)
+	SET_BOOL(relaxArrayCellHeight)
+	SET_BOOL(relaxArrayCellWidthIH)
+	SET_BOOL(relaxArrayCellWidthHO)
+	SET_INT(subArrayRows)
+	SET_INT(subArrayCols)
+	SET_DOUBLE(arrayWireWidth)
+	SET_INT(processNode)
+	SET_DOUBLE(clkFreq)
+	/* Chip parameters */
+	SET_BOOL(chipReport)
+	SET_INT(subArraysPerChipTile)
+	SET_INT(numChipTiles)
+	SET_INT(htreeBusWidth)
+	/* PCM refresh */
+	SET_INT(numImageperRESET)
+	SET_BOOL(PrintWeightdist)
+	SET_DOUBLE(ActDeviceIH)
+	SET_DOUBLE(ActDeviceHO)
+	SET_BOOL(RandomRefresh)
+	SET_INT(NumRefHiddenLayer)
+	SET_INT(NumRefOutputLayer)
+	std::cout << "[Config] Error: unknown parameter " << key << std::endl;
+	exit(-1);
+}
+
+#undef SET_INT
+#undef SET_DOUBLE
+#undef SET_BOOL
+#undef SET_STRING
+
+void SetConfigValue(Param *param, const std::string& section, const std::string& key, const std::string& value) {
+	if (section.empty() || section == "Param") {
+		SetParamValue(param, key, value);
+	} else if (section == "IdealDevice" || section == "RealDevice" || section == "MeasuredDevice" || section == "SRAM" || section == "DigitalNVM") {
+		std::string name = section + "." + key;
+		param->deviceParams[name] = ToNumber(name, value);
+	} else {
+		std::cout << "[Config] Error: unknown section [" << section << "]" << std::endl;
+		exit(-1);
+	}
+	param->UpdateDerivedParameters();
+}
+
+/* Load the key = value pairs of an INI-like config file */
+void LoadConfigFile(Param *param, const char *fileName) {
+	std::ifstream file(fileName);
+	if (!file) {
+		std::cout << fileName << " cannot be found!\n";
+		exit(-1);
+	}
+	std::string line, section;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		size_t comment = line.find_first_of("#;");
+		if (comment != std::string::npos)
+			line.erase(comment);
+		line = Trim(line);
+		if (line.empty())
+			continue;
+		if (line[0] == '[') {
+			if (line[line.size()-1] != ']') {
+				printf("[Config] Error: %s:%d: unterminated section\n", fileName, lineNumber);
+				exit(-1);
+			}
+			section = Trim(line.substr(1, line.size() - 2));
+			continue;
+		}
+		size_t eq = line.find('=');
+		if (eq == std::string::npos) {
+			printf("[Config] Error: %s:%d: expected key = value\n", fileName, lineNumber);
+			exit(-1);
+		}
+		SetConfigValue(param, section, Trim(line.substr(0, eq)), Trim(line.substr(eq + 1)));
+	}
+}
+
+/* An argument of the form [Section.]key=value is an override, otherwise it is a config file */
+void ApplyArgument(Param *param, const std::string& arg) {
+	size_t eq = arg.find('=');
+	if (eq == std::string::npos) {
+		LoadConfigFile(param, arg.c_str());
+		return;
+	}
+	std::string key = Trim(arg.substr(0, eq));
+	std::string section;
+	size_t dot = key.find('.');
+	if (dot != std::string::npos) {
+		section = key.substr(0, dot);
+		key = key.substr(dot + 1);
+	}
+	SetConfigValue(param, section, key, Trim(arg.substr(eq + 1)));
+}
+
+/* Apply the config files and overrides on the command line (--options are skipped) */
+void ParseCommandLine(Param *param, int argc, char *argv[]) {
+	for (int i=1; i<argc; i++) {
+		if (strncmp(argv[i], "--", 2) == 0)
+			continue;
+		ApplyArgument(param, argv[i]);
+	}
+}
+
+/* Value of a --name=value option, or NULL if not given */
+const char *GetCommandLineOption(int argc, char *argv[], const char *name) {
+	size_t length = strlen(name);
+	for (int i=1; i<argc; i++) {
+		if (strncmp(argv[i], "--", 2) == 0 && strncmp(argv[i] + 2, name, length) == 0 && argv[i][2 + length] == '=')
+			return argv[i] + 3 + length;
+	}
+	return NULL;
+}
+
+void SetDeviceParams(const Param *param) {
+	deviceParamSource = param;
+	deviceParamUsed.clear();
+}
+
+double DeviceParam(const char *device, const char *name, double defaultValue) {
+	if (!deviceParamSource || deviceParamSource->deviceParams.empty())
+		return defaultValue;
+	std::string key = std::string(device) + "." + name;
+	std::map<std::string, double>::const_iterator it = deviceParamSource->deviceParams.find(key);
+	if (it == deviceParamSource->deviceParams.end())
+		return defaultValue;
+	deviceParamUsed.insert(key);
+	return it->second;
+}
+
+/* Warn about device parameters that no device has read (most likely a typo) */
+void CheckUnusedDeviceParams() {
+	if (!deviceParamSource)
+		return;
+	for (std::map<std::string, double>::const_iterator it = deviceParamSource->deviceParams.begin(); it != deviceParamSource->deviceParams.end(); it++) {
+		if (!deviceParamUsed.count(it->first))
+			std::cout << "[Config] Warning: device parameter " << it->first << " is not used" << std::endl;
+	}
+	SetDeviceParams(NULL);
+}
@@ -36,12 +36,35 @@
 *   Xiaochen Peng   Email: xpeng15 at asu dot edu
 ********************************************************************************/
 
-#ifndef MAPPING_H_
-#define MAPPING_H_
+#ifndef CONFIG_H_
+#define CONFIG_H_
 
-void WeightInitialize();
-void WeightToConductance();
-int CurrentToDigits(double I, double Imax);
-double DigitsToAlgorithm(int outputDigits, double pSumMaxAlgorithm);
+#include <string>
+
+class Param;
+
+/* Runtime configuration
+ * Config files use a simple INI format:
+ *   # comment
+ *   [Param]            keys are Param members, e.g. numColMuxed = 8
+ *   [RealDevice]       keys are device members, e.g. NL_LTD = 3
+ * Command line arguments of the form key=value (or Section.key=value for
+ * device parameters) override the config files, other arguments are read
+ * as config files in the given order. Arguments of the form --name=value are
+ * options of the driver itself (see GetCommandLineOption). */
+void LoadConfigFile(Param *param, const char *fileName);
+void SetConfigValue(Param *param, const std::string& section, const std::string& key, const std::string& value);
+void ApplyArgument(Param *param, const std::string& arg);
+void ParseCommandLine(Param *param, int argc, char *argv[]);
+const char *GetCommandLineOption(int argc, char *argv[], const char *name);
+
+/* The device constructors have no access to the Param of their simulator, so the
+ * overrides of param->deviceParams are made visible to the calling thread while
+ * its arrays are initialized: SetDeviceParams(param), Array::Initialization, then
+ * CheckUnusedDeviceParams() to warn about unused overrides and reset the source. */
+void SetDeviceParams(const Param *param);
+/* Device parameter override, or defaultValue if the parameter is not configured */
+double DeviceParam(const char *device, const char *name, double defaultValue);
+void CheckUnusedDeviceParams();
 
 #endif
@@ -0,0 +1,211 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cstdio>
+#include "NeuroSim.h"
+#include "Layer.h"
+#include "CostBreakdown.h"
+
+const char *costComponentName[NUM_COST_COMPONENTS] = {
+	"array selected lines", "array unselected lines", "array cells", "array half-selected", "array refresh",
+	"wlDecoder", "wlDecoderOutput", "wlDecoderDriver", "wlSwitchMatrix", "blSwitchMatrix", "slSwitchMatrix",
+	"colDecoder", "colDecoderDriver", "mux", "muxDecoder", "precharger", "sramWriteDriver",
+	"senseAmp", "voltageSenseAmp", "readCircuit", "adder", "dff", "shiftAdd",
+	"neuron adder", "neuron mux", "neuron muxDecoder", "neuron dff", "tile adder"
+};
+
+/* Modules of a synaptic core that take part in one NeuroSim cost function */
+struct ModuleList {
+	int size;
+	const FunctionUnit *module[8];
+	int component[8];
+	ModuleList(): size(0) {}
+	void Add(const FunctionUnit& unit, int c) { module[size] = &unit; component[size++] = c; }
+};
+
+/* The modules summed by NeuroSimSubArrayReadEnergy for the cell type of the core, which also
+ * cover the modules of NeuroSimSubArrayReadLatency */
+static ModuleList ReadModules(const SubArray *subArray) {
+	ModuleList list;
+	if (subArray->cell.memCellType == Type::SRAM) {
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		list.Add(subArray->precharger, COST_PRECHARGER);
+		list.Add(subArray->senseAmp, COST_SENSE_AMP);
+		list.Add(subArray->adder, COST_ADDER);
+		list.Add(subArray->dff, COST_DFF);
+	} else if (subArray->digitalModeNeuro) {	// Digital eNVM
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		if (subArray->cell.accessType != CMOS_access) {	// Cross-point
+			list.Add(subArray->wlDecoderDriver, COST_WL_DECODER_DRIVER);
+		}
+		list.Add(subArray->mux, COST_MUX);
+		list.Add(subArray->muxDecoder, COST_MUX_DECODER);
+		list.Add(subArray->voltageSenseAmp, COST_VOLTAGE_SENSE_AMP);
+		list.Add(subArray->adder, COST_ADDER);
+		list.Add(subArray->dff, COST_DFF);
+	} else {	// Analog eNVM
+		if (subArray->cell.accessType == CMOS_access) {	// 1T1R
+			list.Add(subArray->wlDecoder, COST_WL_DECODER);
+			list.Add(subArray->wlDecoderOutput, COST_WL_DECODER_OUTPUT);
+			list.Add(subArray->blSwitchMatrix, COST_BL_SWITCH_MATRIX);
+		} else {	// Cross-point
+			list.Add(subArray->wlSwitchMatrix, COST_WL_SWITCH_MATRIX);
+		}
+		list.Add(subArray->mux, COST_MUX);
+		list.Add(subArray->muxDecoder, COST_MUX_DECODER);
+		list.Add(subArray->readCircuit, COST_READ_CIRCUIT);
+	}
+	list.Add(subArray->shiftAdd, COST_SHIFT_ADD);
+	return list;
+}
+
+/* The modules summed by NeuroSimSubArrayWriteEnergy for the cell type of the core */
+static ModuleList WriteEnergyModules(const SubArray *subArray) {
+	ModuleList list;
+	if (subArray->cell.memCellType == Type::SRAM) {
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		list.Add(subArray->precharger, COST_PRECHARGER);
+		list.Add(subArray->sramWriteDriver, COST_SRAM_WRITE_DRIVER);
+	} else if (subArray->digitalModeNeuro) {	// Digital eNVM
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		if (subArray->cell.accessType != CMOS_access) {	// Cross-point
+			list.Add(subArray->wlDecoderDriver, COST_WL_DECODER_DRIVER);
+		}
+		list.Add(subArray->colDecoder, COST_COL_DECODER);
+		list.Add(subArray->colDecoderDriver, COST_COL_DECODER_DRIVER);
+	} else if (subArray->cell.accessType == CMOS_access) {	// Analog 1T1R
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		list.Add(subArray->wlDecoderOutput, COST_WL_DECODER_OUTPUT);
+		list.Add(subArray->blSwitchMatrix, COST_BL_SWITCH_MATRIX);
+		list.Add(subArray->slSwitchMatrix, COST_SL_SWITCH_MATRIX);
+	} else {	// Analog cross-point
+		list.Add(subArray->wlSwitchMatrix, COST_WL_SWITCH_MATRIX);
+		list.Add(subArray->blSwitchMatrix, COST_BL_SWITCH_MATRIX);
+	}
+	return list;
+}
+
+void CostBreakdown::AddSubArrayRead(const SubArray *subArray, bool timed, double scale) {
+	if (!subArray->dynamicPerformance)
+		return;
+	ModuleList list = ReadModules(subArray);
+	for (int i=0; i<list.size; i++) {
+		readEnergy[list.component[i]] += list.module[i]->readDynamicEnergy * scale;
+		if (timed)
+			readLatency[list.component[i]] += list.module[i]->readLatency;
+	}
+}
+
+void CostBreakdown::AddNeuronRead(const Layer *layer, bool timed, double scale) {
+	if (!layer->subArray->dynamicPerformance)
+		return;
+	const FunctionUnit *module[] = {&layer->adder, &layer->mux, &layer->muxDecoder, &layer->dff, &layer->tileAdder};
+	for (int i=0; i<5; i++) {
+		if (i == 4 && !layer->tileAdder.initialized)
+			break;
+		readEnergy[COST_NEURON_ADDER + i] += module[i]->readDynamicEnergy * scale;
+		if (timed && i != 2)	// The mux decoder is not on the path of NeuroSimNeuronReadLatency
+			readLatency[COST_NEURON_ADDER + i] += module[i]->readLatency;
+	}
+}
+
+void CostBreakdown::AddSubArrayWriteEnergy(const SubArray *subArray) {
+	if (!subArray->dynamicPerformance)
+		return;
+	ModuleList list = WriteEnergyModules(subArray);
+	for (int i=0; i<list.size; i++) {
+		writeEnergy[list.component[i]] += list.module[i]->writeDynamicEnergy;
+	}
+}
+
+void CostBreakdown::AddSubArrayWriteLatency(const SubArray *subArray, double latency, int cellComponent) {
+	if (!subArray->dynamicPerformance)
+		return;
+	/* The peripheries on the path of NeuroSimSubArrayWriteLatency, which also sets the switch matrix of
+	 * analog eNVM to the device latency */
+	ModuleList list;
+	if (subArray->cell.memCellType == Type::SRAM) {
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		list.Add(subArray->precharger, COST_PRECHARGER);
+		list.Add(subArray->sramWriteDriver, COST_SRAM_WRITE_DRIVER);
+	} else if (subArray->digitalModeNeuro) {	// Digital eNVM
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		if (subArray->cell.accessType != CMOS_access) {	// Cross-point
+			list.Add(subArray->wlDecoderDriver, COST_WL_DECODER_DRIVER);
+		}
+		list.Add(subArray->colDecoder, COST_COL_DECODER);
+		list.Add(subArray->colDecoderDriver, COST_COL_DECODER_DRIVER);
+	} else if (subArray->cell.accessType == CMOS_access) {	// Analog 1T1R
+		list.Add(subArray->wlDecoder, COST_WL_DECODER);
+		list.Add(subArray->wlDecoderOutput, COST_WL_DECODER_OUTPUT);
+	}
+	for (int i=0; i<list.size; i++) {
+		writeLatency[list.component[i]] += list.module[i]->writeLatency;
+		latency -= list.module[i]->writeLatency;
+	}
+	if (!subArray->digitalModeNeuro || subArray->cell.memCellType == Type::SRAM) {	// Digital eNVM overlaps the row and column paths
+		writeLatency[cellComponent] += latency;
+	}
+}
+
+void CostBreakdown::Add(const CostBreakdown& other, double scale) {
+	for (int c=0; c<NUM_COST_COMPONENTS; c++) {
+		readEnergy[c] += other.readEnergy[c] * scale;
+		writeEnergy[c] += other.writeEnergy[c] * scale;
+		readLatency[c] += other.readLatency[c] * scale;
+		writeLatency[c] += other.writeLatency[c] * scale;
+	}
+}
+
+void CostBreakdown::Print(const char *name, double totalReadLatency, double totalWriteLatency) const {
+	double totalReadEnergy = 0, totalWriteEnergy = 0;
+	for (int c=0; c<NUM_COST_COMPONENTS; c++) {
+		totalReadEnergy += readEnergy[c];
+		totalWriteEnergy += writeEnergy[c];
+	}
+	double totalEnergy = totalReadEnergy + totalWriteEnergy;
+	printf("Cost breakdown of %s:\n", name);
+	printf("\t%-24s %12s %12s %7s %12s %12s\n", "component", "read (J)", "write (J)", "energy", "read (s)", "write (s)");
+	for (int c=0; c<NUM_COST_COMPONENTS; c++) {
+		if (readEnergy[c] == 0 && writeEnergy[c] == 0 && readLatency[c] == 0 && writeLatency[c] == 0)
+			continue;
+		printf("\t%-24s %12.4e %12.4e %6.2f%% %12.4e %12.4e\n", costComponentName[c], readEnergy[c], writeEnergy[c],
+				totalEnergy > 0? (readEnergy[c] + writeEnergy[c]) / totalEnergy * 100 : 0, readLatency[c], writeLatency[c]);
+	}
+	printf("\t%-24s %12.4e %12.4e %7s %12.4e %12.4e\n", "total", totalReadEnergy, totalWriteEnergy, "", totalReadLatency, totalWriteLatency);
+}
@@ -0,0 +1,113 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef COSTBREAKDOWN_H_
+#define COSTBREAKDOWN_H_
+
+#include "NeuroSim.h"
+
+class Layer;
+
+/* Components of the cost breakdown of a layer */
+enum CostComponent {
+	/* Cell level cost of the synaptic array (Array and Cell), the first NUM_ARRAY_COSTS components */
+	COST_SELECTED_LINES,		// Charging the selected word, bit and source lines
+	COST_UNSELECTED_LINES,		// Charging the unselected lines
+	COST_CELLS,					// Selected cells: read current, device write energy and device write latency
+	COST_HALF_SELECTED_CELLS,	// Current through the half-selected cells of cross-point arrays during writes
+	COST_REFRESH,				// PCM refresh: read, erase and rewrite of the array
+	/* NeuroSim synaptic core */
+	COST_WL_DECODER,
+	COST_WL_DECODER_OUTPUT,
+	COST_WL_DECODER_DRIVER,
+	COST_WL_SWITCH_MATRIX,
+	COST_BL_SWITCH_MATRIX,
+	COST_SL_SWITCH_MATRIX,
+	COST_COL_DECODER,
+	COST_COL_DECODER_DRIVER,
+	COST_MUX,
+	COST_MUX_DECODER,
+	COST_PRECHARGER,
+	COST_SRAM_WRITE_DRIVER,
+	COST_SENSE_AMP,
+	COST_VOLTAGE_SENSE_AMP,
+	COST_READ_CIRCUIT,
+	COST_ADDER,
+	COST_DFF,
+	COST_SHIFT_ADD,
+	/* Neuron peripheries below the core */
+	COST_NEURON_ADDER,
+	COST_NEURON_MUX,
+	COST_NEURON_MUX_DECODER,
+	COST_NEURON_DFF,
+	COST_TILE_ADDER,
+	NUM_COST_COMPONENTS
+};
+const int NUM_ARRAY_COSTS = COST_REFRESH + 1;
+extern const char *costComponentName[NUM_COST_COMPONENTS];
+
+/* Cumulative energy and latency of every component of a layer. The energies add up to the
+ * array and NeuroSim totals; the latencies are the busy time of every module, which do not
+ * add up since the NeuroSim latency overlaps some of the modules (see NeuroSim.cpp).
+ * The array components are accumulated per thread by the OpenMP loops (reductions on the
+ * first NUM_ARRAY_COSTS entries), the modules inside the critical sections around the NeuroSim calls. */
+struct CostBreakdown {
+	double readEnergy[NUM_COST_COMPONENTS], writeEnergy[NUM_COST_COMPONENTS];
+	double readLatency[NUM_COST_COMPONENTS], writeLatency[NUM_COST_COMPONENTS];
+
+	/* The modules of the last NeuroSim read (energy times scale and, if timed, latency) and write calls */
+	void AddSubArrayRead(const SubArray *subArray, bool timed, double scale);
+	void AddNeuronRead(const Layer *layer, bool timed, double scale);
+	void AddSubArrayWriteEnergy(const SubArray *subArray);
+	/* latency is the result of NeuroSimSubArrayWriteLatency; the part outside the peripheries (the device
+	 * write pulses of analog eNVM, the cell flip of SRAM) goes to cellComponent */
+	void AddSubArrayWriteLatency(const SubArray *subArray, double latency, int cellComponent);
+	void Add(const CostBreakdown& other, double scale);
+	void Print(const char *name, double totalReadLatency, double totalWriteLatency) const;
+};
+
+/* Sum of the array components */
+inline double ArrayCost(const double *cost) {
+	double sum = 0;
+	for (int c=0; c<NUM_ARRAY_COSTS; c++) {
+		sum += cost[c];
+	}
+	return sum;
+}
+
+#endif
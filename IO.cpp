@@ -41,22 +41,28 @@
 #include <cmath>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include "formula.h"
 #include "Param.h"
+#include "IO.h"
+#include "Simulator.h"
 
-extern Param *param;
-extern std::vector< std::vector<double> > Input;
-extern std::vector< std::vector<int> > dInput;
-extern std::vector< std::vector<double> > testInput;
-extern std::vector< std::vector<int> > dTestInput;
-extern std::vector< std::vector<double> > Output;
-extern std::vector< std::vector<double> > testOutput;
+Dataset::Dataset(const Param& param):
+						Input(param.numMnistTrainImages, std::vector<double>(param.nInput)),
+						Output(param.numMnistTrainImages, std::vector<double>(param.nOutput)),
+						testInput(param.numMnistTestImages, std::vector<double>(param.nInput)),
+						testOutput(param.numMnistTestImages, std::vector<double>(param.nOutput)),
+						dInput(param.numMnistTrainImages, std::vector<int>(param.nInput)),
+						dTestInput(param.numMnistTestImages, std::vector<int>(param.nInput)) {
+	this->param = new Param(param);
+}
 
-extern std::vector< std::vector<double> > weight1;
-extern std::vector< std::vector<double> > weight2;
+Dataset::~Dataset() {
+	delete param;
+}
 
 /* Read trainging data from file */
-void ReadTrainingDataFromFile(const char *trainPatchFileName, const char *trainLabelFileName) {
+void Dataset::ReadTrainingDataFromFile(const char *trainPatchFileName, const char *trainLabelFileName) {
 	FILE *fp_patch = fopen(trainPatchFileName, "r");
 	FILE *fp_label = fopen(trainLabelFileName, "r");
 
@@ -93,7 +99,7 @@ void ReadTrainingDataFromFile(const char *trainPatchFileName, const char *trainL
 }
 
 /* Read testing data from file */
-void ReadTestingDataFromFile(const char *testPatchFileName, const char *testLabelFileName) {
+void Dataset::ReadTestingDataFromFile(const char *testPatchFileName, const char *testLabelFileName) {
 	FILE *fp_patch = fopen(testPatchFileName, "r");
 	FILE *fp_label = fopen(testLabelFileName, "r");
 
@@ -129,31 +135,89 @@ void ReadTestingDataFromFile(const char *testPatchFileName, const char *testLabe
 	fclose(fp_label);
 }
 
-/* Print weight to file */
-void PrintWeightToFile(const char *str) {
-	/* Print weight1 */
-	char printWeight1FileName[50];
-	sprintf(printWeight1FileName, "%s1.csv", str);
-	FILE *fp_dw1 = fopen(printWeight1FileName, "w");
-	fprintf(fp_dw1, "minWeight=%f, maxWeight=%f\n", param->minWeight, param->maxWeight);
-	for (int j = 0; j < param->nHide; j++){
-		for (int k = 0; k < param->nInput; k++){
-			fprintf(fp_dw1, "%f,", weight1[j][k]);
+/* Print the weights of every layer to <str><layer>.csv (1 is the layer next to the input) */
+void Simulator::PrintWeightToFile(const char *str) {
+	for (int l = 0; l < layers.size(); l++) {
+		char printWeightFileName[256];
+		snprintf(printWeightFileName, sizeof(printWeightFileName), "%s%d.csv", str, l + 1);
+		FILE *fp_dw = fopen(printWeightFileName, "w");
+		fprintf(fp_dw, "minWeight=%f, maxWeight=%f\n", param->minWeight, param->maxWeight);
+		for (int j = 0; j < layers[l]->numOutput; j++){
+			for (int k = 0; k < layers[l]->numInput; k++){
+				fprintf(fp_dw, "%f,", layers[l]->weight[j][k]);
+			}
+			fprintf(fp_dw, "\n");
+		}
+		fclose(fp_dw);
+	}
+}
+
+/* Fill the set with random images of the same sparsity as MNIST (about 20% of the pixels are on) */
+static void GenerateImages(std::vector< std::vector<double> >& input, std::vector< std::vector<int> >& dInput,
+						const Param *param, RandomGenerator& rng) {
+	for (int i=0; i<input.size(); i++) {
+		for (int j=0; j<input[i].size(); j++) {
+			double pixel = (rng.Rand() % 5 == 0)? (double)(rng.Rand() % 256) / 255 : 0;
+			input[i][j] = truncate(pixel, param->numInputLevel - 1, param->BWthreshold);
+			dInput[i][j] = round(input[i][j] * (param->numInputLevel - 1));
 		}
-		fprintf(fp_dw1, "\n");
 	}
-	fclose(fp_dw1);
-	/* Print weight2 */
-	char printWeight2FileName[50];
-	sprintf(printWeight2FileName, "%s2.csv", str);
-	FILE *fp_dw2 = fopen(printWeight2FileName, "w");
-	fprintf(fp_dw2, "minWeight=%f, maxWeight=%f\n", param->minWeight, param->maxWeight);
-	for (int j = 0; j < param->nOutput; j++){
-		for (int k = 0; k < param->nHide; k++){
-			fprintf(fp_dw2, "%f,", weight2[j][k]);
+}
+
+/* Response of every class of the linear teacher to every image */
+static void TeacherResponse(const std::vector< std::vector<double> >& input, const std::vector< std::vector<double> >& teacher,
+						std::vector< std::vector<double> > *response) {
+	response->assign(input.size(), std::vector<double>(teacher.size(), 0));
+	for (int i=0; i<input.size(); i++) {
+		for (int c=0; c<teacher.size(); c++) {
+			for (int j=0; j<input[i].size(); j++) {
+				(*response)[i][c] += teacher[c][j] * input[i][j];
+			}
 		}
-		fprintf(fp_dw2, "\n");
 	}
-	fclose(fp_dw2);
 }
 
+/* One-hot label of the class with the largest standardized teacher response */
+static void TeacherLabel(const std::vector< std::vector<double> >& response, const std::vector<double>& mean,
+						const std::vector<double>& sigma, std::vector< std::vector<double> >& output) {
+	for (int i=0; i<output.size(); i++) {
+		int label = 0;
+		for (int c=1; c<output[i].size(); c++) {
+			if ((response[i][c] - mean[c]) / sigma[c] > (response[i][label] - mean[label]) / sigma[label])
+				label = c;
+		}
+		std::fill(output[i].begin(), output[i].end(), 0);
+		output[i][label] = 1;
+	}
+}
+
+/* Random images labeled by a fixed random linear teacher on their (digitized) pixels, so that the task can be
+ * learned and the training produces realistic weight updates. The teacher responses are standardized over the
+ * training set, which makes the classes about equally frequent. */
+void Dataset::GenerateSyntheticData(unsigned int seed) {
+	RandomGenerator rng(seed);
+	std::vector< std::vector<double> > teacher(param->nOutput, std::vector<double>(param->nInput));
+	for (int c=0; c<teacher.size(); c++) {
+		for (int j=0; j<teacher[c].size(); j++) {
+			teacher[c][j] = (j % param->nOutput == c) + 0.2 * ((double)(rng.Rand() % 2001) / 1000 - 1);
+		}
+	}
+	GenerateImages(Input, dInput, param, rng);
+	GenerateImages(testInput, dTestInput, param, rng);
+
+	std::vector< std::vector<double> > response, testResponse;
+	TeacherResponse(Input, teacher, &response);
+	TeacherResponse(testInput, teacher, &testResponse);
+	std::vector<double> mean(param->nOutput, 0), sigma(param->nOutput, 0);
+	for (int c=0; c<param->nOutput; c++) {
+		for (int i=0; i<response.size(); i++) {
+			mean[c] += response[i][c] / response.size();
+		}
+		for (int i=0; i<response.size(); i++) {
+			sigma[c] += (response[i][c] - mean[c]) * (response[i][c] - mean[c]) / response.size();
+		}
+		sigma[c] = sigma[c] > 0? sqrt(sigma[c]) : 1;
+	}
+	TeacherLabel(response, mean, sigma, Output);
+	TeacherLabel(testResponse, mean, sigma, testOutput);
+}
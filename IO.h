@@ -39,8 +39,29 @@
 #ifndef IO_H_
 #define IO_H_
 
-void ReadTrainingDataFromFile(const char *trainPatchFileName, const char *trainLabelFileName);
-void ReadTestingDataFromFile(const char *testPatchFileName, const char *testLabelFileName);
-void PrintWeightToFile(const char *str);
+#include <vector>
+#include "Param.h"
+
+/* MNIST training and testing sets (read-only once loaded, so several simulators can share one Dataset) */
+class Dataset {
+public:
+	Dataset(const Param& param);
+	~Dataset();
+	void ReadTrainingDataFromFile(const char *trainPatchFileName, const char *trainLabelFileName);
+	void ReadTestingDataFromFile(const char *testPatchFileName, const char *testLabelFileName);
+	void GenerateSyntheticData(unsigned int seed);	// Random MNIST-like images with learnable labels instead of the files (for benchmarks)
+
+	Param *param;	// Parameters the dataset was loaded with (# of images, nInput, nOutput, numBitInput, BWthreshold)
+	std::vector< std::vector<double> > Input;	// Inputs of training set
+	std::vector< std::vector<double> > Output;	// Outputs of training set
+	std::vector< std::vector<double> > testInput;	// Inputs of testing set
+	std::vector< std::vector<double> > testOutput;	// Outputs of testing set
+	std::vector< std::vector<int> > dInput;	// Digitized inputs of training set (an integer between 0 to 2^numBitInput-1)
+	std::vector< std::vector<int> > dTestInput;	// Digitized inputs of testing set (an integer between 0 to 2^numBitInput-1)
+
+private:
+	Dataset(const Dataset&);	// Not copyable (owns param)
+	Dataset& operator=(const Dataset&);
+};
 
 #endif
@@ -0,0 +1,222 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <string>
+#include <random>
+#include <vector>
+#include "Cell.h"
+#include "Array.h"
+#include "NeuroSim.h"
+#include "Param.h"
+#include "Layer.h"
+
+Layer::Layer(int index, int numInput, int numOutput, bool output, const Param& param, std::mt19937 *gen):
+						index(index), numInput(numInput), numOutput(numOutput), output(output),
+						readTiming(), numTimedReads(0), cost(),
+						weight(numOutput, std::vector<double>(numInput)),
+						deltaWeight(numOutput, std::vector<double>(numInput)),
+						inputParameter(), cell(),	// Plain structs, the cell fields a device type does not use are read as 0
+						adder(inputParameter, tech, cell),
+						mux(inputParameter, tech, cell),
+						muxDecoder(inputParameter, tech, cell),
+						dff(inputParameter, tech, cell),
+						tileAdder(inputParameter, tech, cell) {
+	if (output) {
+		name = "HO";
+		deviceType = param.deviceTypeHO;
+		relaxArrayCellWidth = param.relaxArrayCellWidthHO;
+		alpha = param.alpha2;
+		actDevice = param.ActDeviceHO;
+		numRefresh = param.NumRefOutputLayer;
+	} else {
+		name = (index == 0)? "IH" : "HH" + std::to_string(index);
+		deviceType = param.deviceTypeIH;
+		relaxArrayCellWidth = param.relaxArrayCellWidthIH;
+		alpha = param.alpha1;
+		actDevice = param.ActDeviceIH;
+		numRefresh = param.NumRefHiddenLayer;
+	}
+	tileRows = (param.subArrayRows > 0)? std::min(param.subArrayRows, numInput) : numInput;
+	tileCols = (param.subArrayCols > 0)? std::min(param.subArrayCols, numOutput) : numOutput;
+	numTileRow = (numInput + tileRows - 1) / tileRows;
+	numTileCol = (numOutput + tileCols - 1) / tileCols;
+	eventDrivenReadTiming = param.eventDrivenReadTiming;
+	array = new Array(numOutput, numInput, param.arrayWireWidth, gen);
+	array->tileColSize = tileCols;
+	array->tileRowSize = tileRows;
+	subArray = NULL;
+}
+
+Layer::~Layer() {
+	delete subArray;
+	delete array;
+}
+
+/* Initialize the synaptic array with the device of the layer */
+void Layer::InitializeArray(const Param *param) {
+	switch (deviceType) {
+		case Param::IdealDeviceType:	array->Initialization<IdealDevice>(); break;
+		case Param::RealDeviceType:		array->Initialization<RealDevice>(); break;
+		case Param::MeasuredDeviceType:	array->Initialization<MeasuredDevice>(); break;
+		case Param::SRAMType:			array->Initialization<SRAM>(param->numWeightBit); break;
+		case Param::DigitalNVMType:		array->Initialization<DigitalNVM>(param->numWeightBit); break;
+		default:	puts("Unknown device type"); exit(-1);
+	}
+	if (param->enduranceReport && deviceType != Param::SRAMType) {
+		array->EnableEnduranceCounters();
+	}
+	array->PackWeights();
+}
+
+/* The partial sums of the numTileRow tiles of a tile column are added one after the other, which needs
+ * ceil(log2(numTileRow)) more bits than the neuron adder */
+void Layer::InitializeTileAdder() {
+	if (numTileRow > 1) {
+		tileAdder.Initialize(adder.numBit + (int)ceil(log2(numTileRow)), adder.numAdder);
+	}
+}
+
+/* Neuron peripheries and tile accumulation below every tile column */
+double Layer::NeuronArea() {
+	double height, width;
+	NeuroSimNeuronArea(subArray, adder, mux, muxDecoder, dff, &height, &width);
+	double area = adder.area + mux.area + muxDecoder.area + dff.area;
+	if (tileAdder.initialized) {
+		tileAdder.CalculateArea(NULL, subArray->widthArray, NONE);
+		area += tileAdder.area;
+	}
+	return area * numTileCol;
+}
+
+double Layer::NeuronLeakagePower() {
+	double leakage = NeuroSimNeuronLeakagePower(subArray, adder, mux, muxDecoder, dff);
+	if (tileAdder.initialized) {
+		tileAdder.CalculatePower(numTileRow - 1, tileAdder.numAdder);
+		leakage += tileAdder.leakage;
+	}
+	return leakage * numTileCol;
+}
+
+void Layer::ReadCost(double activityRowRead, bool timed, double *energy, double *latency, CostBreakdown *cost) {
+	subArray->activityRowRead = activityRowRead;
+	*energy += NeuroSimSubArrayReadEnergy(subArray) * numTileCol;
+	if (!timed) {
+		if (cost)
+			cost->AddSubArrayRead(subArray, false, numTileCol);
+		return;
+	}
+	double neuronEnergy = NeuroSimNeuronReadEnergy(subArray, adder, mux, muxDecoder, dff);
+	if (tileAdder.initialized && subArray->dynamicPerformance) {
+		tileAdder.CalculatePower(numTileRow - 1, tileAdder.numAdder);
+		neuronEnergy += tileAdder.readDynamicEnergy;
+	}
+	*energy += neuronEnergy * numTileCol;
+	if (eventDrivenReadTiming) {
+		ReadTiming timing;
+		*latency += NeuroSimSubArrayReadTiming(subArray, &timing);
+		readTiming.latency += timing.latency;
+		readTiming.interval += timing.interval;
+		for (int s=0; s<NUM_READ_STAGES; s++) {
+			readTiming.busy[s] += timing.busy[s];
+		}
+		numTimedReads++;
+	} else {
+		*latency += NeuroSimSubArrayReadLatency(subArray);
+	}
+	*latency += NeuroSimNeuronReadLatency(subArray, adder, mux, muxDecoder, dff);
+	if (tileAdder.initialized && subArray->dynamicPerformance) {
+		tileAdder.CalculateLatency(1e20, dff.capTgDrain, numTileRow - 1);
+		*latency += tileAdder.readLatency;
+	}
+	if (cost) {
+		cost->AddSubArrayRead(subArray, true, numTileCol);
+		cost->AddNeuronRead(this, true, numTileCol);
+	}
+}
+
+void Layer::PrintReadTiming() const {
+	if (numTimedReads == 0 || readTiming.interval == 0)
+		return;
+	const double *busy = readTiming.busy;
+	printf("Read pipeline of subArray%s: latency=%.4e s, interval=%.4e s (%.4e weighted sums/s), utilization: decode %.1f%%, columns %.1f%%, conversion %.1f%%, accumulation %.1f%%, shift-add %.1f%%\n",
+			name.c_str(), readTiming.latency / numTimedReads, readTiming.interval / numTimedReads, numTimedReads / readTiming.interval,
+			busy[READ_DECODE] / readTiming.interval * 100, busy[READ_COLUMN] / readTiming.interval * 100, busy[READ_CONVERT] / readTiming.interval * 100,
+			busy[READ_ACCUMULATE] / readTiming.interval * 100, busy[READ_SHIFT_ADD] / readTiming.interval * 100);
+}
+
+/* The pulses of the cells against their distribution and the rows and columns of cells that take the most */
+void Layer::PrintEndurance() const {
+	if (!array->numSetPulse)
+		return;
+	int numCol = numOutput * array->numCellPerSynapse;
+	std::vector<uint32_t> numPulse(numInput * numCol);	// SET + RESET of every cell
+	std::vector<double> rowPulse(numInput, 0), colPulse(numCol, 0);
+	uint32_t maxSet = 0, maxReset = 0;
+	int64_t numSaturated = 0;
+	double sumPulse = 0;
+	for (int y=0; y<numInput; y++) {
+		for (int x=0; x<numCol; x++) {
+			uint32_t numSet = array->numSetPulse[y][x], numReset = array->numResetPulse[y][x];
+			numSaturated += (numSet == UINT32_MAX) + (numReset == UINT32_MAX);
+			maxSet = std::max(maxSet, numSet);
+			maxReset = std::max(maxReset, numReset);
+			double pulses = (double)numSet + numReset;
+			numPulse[y * numCol + x] = (uint32_t)std::min(pulses, (double)UINT32_MAX);
+			rowPulse[y] += pulses;
+			colPulse[x] += pulses;
+			sumPulse += pulses;
+		}
+	}
+	uint32_t percentile[3];	// p50, p99, p99.9
+	const double quantile[3] = {0.5, 0.99, 0.999};
+	for (int q=0; q<3; q++) {
+		std::vector<uint32_t>::iterator nth = numPulse.begin() + std::min(numPulse.size() - 1, (size_t)(quantile[q] * numPulse.size()));
+		std::nth_element(numPulse.begin(), nth, numPulse.end());
+		percentile[q] = *nth;
+	}
+	int hotRow = std::max_element(rowPulse.begin(), rowPulse.end()) - rowPulse.begin();
+	int hotCol = std::max_element(colPulse.begin(), colPulse.end()) - colPulse.begin();
+	double meanRow = sumPulse / numInput, meanCol = sumPulse / numCol;
+	printf("Endurance of subArray%s: pulses per cell max=%u p99.9=%u p99=%u p50=%u mean=%.1f (SET max=%u, RESET max=%u, %lld saturated counters), hottest row %d (%.2fx the mean), hottest cell column %d (%.2fx the mean)\n",
+			name.c_str(), *std::max_element(numPulse.begin(), numPulse.end()), percentile[2], percentile[1], percentile[0], sumPulse / numPulse.size(),
+			maxSet, maxReset, (long long)numSaturated, hotRow, meanRow > 0? rowPulse[hotRow] / meanRow : 0, hotCol, meanCol > 0? colPulse[hotCol] / meanCol : 0);
+}
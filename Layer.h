@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef LAYER_H_
+#define LAYER_H_
+
+#include <stdint.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "Param.h"
+#include "Array.h"
+#include "NeuroSim.h"
+#include "CostBreakdown.h"
+
+/* One fully connected layer of the MLP: its weights, the synaptic array that stores them
+ * and the NeuroSim synaptic core with its neuron peripheries. The layers that feed a hidden
+ * layer use the *IH parameters (deviceTypeIH, alpha1, ...), the output layer uses the *HO ones.
+ * With param->subArrayRows/Cols the weight matrix is split into numTileRow x numTileCol tiles of
+ * the same subarray macro: subArray, the array wires and the neuron peripheries model one tile,
+ * every tile digitizes its own partial sums and tileAdder accumulates the partial sums of the tile
+ * rows below every tile column. */
+class Layer {
+public:
+	Layer(int index, int numInput, int numOutput, bool output, const Param& param, std::mt19937 *gen);
+	~Layer();
+
+	void InitializeArray(const Param *param);	// Cells of the device type of the layer
+	double NeuronArea();	// Area of the neuron peripheries (after NeuroSimNeuronInitialize)
+	double NeuronLeakagePower();	// Standby leakage power of the neuron peripheries
+	void InitializeTileAdder();	// After NeuroSimNeuronInitialize
+	double SubArrayArea() const { return subArray->usedArea * numTileRow * numTileCol; }
+	double SubArrayLeakagePower() const { return subArray->leakage * numTileRow * numTileCol; }
+	/* NeuroSim cost of one column batch of a read on the tile row with activityRowRead, added to *energy and
+	 * *latency. The tiles work in parallel: only the timed tile row (the busiest one) adds the latency, the
+	 * accumulation of the tile partial sums and the neuron peripheries. The modules are also added to *cost if not NULL. */
+	void ReadCost(double activityRowRead, bool timed, double *energy, double *latency, CostBreakdown *cost);
+	void PrintReadTiming() const;	// Throughput and module utilization of the timed reads (param->eventDrivenReadTiming)
+	void PrintEndurance() const;	// Statistics of the pulse counters of the array (param->enduranceReport)
+
+	int index;			// Position from the input side
+	std::string name;	// "IH", "HH<index>" or "HO", used in the reports
+	int numInput;		// # of neurons feeding the layer (rows of the array)
+	int numOutput;		// # of neurons of the layer (columns of the array)
+	bool output;		// True for the output layer
+	/* Parameters of the layer, taken from the *IH or *HO ones */
+	Param::DeviceType deviceType;
+	bool relaxArrayCellWidth;
+	double alpha;		// Learning rate
+	double actDevice;	// Probability of refreshing a device in the Sporadic PCM refresh
+	int numRefresh;		// # of columns refreshed by the Line and Sequential PCM refresh
+	int tileRows, tileCols;		// Synapse rows and columns of one tile
+	int numTileRow, numTileCol;	// # of tiles along the input and the output side
+	bool eventDrivenReadTiming;	// Time the reads with NeuroSimSubArrayReadTiming
+	ReadTiming readTiming;		// Sum of the timing of the timed reads
+	int64_t numTimedReads;
+	CostBreakdown cost;	// Cumulative cost of every component (param->costBreakdown)
+
+	std::vector< std::vector<double> > weight;		// Weights [numOutput][numInput]
+	std::vector< std::vector<double> > deltaWeight;	// Weight change of the last update
+
+	Array *array;		// Synaptic array
+	SubArray *subArray;	// NeuroSim synaptic core for array
+	/* Global properties of subArray */
+	InputParameter inputParameter;
+	Technology tech;
+	MemCell cell;
+	/* Neuron peripheries below subArray */
+	Adder adder;
+	Mux mux;
+	RowDecoder muxDecoder;
+	DFF dff;
+	Adder tileAdder;	// Accumulation of the partial sums of the tile rows (numTileRow > 1)
+
+private:
+	Layer(const Layer&);	// Not copyable (owns the array and the NeuroSim core)
+	Layer& operator=(const Layer&);
+};
+
+#endif
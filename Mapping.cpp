@@ -43,107 +43,67 @@
 #include "Param.h"
 #include "Array.h"
 #include "NeuroSim.h"
-
-extern Param *param;
-
-extern std::vector< std::vector<double> > weight1;
-extern std::vector< std::vector<double> > weight2;
-
-extern Array *arrayIH;
-extern Array *arrayHO;
+#include "Simulator.h"
 
 /* Weights initialization */
-void WeightInitialize() {
-    srand(2);
-    /* Initialize weights for the input layer */
-    for (int i = 0; i < param->nHide; i++) {
-        for (int j = 0; j < param->nInput; j++) {
-            weight1[i][j] = (double)(rand() % 4) / 3;   // random number: 0, 0.33, 0.66 or 1
-        }
-    }
-    /* Initialize weights for the hidden layer */
-    for (int i = 0; i < param->nOutput; i++) {
-        for (int j = 0; j < param->nHide; j++) {
-            weight2[i][j] = (double)(rand() % 4) / 3;   // random number: 0, 0.33, 0.66 or 1
+void Simulator::WeightInitialize() {
+    rng.Seed(2);
+    /* Initialize the weights of every layer from the input side */
+    for (int l = 0; l < layers.size(); l++) {
+        for (int i = 0; i < layers[l]->numOutput; i++) {
+            for (int j = 0; j < layers[l]->numInput; j++) {
+                layers[l]->weight[i][j] = (double)(rng.Rand() % 4) / 3;   // random number: 0, 0.33, 0.66 or 1
+            }
         }
     }
 }
 
 /* Conductance initialization (map weight to RRAM conductance or SRAM data) */
-void WeightToConductance() {
+void Simulator::WeightToConductance() {
+	PROFILE_SCOPE(profiler, PHASE_WEIGHT_TO_CONDUCTANCE);
 
-	if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->PCMON) {
-		for (int col = 0; col < param->nHide; col++) {
-			/* Erase the weight of arrayIH */
-			for (int row = 0; row < param->nInput; row++) {
-				arrayIH->EraseCell(col, row, param->maxWeight, param->minWeight); //Erase Ű Ѵ minConductance 
-			}
-		}
-			/* ReWrite weight to arrayIH */
-			for (int col = 0; col < param->nHide; col++) {
-				for (int row = 0; row < param->nInput; row++) {
-					//arrayIH->ReWriteCell(col, row, weight1[col][row], param->maxWeight, param->minWeight);
-					arrayIH->WriteCell(col, row, weight1[col][row]-0.5, param->maxWeight, param->minWeight, false);
-					//std::cout << arrayIH->ConductanceToWeight(col, row, param->maxWeight, param->minWeight) << std::endl;
+	for (int l = 0; l < layers.size(); l++) {
+		Layer *layer = layers[l];
+		Array *array = layer->array;
+		AnalogNVM *pcm = dynamic_cast<AnalogNVM*>(array->cell[0][0]);	// PCMON only exists on analog eNVM
+		if (pcm && pcm->PCMON) {
+			/* RESET the array (the erased cells hold the weight 0.5) */
+			for (int col = 0; col < layer->numOutput; col++) {
+				for (int row = 0; row < layer->numInput; row++) {
+					array->EraseCell(col, row, param->maxWeight, param->minWeight);
 				}
 			}
-	}
-	else {
-		/* Erase the weight of arrayIH */
-		for (int col = 0; col < param->nHide; col++) {
-			for (int row = 0; row < param->nInput; row++) {
-				arrayIH->WriteCell(col, row, -(param->maxWeight - param->minWeight) /* delta_W=-(param->maxWeight-param->minWeight) will completely erase */, param->maxWeight, param->minWeight, false);
-			}
-		}
-		/* Write weight to arrayIH */
-		for (int col = 0; col < param->nHide; col++) {
-			for (int row = 0; row < param->nInput; row++) {
-				arrayIH->WriteCell(col, row, weight1[col][row], param->maxWeight, param->minWeight, false);
-			}
-		}
-	}
-	if (static_cast<AnalogNVM*>(arrayHO->cell[0][0])->PCMON) {
-		for (int col = 0; col < param->nOutput; col++) {
-			/* Erase the weight of arrayIH */
-			for (int row = 0; row < param->nHide; row++) {
-				arrayHO->EraseCell(col, row, param->maxWeight, param->minWeight);
+			/* ReWrite the weights to the array */
+			for (int col = 0; col < layer->numOutput; col++) {
+				for (int row = 0; row < layer->numInput; row++) {
+					array->WriteCell(col, row, layer->weight[col][row] - 0.5, param->maxWeight, param->minWeight, false);
+				}
 			}
 		}
-			/* ReWrite weight to arrayIH */
-			for (int col = 0; col < param->nOutput; col++) {
-				for (int row = 0; row < param->nHide; row++) {
-					//arrayHO->ReWriteCell(col, row, weight2[col][row], param->maxWeight, param->minWeight);
-					arrayHO->WriteCell(col, row, weight2[col][row] - 0.5, param->maxWeight, param->minWeight, false);
+		else {
+			/* Erase the weights of the array */
+			for (int col = 0; col < layer->numOutput; col++) {
+				for (int row = 0; row < layer->numInput; row++) {
+					array->WriteCell(col, row, -(param->maxWeight - param->minWeight) /* delta_W=-(param->maxWeight-param->minWeight) will completely erase */, param->maxWeight, param->minWeight, false);
 				}
 			}
-	}
-	else {
-		/* Erase the weight of arrayHO */
-		for (int col = 0; col < param->nOutput; col++) {
-			for (int row = 0; row < param->nHide; row++) {
-				arrayHO->WriteCell(col, row, -(param->maxWeight - param->minWeight) /* delta_W=-(param->maxWeight-param->minWeight) will completely erase */, param->maxWeight, param->minWeight, false);
-			}
-		}
-
-		/* Write weight to arrayHO */
-		for (int col = 0; col < param->nOutput; col++) {
-			for (int row = 0; row < param->nHide; row++) {
-				arrayHO->WriteCell(col, row, weight2[col][row], param->maxWeight, param->minWeight, false);
+			/* Write the weights to the array */
+			for (int col = 0; col < layer->numOutput; col++) {
+				for (int row = 0; row < layer->numInput; row++) {
+					array->WriteCell(col, row, layer->weight[col][row], param->maxWeight, param->minWeight, false);
+				}
 			}
 		}
 	}
-
-	
-
 }
 
 /* Mapping from analog current to digital output*/
-int CurrentToDigits(double I /* current */, double Imax /* max current */) {
+int Simulator::CurrentToDigits(double I /* current */, double Imax /* max current */) {
     return (int)(I / (Imax/param->pSumMaxHardware)); //psumMaxhardware: 255
 }
 
 /* Mapping from hardware digital output to algorithm value*/
-double DigitsToAlgorithm(int outputDigits /* output digits from ADC */, double pSumMaxAlgorithm /* max value of partial weighted sum in algorithm */) {
+double Simulator::DigitsToAlgorithm(int outputDigits /* output digits from ADC */, double pSumMaxAlgorithm /* max value of partial weighted sum in algorithm */) {
     return ((double)outputDigits / param->pSumMaxHardware) * pSumMaxAlgorithm;
 }
 
@@ -46,9 +46,7 @@
 
 using namespace std;
 
-extern Param *param;
-
-void NeuroSimSubArrayInitialize(SubArray *& subArray, Array *array, InputParameter& inputParameter, Technology& tech, MemCell& cell) {
+void NeuroSimSubArrayInitialize(SubArray *& subArray, Array *array, InputParameter& inputParameter, Technology& tech, MemCell& cell, Param *param, bool relaxArrayCellWidth) {
 	
 	/* Create SubArray object and link the required global objects (not initialization) */
 	subArray = new SubArray(inputParameter, tech, cell);
@@ -85,7 +83,8 @@ void NeuroSimSubArrayInitialize(SubArray *& subArray, Array *array, InputParamet
 		subArray->shiftAddEnable = false;
 	}
 	subArray->relaxArrayCellHeight = param->relaxArrayCellHeight;
-	subArray->relaxArrayCellWidth = param->relaxArrayCellWidth;
+	subArray->relaxArrayCellWidth = relaxArrayCellWidth;
+	subArray->dynamicPerformance = param->NeuroSimDynamicPerformance;
 
 	cell.heightInFeatureSize = (array->cell[0][0])->heightInFeatureSize;	// Cell height in feature size
 	cell.widthInFeatureSize = (array->cell[0][0])->widthInFeatureSize;		// Cell width in feature size
@@ -98,7 +97,7 @@ void NeuroSimSubArrayInitialize(SubArray *& subArray, Array *array, InputParamet
 		cell.widthAccessCMOS = static_cast<SRAM*>(array->cell[0][0])->widthAccessCMOS;
 		cell.minSenseVoltage = static_cast<SRAM*>(array->cell[0][0])->minSenseVoltage;	// The minimum voltage difference for sensing
 		subArray->avgWeightBit = subArray->numCellPerSynapse;   // Average weight for each synapse (value can range from 0 to numCellPerSynapse)
-		subArray->numReadCellPerOperationNeuro = (int)ceil((double)array->arrayColSize / param->numColMuxed) * subArray->numCellPerSynapse;	// # of SRAM read cells in neuromorphic mode 
+		subArray->numReadCellPerOperationNeuro = (int)ceil((double)array->tileColSize / param->numColMuxed) * subArray->numCellPerSynapse;	// # of SRAM read cells in neuromorphic mode 
 
 	} else {	// eNVM
 		cell.memCellType = Type::RRAM;
@@ -139,8 +138,8 @@ void NeuroSimSubArrayInitialize(SubArray *& subArray, Array *array, InputParamet
 		cell.accessVoltage = 1.1;	// Gate voltage for the transistor in 1T1R
 	}
 
-	int numRow = array->arrayRowSize;	// Transfer the parameter of # of rows from the MLP simulator to NeuroSim
-	int numCol = array->arrayColSize * subArray->numCellPerSynapse;	// Transfer the parameter of # of columns from the MLP simulator to NeuroSim (times the # of cells per synapse for SRAM)
+	int numRow = array->tileRowSize;	// Transfer the parameter of # of rows of one tile from the MLP simulator to NeuroSim
+	int numCol = array->tileColSize * subArray->numCellPerSynapse;	// Transfer the parameter of # of columns of one tile from the MLP simulator to NeuroSim (times the # of cells per synapse for SRAM)
 	if (param->numColMuxed > numCol) {	// Set the upperbound of param->numColMuxed
 		param->numColMuxed = numCol;
 	}
@@ -182,7 +181,7 @@ void NeuroSimSubArrayArea(SubArray *subArray) {
 }
 
 double NeuroSimSubArrayReadLatency(SubArray *subArray) {	// For 1 weighted sum task on selected columns
-	if (!param->NeuroSimDynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
+	if (!subArray->dynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
 	if (subArray->cell.memCellType == Type::SRAM) {   // SRAM
 		subArray->wlDecoder.CalculateLatency(1e20, subArray->capRow1, NULL, subArray->numRow * subArray->numReadPulse * subArray->activityRowRead, 1);	// Don't care write
 		subArray->precharger.CalculateLatency(1e20, subArray->capCol, subArray->numRow * subArray->numReadPulse * subArray->activityRowRead, 1);	// Don't care write
@@ -230,7 +229,7 @@ double NeuroSimSubArrayReadLatency(SubArray *subArray) {	// For 1 weighted sum t
 					subArray->shiftAdd.CalculateLatency(subArray->numReadPulse);    // There are numReadPulse times of shift-and-add
 				}
 
-				return  MAX(subArray->wlDecoder.readLatency, subArray->muxDecoder.readLatency + subArray->mux.readLatency);
+				return  MAX(subArray->wlDecoder.readLatency, subArray->muxDecoder.readLatency + subArray->mux.readLatency) +
 						subArray->voltageSenseAmp.readLatency +
 						subArray->adder.readLatency +
 						subArray->dff.readLatency +
@@ -255,7 +254,7 @@ double NeuroSimSubArrayReadLatency(SubArray *subArray) {	// For 1 weighted sum t
 				if (subArray->shiftAddEnable) {
 					subArray->shiftAdd.CalculateLatency(subArray->numReadPulse);    // There are numReadPulse times of shift-and-add
 				}
-				return  MAX(subArray->wlDecoder.readLatency + subArray->wlDecoderDriver.readLatency, subArray->muxDecoder.readLatency + subArray->mux.readLatency);
+				return  MAX(subArray->wlDecoder.readLatency + subArray->wlDecoderDriver.readLatency, subArray->muxDecoder.readLatency + subArray->mux.readLatency) +
 						subArray->voltageSenseAmp.readLatency +
 						subArray->adder.readLatency +
 						subArray->dff.readLatency +
@@ -311,8 +310,88 @@ double NeuroSimSubArrayReadLatency(SubArray *subArray) {	// For 1 weighted sum t
 	}
 }
 
+/* Event-driven schedule of one weighted sum task: numPulse input pulses of numEventPerPulse identical row events,
+ * every event going through the pipeline stages stage[0..2] (row decoder, columns, accumulation), then one shift-and-add
+ * per pulse. A module works on one event at a time and takes the next one as soon as it is free and the module before
+ * is done with it, and the columns cannot take an event before ready (the column selection). For identical events this
+ * tandem queue has the closed form D(n) = max over s of (start of stage s + sum of stage[s..2] + n * max of stage[s..2])
+ * for the end of event n, so the schedule costs O(numPulse) and stays cheap enough for the records of ./replay. */
+static double ScheduleReadTask(const double stage[3], double ready, double numEventPerPulse, int numPulse, double shiftAddPerPulse) {
+	double start[3] = {0, ready, 0};	// Earliest start of the stages (only the columns wait for the setup)
+	double end = 0;	// End of the last shift-and-add
+	for (int p=0; p<numPulse; p++) {
+		double rowsDone = 0;	// End of the last row event of the pulse
+		if (numEventPerPulse > 0) {
+			double n = MAX((p + 1) * numEventPerPulse - 1, 0);
+			for (int s=0; s<3; s++) {
+				double sum = 0, slowest = 0;
+				for (int t=s; t<3; t++) {
+					sum += stage[t];
+					slowest = MAX(slowest, stage[t]);
+				}
+				rowsDone = MAX(rowsDone, start[s] + sum + n * slowest);
+			}
+		}
+		end = MAX(rowsDone, end) + shiftAddPerPulse;
+	}
+	return end;
+}
+
+double NeuroSimSubArrayReadTiming(SubArray *subArray, ReadTiming *timing) {
+	timing->latency = timing->interval = 0;
+	for (int s=0; s<NUM_READ_STAGES; s++) {
+		timing->busy[s] = 0;
+	}
+	if (!subArray->dynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
+	NeuroSimSubArrayReadLatency(subArray);	// Latency of every module over the whole task
+
+	double *busy = timing->busy;
+	double numEvent;	// Row events of the task
+	double setup = 0;	// Column selection (or word line activation) before the first event reaches the columns
+	if (subArray->cell.memCellType == Type::SRAM) {	// SRAM: one row per event
+		numEvent = subArray->numRow * subArray->numReadPulse * subArray->activityRowRead;
+		busy[READ_DECODE] = subArray->wlDecoder.readLatency;
+		busy[READ_COLUMN] = subArray->precharger.readLatency + subArray->colDelay;
+		busy[READ_CONVERT] = subArray->senseAmp.readLatency;
+		busy[READ_ACCUMULATE] = subArray->adder.readLatency + subArray->dff.readLatency;
+	} else if (subArray->digitalModeNeuro) {	// Digital eNVM: one row per event
+		numEvent = subArray->numRow * subArray->numReadPulse * subArray->activityRowRead;
+		setup = subArray->muxDecoder.readLatency + subArray->mux.readLatency;
+		busy[READ_DECODE] = subArray->wlDecoder.readLatency;
+		busy[READ_COLUMN] = subArray->colDelay * numEvent;
+		if (subArray->cell.accessType != CMOS_access) {	// Cross-point: the word line driver holds the row
+			busy[READ_COLUMN] += subArray->wlDecoderDriver.readLatency;
+		}
+		busy[READ_CONVERT] = subArray->voltageSenseAmp.readLatency;
+		busy[READ_ACCUMULATE] = subArray->adder.readLatency + subArray->dff.readLatency;
+	} else {	// Analog eNVM: all the rows at once, one event per input pulse
+		numEvent = subArray->numReadPulse;
+		if (subArray->cell.accessType == CMOS_access) {	// 1T1R
+			setup = subArray->wlDecoderOutput.readLatency;
+			busy[READ_COLUMN] = subArray->blSwitchMatrix.readLatency;
+		} else {	// Cross-point
+			busy[READ_COLUMN] = subArray->wlSwitchMatrix.readLatency;
+		}
+		busy[READ_CONVERT] = subArray->readCircuit.readLatency;
+	}
+	busy[READ_SHIFT_ADD] = subArray->shiftAdd.readLatency;
+
+	/* The drive and conversion of a row event hold the rows and the bit lines, so they are one pipeline stage */
+	double stage[3] = {0, 0, 0};
+	if (numEvent > 0) {
+		stage[0] = busy[READ_DECODE] / numEvent;
+		stage[1] = (busy[READ_COLUMN] + busy[READ_CONVERT]) / numEvent;
+		stage[2] = busy[READ_ACCUMULATE] / numEvent;
+	}
+	busy[READ_DECODE] += setup;
+	timing->latency = ScheduleReadTask(stage, setup, numEvent / subArray->numReadPulse, subArray->numReadPulse, busy[READ_SHIFT_ADD] / subArray->numReadPulse);
+	/* Back-to-back tasks are paced by the busiest module */
+	timing->interval = MAX(MAX(busy[READ_DECODE], busy[READ_COLUMN] + busy[READ_CONVERT]), MAX(busy[READ_ACCUMULATE], busy[READ_SHIFT_ADD]));
+	return timing->latency;
+}
+
 double NeuroSimSubArrayWriteLatency(SubArray *subArray, int numWriteOperationPerRow, double sumWriteLatencyAnalogNVM) {	// For 1 weight update task of whole array
-	if (!param->NeuroSimDynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
+	if (!subArray->dynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
 	subArray->activityRowWrite = 1;
 	subArray->activityColWrite = 1;
 	if (subArray->cell.memCellType == Type::SRAM) {	// SRAM
@@ -377,7 +456,7 @@ double NeuroSimSubArrayWriteLatency(SubArray *subArray, int numWriteOperationPer
 }
 
 double NeuroSimSubArrayReadEnergy(SubArray *subArray) {	// For 1 weighted sum task on selected columns
-	if (!param->NeuroSimDynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
+	if (!subArray->dynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
 	if (subArray->cell.memCellType == Type::SRAM) {   // SRAM
 		subArray->wlDecoder.CalculatePower(subArray->numRow * subArray->numReadPulse * subArray->activityRowRead, 1);	// Don't care write
 		subArray->precharger.CalculatePower(subArray->numRow * subArray->numReadPulse * subArray->activityRowRead, 1);	// Don't care write
@@ -473,7 +552,7 @@ double NeuroSimSubArrayReadEnergy(SubArray *subArray) {	// For 1 weighted sum ta
 }
 
 double NeuroSimSubArrayWriteEnergy(SubArray *subArray, int numWriteOperationPerRow, double numWriteCellPerOperation) {	// For 1 weight update task of one row
-	if (!param->NeuroSimDynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
+	if (!subArray->dynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
 	subArray->activityRowWrite = 1;
 	subArray->activityColWrite = 1;
 	if (subArray->cell.memCellType == Type::SRAM) {   // SRAM
@@ -637,9 +716,10 @@ double NeuroSimSubArrayLeakagePower(SubArray *subArray) {
 			}
 		}
 	}
+	return subArray->leakage;
 }
 
-void NeuroSimNeuronInitialize(SubArray *& subArray, InputParameter& inputParameter, Technology& tech, MemCell& cell, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff) {
+void NeuroSimNeuronInitialize(SubArray *& subArray, InputParameter& inputParameter, Technology& tech, MemCell& cell, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff, Param *param) {
 	int numAdderBit;
 	if (subArray->shiftAddEnable) {	// Here we only support adder in non-spiking fashion
 		numAdderBit = subArray->shiftAdd.numAdderBit + 1 + subArray->shiftAdd.numReadPulse - 1;
@@ -678,7 +758,7 @@ void NeuroSimNeuronArea(SubArray *subArray, Adder& adder, Mux& mux, RowDecoder&
 }
 
 double NeuroSimNeuronReadLatency(SubArray *subArray, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff) {	// For 1 weighted sum task on selected columns
-	if (!param->NeuroSimDynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
+	if (!subArray->dynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
 	if (subArray->numColMuxed > 1) {
 		adder.CalculateLatency(1e20, mux.capTgDrain, 1);
 		mux.CalculateLatency(adder.rampOutput, dff.capTgDrain, 1);
@@ -691,7 +771,7 @@ double NeuroSimNeuronReadLatency(SubArray *subArray, Adder& adder, Mux& mux, Row
 }
 
 double NeuroSimNeuronReadEnergy(SubArray *subArray, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff) {	// For 1 weighted sum task on selected columns
-	if (!param->NeuroSimDynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
+	if (!subArray->dynamicPerformance) { return 0; }	// Skip this function if param->NeuroSimDynamicPerformance is false
 	adder.CalculatePower(1, adder.numAdder);
 	if (subArray->numColMuxed > 1) {
 		mux.CalculatePower(1);
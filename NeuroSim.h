@@ -48,16 +48,35 @@
 #include "NeuroSim/Mux.h"
 #include "NeuroSim/RowDecoder.h"
 #include "NeuroSim/DFF.h"
+#include "Param.h"
 
-void NeuroSimSubArrayInitialize(SubArray *& subArray, Array *array, InputParameter& inputParameter, Technology& tech, MemCell& cell);
+/* Modules of the read pipeline of a synaptic core (see NeuroSimSubArrayReadTiming) */
+enum ReadStage {
+	READ_DECODE,		// Row decoder and column selection
+	READ_COLUMN,		// Row drive and bit line settling
+	READ_CONVERT,		// Sense amplifier or integrate-and-fire read circuit
+	READ_ACCUMULATE,	// Adder and DFF accumulating the row reads (SRAM and digital eNVM)
+	READ_SHIFT_ADD,		// Shift-and-add of the input bits
+	NUM_READ_STAGES
+};
+
+/* Event-driven timing of one weighted sum task on selected columns */
+struct ReadTiming {
+	double latency;		// From the first decode to the last shift-and-add (s)
+	double interval;	// Initiation interval of back-to-back tasks, set by the busiest module (s)
+	double busy[NUM_READ_STAGES];	// Busy time of every module (s)
+};
+
+void NeuroSimSubArrayInitialize(SubArray *& subArray, Array *array, InputParameter& inputParameter, Technology& tech, MemCell& cell, Param *param, bool relaxArrayCellWidth);
 void NeuroSimSubArrayArea(SubArray *subArray);
 double NeuroSimSubArrayReadLatency(SubArray *subArray);	// For 1 weighted sum task on selected columns
+double NeuroSimSubArrayReadTiming(SubArray *subArray, ReadTiming *timing);	// Same task with overlapping modules, returns timing->latency
 double NeuroSimSubArrayWriteLatency(SubArray *subArray, int numWriteOperationPerRow, double sumWriteLatencyAnalogNVM);	// For 1 weight update task of whole array
 double NeuroSimSubArrayReadEnergy(SubArray *subArray);	// For 1 weighted sum task on selected columns
 double NeuroSimSubArrayWriteEnergy(SubArray *subArray, int numWriteOperationPerRow, double numWriteCellPerOperation);	// For 1 weight update task of one row
 double NeuroSimSubArrayLeakagePower(SubArray *subArray);
 
-void NeuroSimNeuronInitialize(SubArray *& subArray, InputParameter& inputParameter, Technology& tech, MemCell& cell, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff);
+void NeuroSimNeuronInitialize(SubArray *& subArray, InputParameter& inputParameter, Technology& tech, MemCell& cell, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff, Param *param);
 void NeuroSimNeuronArea(SubArray *subArray, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff, double *height, double *width);
 double NeuroSimNeuronReadLatency(SubArray *subArray, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff);	// For 1 weighted sum task on selected columns
 double NeuroSimNeuronReadEnergy(SubArray *subArray, Adder& adder, Mux& mux, RowDecoder& muxDecoder, DFF& dff);	// For 1 weighted sum task on selected columns
@@ -46,6 +46,7 @@ using namespace std;
 
 Mux::Mux(const InputParameter& _inputParameter, const Technology& _tech, const MemCell& _cell): inputParameter(_inputParameter), tech(_tech), cell(_cell), FunctionUnit() {
 	initialized = false;
+	capTgGateN = capTgGateP = capTgDrain = 0;	// Taken as loads by other modules before CalculateArea()
 }
 
 void Mux::Initialize(int _numInput, int _numSelection, double _resTg, bool _digital){
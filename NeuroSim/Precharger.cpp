@@ -46,6 +46,7 @@ using namespace std;
 
 Precharger::Precharger(const InputParameter& _inputParameter, const Technology& _tech, const MemCell& _cell): inputParameter(_inputParameter), tech(_tech), cell(_cell), FunctionUnit() {
 	initialized = false;
+	capLoad = 0;	// Set by CalculateLatency(), but CalculatePower() also runs without it for the standby leakage
 }
 
 void Precharger::Initialize(int _numCol, double _resLoad, double _activityColWrite, int _numReadCellPerOperationNeuro, int _numWriteCellPerOperationNeuro) {
@@ -46,6 +46,7 @@ using namespace std;
 
 ReadCircuit::ReadCircuit(const InputParameter& _inputParameter, const Technology& _tech, const MemCell& _cell): inputParameter(_inputParameter), tech(_tech), cell(_cell), FunctionUnit() {
 	initialized = false;
+	maxNumIntBit = 0;	// Initialize() takes maxNumIntPerCycle from it before setting it
 }
 
 void ReadCircuit::Initialize(ReadCircuitMode _mode, int _numReadCol, int _maxNumIntBit, SpikingMode _spikingMode, double _clkFreq) {
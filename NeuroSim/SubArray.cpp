@@ -46,6 +46,15 @@ using namespace std;
 
 SubArray::SubArray(InputParameter& _inputParameter, Technology& _tech, MemCell& _cell):
 						inputParameter(_inputParameter), tech(_tech), cell(_cell),
+						initialized(false), numRow(0), numCol(0), numColMuxed(0), numWriteColMuxed(0),
+						heightArray(0), widthArray(0), areaArray(0), readDynamicEnergyArray(0), writeDynamicEnergyArray(0),
+						lengthRow(0), lengthCol(0), unitWireRes(0), capRow1(0), capRow2(0), capCol(0), resRow(0), resCol(0),
+						resCellAccess(0), capCellAccess(0), colDelay(0),
+						activityRowWrite(0), activityColWrite(0), activityRowRead(0), numReadPulse(0), numWritePulse(0),
+						maxNumWritePulse(0), maxNumIntBit(0), digitalModeNeuro(false), readCircuitMode(CMOS),
+						numWriteCellPerOperationNeuro(0), clkFreq(0), numCellPerSynapse(0), avgWeightBit(0),
+						numReadCellPerOperationNeuro(0), spikingMode(NONSPIKING), shiftAddEnable(false),
+						relaxArrayCellHeight(false), relaxArrayCellWidth(false), dynamicPerformance(false),
 						wlDecoder(_inputParameter, _tech, _cell),
 						wlDecoderOutput(_inputParameter, _tech, _cell),
 						mux(_inputParameter, _tech, _cell),
@@ -64,8 +73,6 @@ SubArray::SubArray(InputParameter& _inputParameter, Technology& _tech, MemCell&
 						adder(_inputParameter, _tech, _cell),
 						dff(_inputParameter, _tech, _cell),
 						shiftAdd(_inputParameter, _tech, _cell) {
-	initialized = false;
-	readDynamicEnergyArray = writeDynamicEnergyArray = 0;
 }
 
 void SubArray::Initialize(int _numRow, int _numCol, double _unitWireRes){  //initialization module
@@ -392,6 +399,11 @@ void SubArray::CalculateArea() {  //calculate layout area for total design
 
 					voltageSenseAmp.CalculateUnitArea();
 					voltageSenseAmp.CalculateArea(mux.widthTgShared);
+					adder.CalculateArea(NULL, widthArray, NONE);
+					dff.CalculateArea(NULL, widthArray, NONE);
+					if (shiftAddEnable) {
+						shiftAdd.CalculateArea(NULL, widthArray, NONE);
+					}
 
 					height = colDecoder.height + colDecoderDriver.height + heightArray + mux.height + voltageSenseAmp.height + adder.height + dff.height + shiftAdd.height;
 					width = MAX(wlDecoder.width+wlDecoderDriver.width, muxDecoder.width) + widthArray;
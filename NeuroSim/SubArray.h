@@ -117,6 +117,7 @@ public:
 
 	bool relaxArrayCellHeight;	// true: relax the memory cell height to match the height of periperal circuit unit that connects to the row (ex: standard cell height in the last stage of row decoder) if the latter is larger
 	bool relaxArrayCellWidth;	// true: relax the memory cell width to match the width of periperal circuit unit that connects to the column (ex: pass gate width in the column mux) if the latter is larger
+	bool dynamicPerformance;	// true: calculate the dynamic performance (latency and energy) in the MLP simulator wrappers (see NeuroSim.cpp)
 
 	/* Circuit modules */
 	RowDecoder  wlDecoder;
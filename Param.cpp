@@ -36,10 +36,16 @@
 *   Xiaochen Peng   Email: xpeng15 at asu dot edu
 ********************************************************************************/
 
+#include <cstdio>
+#include <cstdlib>
 #include "math.h"
 #include "Param.h"
 
 Param::Param() {
+	/* Synaptic device */
+	deviceTypeIH = RealDeviceType;	// Device used in the synaptic array from input to hidden layer
+	deviceTypeHO = RealDeviceType;	// Device used in the synaptic array from hidden to output layer
+
 	/* MNIST dataset */
 	numMnistTrainImages = 60000;// # of training images in MNIST
 	numMnistTestImages = 10000;	// # of testing images in MNIST
@@ -51,11 +57,42 @@ Param::Param() {
 	nInput = 400;     // # of neurons in input layer
 	nHide = 100;      // # of neurons in hidden layer
 	nOutput = 10;     // # of neurons in output layer
+	hiddenLayers = "";	// # of neurons of every hidden layer from the input side, e.g. "512-256" (empty: one hidden layer of nHide)
 	alpha1 = 0.4;	// Learning rate for the weights from input to hidden layer
 	alpha2 = 0.2;	// Learning rate for the weights from hidden to output layer
 	maxWeight = 1;	// Upper bound of weight value
 	minWeight = 0;	// Lower bound of weight value
 
+	/* Validation parameters */
+	numValidationSubset = 0;	// # of testing images in the stratified validation subset (0: always validate on the full testing set)
+	fullValidationInterval = 10;	// Validate on the full testing set every fullValidationInterval epochs (and at the last epoch)
+	validationSubsetSeed = 1;	// Random seed for selecting the validation subset (fixed per run)
+	validationConfidenceZ = 1.96;	// z-score of the accuracy confidence interval (1.96 for 95%)
+
+	/* Early stop parameters */
+	earlyStop = false;		// Stop training early when the accuracy plateaus or regresses
+	earlyStopMinEpochs = 20;	// Never stop before this number of epochs
+	earlyStopPatience = 10;	// Stop after this many validations without improvement
+	earlyStopMinDelta = 0.1;	// Min accuracy gain (%) that counts as an improvement
+	earlyStopMaxRegression = 5;	// Stop if the accuracy drops more than this (%) below the best accuracy
+	extrapolateEarlyStopCost = false;	// Extrapolate the latency and energy of an early stopped run to totalNumEpochs
+
+	/* Checkpoint parameters */
+	checkpointFile = "";	// Checkpoint file name, %d is replaced by the epoch to keep every checkpoint (empty: no checkpoint)
+	checkpointInterval = 1;	// Write a checkpoint every checkpointInterval epochs
+	resumeFile = "";	// Checkpoint to resume from (empty: start from WeightInitialize)
+
+	/* Profiler parameters */
+	profile = false;	// Print the phase breakdown and throughput of every epoch
+	profileHardwareCounters = false;	// Also sample cycles, instructions and cache misses per epoch (perf_event_open)
+	profileTraceFile = "";	// Chrome trace (chrome://tracing) of the serial phases (empty: no trace)
+	profileMaxTraceEvents = 1000000;	// Max number of events kept for the trace
+
+	/* Activity trace parameters */
+	activityTraceFile = "";	// Binary trace of the NeuroSim activity for ./replay (empty: no trace, see ActivityTrace.h)
+	telemetryFile = "";	// JSON lines with the device state of every layer at every validation (empty: no telemetry, see Telemetry.h)
+	telemetryNumBins = 20;	// # of bins of the weight and conductance histograms
+
 	/* Hardware parameters */
 	useHardwareInTrainingFF = true;   // Use hardware in the feed forward part of training or not (true: realistic hardware, false: ideal software)
 	useHardwareInTrainingWU = true;   // Use hardware in the weight update part of training or not (true: realistic hardware, false: ideal software)
@@ -72,12 +109,24 @@ Param::Param() {
 	numWriteColMuxed = 16;	// How many columns share 1 write column decoder driver (for digital RRAM)
 	writeEnergyReport = true;	// Report write energy calculation or not
 	NeuroSimDynamicPerformance = true; // Report the dynamic performance (latency and energy) in NeuroSim or not
+	eventDrivenReadTiming = false;	// Overlap the modules of a subarray read instead of adding their latencies (see NeuroSimSubArrayReadTiming)
+	enduranceReport = false;	// Count the SET/RESET pulses of every eNVM cell and print their statistics at every validation
+	costBreakdown = false;	// Print the cumulative energy and latency of every array component and NeuroSim module at every validation (see CostBreakdown.h)
 	relaxArrayCellHeight = 0;	// True: relax the array cell height to standard logic cell height in the synaptic array
-	relaxArrayCellWidth = 0;	// True: relax the array cell width to standard logic cell width in the synaptic array
+	relaxArrayCellWidthIH = 0;	// True: relax the array cell width to standard logic cell width in the synaptic array from input to hidden layer
+	relaxArrayCellWidthHO = 1;	// True: relax the array cell width to standard logic cell width in the synaptic array from hidden to output layer
+	subArrayRows = 0;	// # of synapse rows of one subarray tile, larger layers are split into tiles (0: one subarray per layer)
+	subArrayCols = 0;	// # of synapse columns of one subarray tile (0: one subarray per layer)
 	arrayWireWidth = 40;	// Array wire width (nm)
 	processNode = 14;	// Technology node (nm)
 	clkFreq = 2e9;		// Clock frequency (Hz)
 
+	/* Chip parameters (see Chip.h) */
+	chipReport = false;	// Print the chip-level area, throughput and energy efficiency at the end of the run
+	subArraysPerChipTile = 16;	// # of subarray tiles in one chip tile
+	numChipTiles = 0;	// # of chip tiles (0: as many as the network needs)
+	htreeBusWidth = 128;	// # of bits of the H-tree between the global buffer and the chip tiles
+
 	numImageperRESET = 100;
 	PrintWeightdist = false;
 	ActDeviceIH = 0.2;
@@ -86,5 +135,41 @@ Param::Param() {
 	NumRefHiddenLayer =50;
 	NumRefOutputLayer =5;
 	mode =Line; // Randome Refresh mode Line, Sporadic, Sequential ( Line :   , Sporadic:   , Sequential :   )
+
+	UpdateDerivedParameters();	// layerSizes
 }
 
+void Param::UpdateDerivedParameters() {
+	useHardwareInTraining = useHardwareInTrainingFF || useHardwareInTrainingWU;
+	pSumMaxHardware = pow(2, numBitPartialSum) - 1;
+	numInputLevel = pow(2, numBitInput);
+	if (subArrayRows < 0 || subArrayCols < 0) {
+		printf("[Config] Error: subArrayRows=%d and subArrayCols=%d cannot be negative\n", subArrayRows, subArrayCols);
+		exit(-1);
+	}
+	if (subArraysPerChipTile < 1 || numChipTiles < 0 || htreeBusWidth < 1) {
+		printf("[Config] Error: subArraysPerChipTile=%d, numChipTiles=%d and htreeBusWidth=%d are out of range\n", subArraysPerChipTile, numChipTiles, htreeBusWidth);
+		exit(-1);
+	}
+	if (telemetryNumBins < 1) {
+		printf("[Config] Error: telemetryNumBins=%d must be at least 1\n", telemetryNumBins);
+		exit(-1);
+	}
+
+	layerSizes.assign(1, nInput);
+	if (hiddenLayers.empty()) {
+		layerSizes.push_back(nHide);
+	} else {
+		const char *p = hiddenLayers.c_str();
+		char *end = NULL;
+		do {
+			long size = strtol(end? end + 1 : p, &end, 10);
+			if (size <= 0 || (*end != '-' && *end != '\0')) {
+				printf("[Config] Error: hiddenLayers=%s is not a list of layer sizes like 512-256\n", hiddenLayers.c_str());
+				exit(-1);
+			}
+			layerSizes.push_back(size);
+		} while (*end == '-');
+	}
+	layerSizes.push_back(nOutput);
+}
@@ -39,9 +39,26 @@
 #ifndef PARAM_H_
 #define PARAM_H_
 
+#include <map>
+#include <string>
+#include <vector>
+
 class Param {
 public:
 	Param();
+	void UpdateDerivedParameters();	// Recompute the parameters that depend on others (after loading a config)
+
+	/* Synaptic device */
+	enum DeviceType {
+		IdealDeviceType,
+		RealDeviceType,
+		MeasuredDeviceType,
+		SRAMType,
+		DigitalNVMType
+	};
+	DeviceType deviceTypeIH;	// Device used in the synaptic array from input to hidden layer
+	DeviceType deviceTypeHO;	// Device used in the synaptic array from hidden to output layer
+	std::map<std::string, double> deviceParams;	// Device parameter overrides, keyed by "Device.name" (see Config.h)
 
 	/* MNIST dataset */
 	int numMnistTrainImages;// # of training images in MNIST
@@ -54,11 +71,45 @@ public:
 	int nInput;     // # of neurons in input layer
 	int nHide;      // # of neurons in hidden layer
 	int nOutput;	// # of neurons in output layer
+	std::string hiddenLayers;	// # of neurons of every hidden layer from the input side, e.g. "512-256" (empty: one hidden layer of nHide)
+	std::vector<int> layerSizes;	// # of neurons from the input to the output layer (derived from nInput, hiddenLayers or nHide, and nOutput)
 	double alpha1;		// Learning rate for the synapses from input to hidden layer
 	double alpha2;		// Learning rate for the synapses from hidden to output layer
 	double maxWeight;	// Upper bound of weight value
 	double minWeight;	// Lower bound of weight value
 
+	/* Validation parameters */
+	int numValidationSubset;	// # of testing images in the stratified validation subset (0: always validate on the full testing set)
+	int fullValidationInterval;	// Validate on the full testing set every fullValidationInterval epochs (and at the last epoch)
+	int validationSubsetSeed;	// Random seed for selecting the validation subset (fixed per run)
+	double validationConfidenceZ;	// z-score of the accuracy confidence interval (1.96 for 95%)
+
+	/* Early stop parameters */
+	bool earlyStop;		// Stop training early when the accuracy plateaus or regresses
+	int earlyStopMinEpochs;	// Never stop before this number of epochs
+	int earlyStopPatience;	// Stop after this many validations without improvement
+	double earlyStopMinDelta;	// Min accuracy gain (%) that counts as an improvement
+	double earlyStopMaxRegression;	// Stop if the accuracy drops more than this (%) below the best accuracy
+	bool extrapolateEarlyStopCost;	// Extrapolate the latency and energy of an early stopped run to totalNumEpochs
+
+	/* Checkpoint parameters */
+	std::string checkpointFile;	// Checkpoint file name, %d is replaced by the epoch to keep every checkpoint (empty: no checkpoint)
+	int checkpointInterval;	// Write a checkpoint every checkpointInterval epochs
+	std::string resumeFile;	// Checkpoint to resume from (empty: start from WeightInitialize)
+
+	/* Profiler parameters */
+	bool profile;	// Print the phase breakdown and throughput of every epoch
+	bool profileHardwareCounters;	// Also sample cycles, instructions and cache misses per epoch (perf_event_open)
+	std::string profileTraceFile;	// Chrome trace (chrome://tracing) of the serial phases (empty: no trace)
+	int profileMaxTraceEvents;	// Max number of events kept for the trace
+
+	/* Activity trace parameters */
+	std::string activityTraceFile;	// Binary trace of the NeuroSim activity for ./replay (empty: no trace, see ActivityTrace.h)
+
+	/* Telemetry parameters */
+	std::string telemetryFile;	// JSON lines with the device state of every layer at every validation (empty: no telemetry, see Telemetry.h)
+	int telemetryNumBins;	// # of bins of the weight and conductance histograms
+
 	/* Hardware parameters */
 	bool useHardwareInTrainingFF;   // Use hardware in the feed forward part of training or not (true: realistic hardware, false: ideal software)
 	bool useHardwareInTrainingWU;   // Use hardware in the weight update part of training or not (true: realistic hardware, false: ideal software)
@@ -75,12 +126,24 @@ public:
 	int numWriteColMuxed;	// How many columns share 1 write column decoder driver (for digital RRAM)
 	bool writeEnergyReport;	// Report write energy calculation or not
 	bool NeuroSimDynamicPerformance; // Report the dynamic performance (latency and energy) in NeuroSim or not
+	bool eventDrivenReadTiming;	// Overlap the modules of a subarray read instead of adding their latencies (see NeuroSimSubArrayReadTiming)
+	bool enduranceReport;	// Count the SET/RESET pulses of every eNVM cell and print their statistics at every validation
+	bool costBreakdown;	// Print the cumulative energy and latency of every array component and NeuroSim module at every validation (see CostBreakdown.h)
 	bool relaxArrayCellHeight;	// True: relax the array cell height to standard logic cell height in the synaptic array
-	bool relaxArrayCellWidth;	// True: relax the array cell width to standard logic cell width in the synaptic array
+	bool relaxArrayCellWidthIH;	// True: relax the array cell width to standard logic cell width in the synaptic array from input to hidden layer
+	bool relaxArrayCellWidthHO;	// True: relax the array cell width to standard logic cell width in the synaptic array from hidden to output layer
+	int subArrayRows;	// # of synapse rows of one subarray tile, larger layers are split into tiles (0: one subarray per layer)
+	int subArrayCols;	// # of synapse columns of one subarray tile (0: one subarray per layer)
 	double arrayWireWidth;	// Array wire width (nm)
 	int processNode;	// Technology node (nm)
 	double clkFreq;		// Clock frequency (Hz)
 
+	/* Chip parameters (see Chip.h) */
+	bool chipReport;	// Print the chip-level area, throughput and energy efficiency at the end of the run
+	int subArraysPerChipTile;	// # of subarray tiles in one chip tile
+	int numChipTiles;	// # of chip tiles (0: as many as the network needs)
+	int htreeBusWidth;	// # of bits of the H-tree between the global buffer and the chip tiles
+
 	int numImageperRESET;
 	bool PrintWeightdist;
 	double ActDeviceIH;
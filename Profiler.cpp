@@ -0,0 +1,264 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <omp.h>
+#include "Profiler.h"
+
+static const char *phaseName[NUM_PROFILE_PHASES] = {
+	"forward IH",
+	"forward IH NeuroSim",
+	"forward HO",
+	"forward HO NeuroSim",
+	"backprop",
+	"update IH",
+	"update HO",
+	"batch write (thread)",
+	"NeuroSim write (thread)",
+	"PCM refresh",
+	"Validate",
+	"WeightToConductance"
+};
+
+/* Phases entered inside OpenMP loops: their time is summed over the threads */
+static bool IsThreadPhase(int phase) {
+	return phase == PHASE_WRITE_BATCH || phase == PHASE_NEUROSIM_WRITE;
+}
+
+Profiler::Profiler() {
+	enabled = false;
+	maxTraceEvents = 0;
+	numDroppedEvents = 0;
+	startTime = epochStartTime = Now();
+	for (int p=0; p<NUM_PROFILE_PHASES; p++) {
+		epochTime[p] = totalTime[p] = 0;
+		epochCount[p] = totalCount[p] = 0;
+	}
+	epochImages = epochCellReads = epochCellWrites = 0;
+	totalImages = totalCellReads = totalCellWrites = 0;
+	totalEpochTime = 0;
+	memset(epochCounters, 0, sizeof(epochCounters));
+}
+
+Profiler::~Profiler() {
+	for (int i=0; i<counterFds.size(); i++)
+		close(counterFds[i]);
+}
+
+int64_t Profiler::Now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int OpenCounter(uint64_t config, int groupFd) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	attr.disabled = (groupFd == -1);
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+	return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);	// Calling thread, any CPU
+}
+
+void Profiler::Enable(bool hardwareCounters, int maxTraceEvents) {
+	enabled = true;
+	this->maxTraceEvents = maxTraceEvents;
+	startTime = epochStartTime = Now();
+	if (!hardwareCounters)
+		return;
+	/* perf counters count the calling thread only, so open one group in every OpenMP thread */
+	int numThreads = omp_get_max_threads();
+	std::vector<int> fds(numThreads * 3, -1);
+	#pragma omp parallel num_threads(numThreads)
+	{
+		int t = omp_get_thread_num();
+		fds[t*3] = OpenCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+		if (fds[t*3] >= 0) {
+			fds[t*3+1] = OpenCounter(PERF_COUNT_HW_INSTRUCTIONS, fds[t*3]);
+			fds[t*3+2] = OpenCounter(PERF_COUNT_HW_CACHE_MISSES, fds[t*3]);
+		}
+	}
+	for (int i=0; i<fds.size(); i++) {
+		if (fds[i] < 0) {
+			puts("[Profile] Warning: perf_event_open failed (check /proc/sys/kernel/perf_event_paranoid), hardware counters are disabled");
+			for (int j=0; j<fds.size(); j++) {
+				if (fds[j] >= 0)
+					close(fds[j]);
+			}
+			return;
+		}
+	}
+	for (int t=0; t<numThreads; t++) {
+		counterFds.push_back(fds[t*3]);
+		ioctl(fds[t*3], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(fds[t*3], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+	/* Keep the member fds open, they are closed with their group leader */
+}
+
+void Profiler::ReadCounters(uint64_t *values) {
+	values[0] = values[1] = values[2] = 0;
+	for (int i=0; i<counterFds.size(); i++) {
+		uint64_t buffer[4];	// nr, cycles, instructions, cache misses
+		if (read(counterFds[i], buffer, sizeof(buffer)) == sizeof(buffer)) {
+			for (int c=0; c<3; c++)
+				values[c] += buffer[c+1];
+		}
+	}
+}
+
+void Profiler::Add(ProfilePhase phase, int64_t begin, int64_t end) {
+	double duration = end - begin;
+	#pragma omp atomic
+	epochTime[phase] += duration;
+	#pragma omp atomic
+	epochCount[phase]++;
+	if (!IsThreadPhase(phase) && !omp_in_parallel()) {
+		if (trace.size() < maxTraceEvents) {
+			TraceEvent event = {phase, begin, end};
+			trace.push_back(event);
+		} else {
+			numDroppedEvents++;
+		}
+	}
+}
+
+void Profiler::AddWork(int64_t numImages, int64_t numCellReads, int64_t numCellWrites) {
+	epochImages += numImages;
+	epochCellReads += numCellReads;
+	epochCellWrites += numCellWrites;
+}
+
+/* Move the phase times into the totals */
+void Profiler::FlushPhases() {
+	for (int p=0; p<NUM_PROFILE_PHASES; p++) {
+		totalTime[p] += epochTime[p];
+		totalCount[p] += epochCount[p];
+		epochTime[p] = 0;
+		epochCount[p] = 0;
+	}
+}
+
+void Profiler::BeginEpoch() {
+	if (!enabled)
+		return;
+	epochStartTime = Now();
+	FlushPhases();	// Validate and WeightToConductance since the last epoch
+	epochImages = epochCellReads = epochCellWrites = 0;
+	if (!counterFds.empty())
+		ReadCounters(epochCounters);
+}
+
+void Profiler::EndEpoch(int epoch) {
+	if (!enabled)
+		return;
+	double wallTime = Now() - epochStartTime;
+	double readTime = epochTime[PHASE_FORWARD_IH] + epochTime[PHASE_FORWARD_HO]
+			- epochTime[PHASE_FORWARD_IH_NEUROSIM] - epochTime[PHASE_FORWARD_HO_NEUROSIM];	// Array read without the NeuroSim cost
+	double writeTime = epochTime[PHASE_UPDATE_IH] + epochTime[PHASE_UPDATE_HO];
+	printf("[Profile] Epoch %d: %.1f images/s", epoch, epochImages / (wallTime * 1e-9));
+	if (epochCellReads > 0)
+		printf(", %.3f ns per cell read", readTime / epochCellReads);
+	if (epochCellWrites > 0)
+		printf(", %.3f ns per cell write", writeTime / epochCellWrites);
+	printf("\n");
+	for (int p=0; p<NUM_PROFILE_PHASES; p++) {
+		if (epochCount[p] == 0)
+			continue;
+		printf("[Profile]\t%-24s %10.3f ms %6.2f%%\n", phaseName[p], epochTime[p] * 1e-6, epochTime[p] / wallTime * 100);
+	}
+	if (!counterFds.empty()) {
+		uint64_t counters[3];
+		ReadCounters(counters);
+		double cycles = counters[0] - epochCounters[0];
+		double instructions = counters[1] - epochCounters[1];
+		double cacheMisses = counters[2] - epochCounters[2];
+		printf("[Profile]\tcycles=%.4e instructions=%.4e IPC=%.2f cache misses=%.4e (%.2f per image)\n", cycles, instructions,
+				cycles > 0? instructions / cycles : 0, cacheMisses, epochImages > 0? cacheMisses / epochImages : 0);
+	}
+	FlushPhases();
+	totalEpochTime += wallTime;
+	totalImages += epochImages;
+	totalCellReads += epochCellReads;
+	totalCellWrites += epochCellWrites;
+	epochImages = epochCellReads = epochCellWrites = 0;
+}
+
+void Profiler::PrintTotal() {
+	if (!enabled)
+		return;
+	FlushPhases();
+	double wallTime = Now() - startTime;
+	printf("[Profile] Total: %.3f s, %.1f training images/s\n", wallTime * 1e-9, totalEpochTime > 0? totalImages / (totalEpochTime * 1e-9) : 0);
+	for (int p=0; p<NUM_PROFILE_PHASES; p++) {
+		if (totalCount[p] == 0)
+			continue;
+		printf("[Profile]\t%-24s %10.3f s %6.2f%% %12lld calls\n", phaseName[p], totalTime[p] * 1e-9, totalTime[p] / wallTime * 100, (long long)totalCount[p]);
+	}
+}
+
+/* Chrome trace event format: complete ("X") events with timestamps in us */
+void Profiler::WriteTrace(const char *fileName) {
+	if (!enabled)
+		return;
+	FILE *fp = fopen(fileName, "w");
+	if (!fp) {
+		printf("[Profile] Error: cannot open %s\n", fileName);
+		return;
+	}
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for (int i=0; i<trace.size(); i++) {
+		fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}%s\n", phaseName[trace[i].phase], (int)getpid(),
+				(trace[i].begin - startTime) * 1e-3, (trace[i].end - trace[i].begin) * 1e-3, i + 1 < trace.size()? "," : "");
+	}
+	fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(fp);
+	printf("[Profile] %d trace events written to %s", (int)trace.size(), fileName);
+	if (numDroppedEvents > 0)
+		printf(" (%lld dropped, see profileMaxTraceEvents)", (long long)numDroppedEvents);
+	printf("\n");
+}
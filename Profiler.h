@@ -0,0 +1,128 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+#include <vector>
+
+/* Phases of Train, Validate and WeightToConductance timed by the profiler */
+enum ProfilePhase {
+	PHASE_FORWARD_IH,			// Feed forward of the layers feeding a hidden layer, including their NeuroSim read cost
+	PHASE_FORWARD_IH_NEUROSIM,	// NeuroSim read cost of the layers feeding a hidden layer
+	PHASE_FORWARD_HO,			// Feed forward of the output layer, including its NeuroSim read cost
+	PHASE_FORWARD_HO_NEUROSIM,	// NeuroSim read cost of the output layer
+	PHASE_BACKPROP,				// Backpropagation
+	PHASE_UPDATE_IH,			// Weight update of the layers feeding a hidden layer
+	PHASE_UPDATE_HO,			// Weight update of the output layer
+	PHASE_WRITE_BATCH,			// Batch writes (WriteCell and write energy) inside the weight update (thread time)
+	PHASE_NEUROSIM_WRITE,		// NeuroSim write cost inside the weight update (thread time)
+	PHASE_REFRESH,				// PCM refresh (read, Erase and ReWrite)
+	PHASE_VALIDATE,				// Validate
+	PHASE_WEIGHT_TO_CONDUCTANCE,	// WeightToConductance
+	NUM_PROFILE_PHASES
+};
+
+/* Low overhead phase timer (see PROFILE_SCOPE). Phases entered from the serial part
+ * of the code are also recorded as events for the Chrome trace (chrome://tracing),
+ * the phases marked as thread time are entered inside OpenMP loops and only summed. */
+class Profiler {
+public:
+	Profiler();
+	~Profiler();
+	void Enable(bool hardwareCounters, int maxTraceEvents);
+	static int64_t Now();	// ns
+	void Add(ProfilePhase phase, int64_t begin, int64_t end);	// Thread safe
+	void AddWork(int64_t numImages, int64_t numCellReads, int64_t numCellWrites);
+	void BeginEpoch();
+	void EndEpoch(int epoch);	// Print the throughput and phase breakdown of the epoch
+	void PrintTotal();
+	void WriteTrace(const char *fileName);
+
+	bool enabled;
+
+private:
+	struct TraceEvent {
+		int phase;
+		int64_t begin, end;
+	};
+	int64_t startTime, epochStartTime;
+	double epochTime[NUM_PROFILE_PHASES], totalTime[NUM_PROFILE_PHASES];	// ns
+	int64_t epochCount[NUM_PROFILE_PHASES], totalCount[NUM_PROFILE_PHASES];
+	int64_t epochImages, epochCellReads, epochCellWrites;
+	double totalEpochTime;
+	int64_t totalImages, totalCellReads, totalCellWrites;
+	std::vector<TraceEvent> trace;
+	int maxTraceEvents;
+	int64_t numDroppedEvents;
+	/* Hardware counters (perf_event_open), one group per OpenMP thread */
+	std::vector<int> counterFds;
+	uint64_t epochCounters[3];	// Cycles, instructions and cache misses at BeginEpoch
+	void ReadCounters(uint64_t *values);
+	void FlushPhases();
+};
+
+/* Times the enclosing scope as the given phase */
+class ProfileScope {
+public:
+	ProfileScope(Profiler& profiler, ProfilePhase phase): profiler(profiler), phase(phase) {
+		begin = profiler.enabled? Profiler::Now() : 0;
+	}
+	~ProfileScope() {
+		if (profiler.enabled)
+			profiler.Add(phase, begin, Profiler::Now());
+	}
+private:
+	Profiler& profiler;
+	ProfilePhase phase;
+	int64_t begin;
+};
+
+/* Build with -DNO_PROFILE (make PROFILE=0) to remove the profiler from the simulation loops */
+#ifdef NO_PROFILE
+#define PROFILE_SCOPE(profiler, phase)
+#define PROFILE_WORK(profiler, numImages, numCellReads, numCellWrites)
+#else
+#define PROFILE_CONCAT2(a, b)	a##b
+#define PROFILE_CONCAT(a, b)	PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(profiler, phase)	ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, phase)
+#define PROFILE_WORK(profiler, numImages, numCellReads, numCellWrites)	if ((profiler).enabled) (profiler).AddWork(numImages, numCellReads, numCellWrites)
+#endif
+
+#endif
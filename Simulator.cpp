@@ -0,0 +1,320 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <random>
+#include <vector>
+#include "Cell.h"
+#include "Array.h"
+#include "formula.h"
+#include "NeuroSim.h"
+#include "Param.h"
+#include "IO.h"
+#include "Test.h"
+#include "Config.h"
+#include "Simulator.h"
+
+Simulator::Simulator(const Param& param, const Dataset& dataset):
+						Input(dataset.Input), dInput(dataset.dInput), Output(dataset.Output),
+						testInput(dataset.testInput), dTestInput(dataset.dTestInput), testOutput(dataset.testOutput), chip(NULL) {
+	this->param = new Param(param);
+	correct = 0;
+	numValidated = 0;
+	epoch = 0;
+	bestAccuracy = -1;
+	numRoundsNoImprove = 0;
+	int numLayers = param.layerSizes.size() - 1;
+	for (int l=0; l<numLayers; l++) {
+		layers.push_back(new Layer(l, param.layerSizes[l], param.layerSizes[l+1], l == numLayers - 1, param, &gen));
+	}
+}
+
+Simulator::~Simulator() {
+	for (int l=0; l<layers.size(); l++) {
+		delete layers[l];
+	}
+	delete chip;
+	delete param;
+}
+
+/* Initialize the synaptic arrays, NeuroSim synaptic cores and neuron peripheries */
+void Simulator::Initialize() {
+	gen.seed(0);
+
+	/* Initialization of synaptic arrays (IdealDevice, RealDevice, MeasuredDevice, SRAM or DigitalNVM, see param->deviceTypeIH/HO) */
+	SetDeviceParams(param);
+	for (int l=0; l<layers.size(); l++) {
+		layers[l]->InitializeArray(param);
+	}
+	CheckUnusedDeviceParams();
+
+	/* Initialization of NeuroSim synaptic cores */
+	for (int l=0; l<layers.size(); l++) {
+		Layer *layer = layers[l];
+		NeuroSimSubArrayInitialize(layer->subArray, layer->array, layer->inputParameter, layer->tech, layer->cell, param, layer->relaxArrayCellWidth);
+	}
+	for (int l=0; l<layers.size(); l++) {
+		/* Calculate synaptic core area */
+		NeuroSimSubArrayArea(layers[l]->subArray);
+		/* Calculate synaptic core standby leakage power */
+		NeuroSimSubArrayLeakagePower(layers[l]->subArray);
+	}
+	
+	/* Initialize the neuron peripheries */
+	for (int l=0; l<layers.size(); l++) {
+		Layer *layer = layers[l];
+		NeuroSimNeuronInitialize(layer->subArray, layer->inputParameter, layer->tech, layer->cell, layer->adder, layer->mux, layer->muxDecoder, layer->dff, param);
+		layer->InitializeTileAdder();
+	}
+}
+
+/* Simulate one configuration on the dataset */
+void Simulator::Run(SimulationResult *result) {
+	Initialize();
+
+	/* Calculate the area and standby leakage power of the subarray tiles and the neuron peripheries below them */
+	std::vector<double> leakageSubArray(layers.size()), leakageNeuron(layers.size());
+	double totalSubArrayArea = 0, totalNeuronArea = 0;
+	double totalSubArrayLeakage = 0, totalNeuronLeakage = 0;
+	for (int l=0; l<layers.size(); l++) {
+		leakageSubArray[l] = layers[l]->SubArrayLeakagePower();
+		leakageNeuron[l] = layers[l]->NeuronLeakagePower();
+		totalSubArrayArea += layers[l]->SubArrayArea();
+		totalNeuronArea += layers[l]->NeuronArea();
+		totalSubArrayLeakage += leakageSubArray[l];
+		totalNeuronLeakage += leakageNeuron[l];
+	}
+	double area = totalSubArrayArea + totalNeuronArea;
+	double leakage = totalSubArrayLeakage + totalNeuronLeakage;
+	
+	/* Print the area of synaptic core and neuron peripheries */
+	printf("Total SubArray (synaptic core) area=%.4e m^2\n", totalSubArrayArea);
+	printf("Total Neuron (neuron peripheries) area=%.4e m^2\n", totalNeuronArea);
+	printf("Total area=%.4e m^2\n", area);
+
+	/* Print the standby leakage power of synaptic core and neuron peripheries */
+	for (int l=0; l<layers.size(); l++) {
+		printf("Leakage power of subArray%s is : %.4e W\n", layers[l]->name.c_str(), leakageSubArray[l]);
+	}
+	for (int l=0; l<layers.size(); l++) {
+		printf("Leakage power of Neuron%s is : %.4e W\n", layers[l]->name.c_str(), leakageNeuron[l]);
+	}
+	printf("Total leakage power of subArray is : %.4e W\n", totalSubArrayLeakage);
+	printf("Total leakage power of Neuron is : %.4e W\n", totalNeuronLeakage);
+
+	/* Place the subarrays on the chip tiles (see Chip.h) */
+	delete chip;
+	chip = NULL;
+	if (param->chipReport) {
+		chip = new Chip(layers);
+		chip->Initialize(param);
+	}
+	
+	/* Select the fixed testing subset for the approximate validation */
+	BuildValidationSubset();
+
+	if (param->profile) {
+		profiler.Enable(param->profileHardwareCounters, param->profileMaxTraceEvents);
+	}
+	if (!param->activityTraceFile.empty()) {
+		activityTrace.Open(param->activityTraceFile.c_str(), *param, layers);
+	}
+	if (!param->telemetryFile.empty()) {
+		telemetry.Open(param->telemetryFile.c_str(), *param, layers);
+	}
+
+	epoch = 0;
+	bestAccuracy = -1;
+	numRoundsNoImprove = 0;
+	if (param->resumeFile.empty()) {
+		/* Initialize weights and map weights to conductances for hardware implementation */
+		WeightInitialize();
+		if (param->useHardwareInTraining) { WeightToConductance(); }
+		rng.Seed(0);	// Pseudorandom number seed
+	} else {
+		LoadCheckpoint(param->resumeFile.c_str());
+		if (epoch % param->interNumEpochs != 0) {
+			printf("[Checkpoint] Error: %s was saved at %d epochs, which is not a multiple of interNumEpochs\n", param->resumeFile.c_str(), epoch);
+			exit(-1);
+		}
+		printf("Resumed from %s at %d epochs\n", param->resumeFile.c_str(), epoch);
+	}
+
+	history.clear();
+
+	int numValidationRounds = param->totalNumEpochs/param->interNumEpochs;
+	int stopEpoch = numValidationRounds*param->interNumEpochs;	// Last trained epoch
+	bool stoppedEarly = false;
+	for (int i=epoch/param->interNumEpochs+1; i<=numValidationRounds; i++) {
+		if (chip) { chip->BeginTraining(); }
+		Train(param->numTrainImagesPerEpoch, param->interNumEpochs);
+		if (chip) { chip->EndTraining(param->numTrainImagesPerEpoch * param->interNumEpochs); }
+		if (!param->useHardwareInTraining && param->useHardwareInTestingFF) { WeightToConductance(); }
+		epoch = i*param->interNumEpochs;
+		bool fullValidation = (i == numValidationRounds) || (param->fullValidationInterval > 0 && epoch % param->fullValidationInterval == 0);
+		Validate(!fullValidation);
+		if (numValidated == param->numMnistTestImages) {
+			printf("Accuracy at %d epochs is : %.2f%\n", epoch, (double)correct/numValidated*100);
+		} else {
+			double accLower, accUpper;
+			AccuracyConfidenceInterval(correct, numValidated, param->validationConfidenceZ, &accLower, &accUpper);
+			printf("Accuracy at %d epochs is : %.2f%% (subset of %d images, CI %.2f%%-%.2f%%)\n", epoch, (double)correct/numValidated*100, numValidated, accLower*100, accUpper*100);
+		}
+		/* Here the performance metrics of subArray also includes that of neuron peripheries (see Train.cpp and Test.cpp) */
+		SimulationResult result = CurrentResult(epoch, area, leakage);
+		printf("\tRead latency=%.4e s\n", result.readLatency);
+		printf("\tWrite latency=%.4e s\n", result.writeLatency);
+		printf("\tRead energy=%.4e J\n", result.readEnergy);
+		printf("\tWrite energy=%.4e J\n", result.writeEnergy);
+		if (param->enduranceReport) {
+			for (int l=0; l<layers.size(); l++) {
+				layers[l]->PrintEndurance();
+			}
+		}
+		if (param->costBreakdown) {
+			for (int l=0; l<layers.size(); l++) {
+				layers[l]->cost.Print(("subArray" + layers[l]->name).c_str(), layers[l]->subArray->readLatency, layers[l]->subArray->writeLatency);
+			}
+		}
+		history.push_back(result);
+		activityTrace.EndSection(epoch, (double)correct/numValidated*100, ArrayReadEnergy(), ArrayWriteEnergy());
+		telemetry.EndSection(epoch, layers);
+
+		/* Early stop on accuracy plateau or regression */
+		bool plateau = false, regression = false;
+		if (param->earlyStop) {
+			double accuracy = (double)correct/numValidated*100;
+			if (accuracy > bestAccuracy + param->earlyStopMinDelta) {
+				bestAccuracy = accuracy;
+				numRoundsNoImprove = 0;
+			} else {
+				numRoundsNoImprove++;
+			}
+			plateau = (numRoundsNoImprove >= param->earlyStopPatience);
+			regression = (bestAccuracy - accuracy > param->earlyStopMaxRegression);
+		}
+
+		/* Periodic checkpoint (see Checkpoint.h) */
+		if (!param->checkpointFile.empty() && param->checkpointInterval > 0 && epoch % param->checkpointInterval == 0) {
+			std::string checkpointFileName = param->checkpointFile;
+			size_t pos = checkpointFileName.find("%d");
+			if (pos != std::string::npos)
+				checkpointFileName.replace(pos, 2, std::to_string(epoch));
+			SaveCheckpoint(checkpointFileName.c_str());
+		}
+
+		if (param->earlyStop && i < numValidationRounds && epoch >= param->earlyStopMinEpochs && (plateau || regression)) {
+			stopEpoch = epoch;
+			stoppedEarly = true;
+			printf("Early stop at %d epochs (%s, best accuracy %.2f%%)\n", stopEpoch, plateau? "plateau" : "regression", bestAccuracy);
+			if (!fullValidation) {	// Always finish with an exact accuracy, at no cost since the subset validation of this round is already counted
+				Validate(false, false);
+				printf("Accuracy at %d epochs is : %.2f%\n", epoch, (double)correct/numValidated*100);
+				activityTrace.EndSection(epoch, (double)correct/numValidated*100, ArrayReadEnergy(), ArrayWriteEnergy());
+				telemetry.EndSection(epoch, layers);
+			}
+			break;
+		}
+	}
+	if (param->extrapolateEarlyStopCost && stoppedEarly) {
+		double scale = (double)param->totalNumEpochs / stopEpoch;
+		SimulationResult result = CurrentResult(stopEpoch, area, leakage);
+		printf("Extrapolated to %d epochs:\n", param->totalNumEpochs);
+		printf("\tRead latency=%.4e s\n", result.readLatency * scale);
+		printf("\tWrite latency=%.4e s\n", result.writeLatency * scale);
+		printf("\tRead energy=%.4e J\n", result.readEnergy * scale);
+		printf("\tWrite energy=%.4e J\n", result.writeEnergy * scale);
+	}
+
+	if (param->eventDrivenReadTiming) {
+		for (int l=0; l<layers.size(); l++) {
+			layers[l]->PrintReadTiming();
+		}
+	}
+	profiler.PrintTotal();
+	if (!param->profileTraceFile.empty()) {
+		profiler.WriteTrace(param->profileTraceFile.c_str());
+	}
+	activityTrace.Close();
+	telemetry.Close();
+	if (chip) {
+		chip->PrintReport();
+	}
+
+	*result = CurrentResult(stopEpoch, area, leakage);
+}
+
+/* Accuracy of the last validation and the cumulative latency and energy so far */
+SimulationResult Simulator::CurrentResult(int stopEpoch, double area, double leakage) {
+	SimulationResult result;
+	result.accuracy = (double)correct/numValidated*100;
+	result.stopEpoch = stopEpoch;
+	result.area = area;
+	result.leakage = leakage;
+	result.readLatency = result.writeLatency = 0;
+	result.readEnergy = result.writeEnergy = 0;
+	for (int l=0; l<layers.size(); l++) {
+		result.readLatency += layers[l]->subArray->readLatency;
+		result.writeLatency += layers[l]->subArray->writeLatency;
+		result.readEnergy += layers[l]->array->readEnergy;
+		result.readEnergy += layers[l]->subArray->readDynamicEnergy;
+		result.writeEnergy += layers[l]->array->writeEnergy;
+		result.writeEnergy += layers[l]->subArray->writeDynamicEnergy;
+	}
+	return result;
+}
+
+/* Cumulative cell level read and write energy of all the arrays (without NeuroSim) */
+double Simulator::ArrayReadEnergy() {
+	double energy = 0;
+	for (int l=0; l<layers.size(); l++) {
+		energy += layers[l]->array->readEnergy;
+	}
+	return energy;
+}
+
+double Simulator::ArrayWriteEnergy() {
+	double energy = 0;
+	for (int l=0; l<layers.size(); l++) {
+		energy += layers[l]->array->writeEnergy;
+	}
+	return energy;
+}
@@ -0,0 +1,129 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include <random>
+#include <vector>
+#include "formula.h"
+#include "Param.h"
+#include "Array.h"
+#include "NeuroSim.h"
+#include "Layer.h"
+#include "IO.h"
+#include "Profiler.h"
+#include "ActivityTrace.h"
+#include "Telemetry.h"
+#include "Chip.h"
+
+/* Summary of one simulation run */
+struct SimulationResult {
+	double accuracy;	// Final accuracy (%)
+	int stopEpoch;		// Last trained epoch
+	double area;		// Total area (m^2)
+	double leakage;		// Total standby leakage power (W)
+	double readLatency, writeLatency;	// Cumulative latency (s)
+	double readEnergy, writeEnergy;		// Cumulative energy (J)
+};
+
+/* One MLP simulator instance: the network, its synaptic arrays and NeuroSim cores.
+ * Everything the simulation mutates is owned here, so independent instances can
+ * run in the same process (e.g. one per thread); only the Dataset is shared. */
+class Simulator {
+public:
+	Simulator(const Param& param, const Dataset& dataset);
+	~Simulator();
+
+	void Initialize();	// Arrays and NeuroSim cores
+	void Run(SimulationResult *result);	// Initialize, then train and validate for param->totalNumEpochs
+	void Train(const int numTrain, const int epochs);	// See Train.cpp
+	void Validate(bool useSubset=false, bool countCost=true);	// See Test.cpp
+	void BuildValidationSubset();
+	void WeightInitialize();	// See Mapping.cpp
+	void WeightToConductance();
+	int CurrentToDigits(double I, double Imax);
+	double DigitsToAlgorithm(int outputDigits, double pSumMaxAlgorithm);
+	void PackInput(const Layer *layer, const int *input, std::vector<uint64_t> *inputMask);	// See Train.cpp
+	double ReadColumn(Layer *layer, int j, const int *input, const uint64_t *inputMask, double *arrayReadEnergy);
+	void NeuroSimRead(Layer *layer, const int *input, double *readEnergy, double *readLatency, double traceWeight, CostBreakdown *cost);
+	void PrintWeightToFile(const char *str);	// See IO.cpp
+	void SaveCheckpoint(const char *fileName);	// See Checkpoint.cpp
+	void LoadCheckpoint(const char *fileName);
+
+	Param *param;	// Parameter set (private copy)
+
+	/* Dataset (shared, read-only) */
+	const std::vector< std::vector<double> >& Input;	// Inputs of training set
+	const std::vector< std::vector<int> >& dInput;		// Digitized inputs of training set
+	const std::vector< std::vector<double> >& Output;	// Outputs of training set
+	const std::vector< std::vector<double> >& testInput;	// Inputs of testing set
+	const std::vector< std::vector<int> >& dTestInput;	// Digitized inputs of testing set
+	const std::vector< std::vector<double> >& testOutput;	// Outputs of testing set
+
+	std::vector<Layer*> layers;	// Layers from the input side, each with its weights, synaptic array and NeuroSim core (see Layer.h)
+
+	int correct;		// # of correct prediction
+	int numValidated;	// # of testing images evaluated in the last validation
+	std::vector<int> validationSubset;	// Indices of the testing images in the stratified validation subset
+	int epoch;			// # of trained epochs
+	double bestAccuracy;	// Best accuracy (%) so far for the early stop
+	int numRoundsNoImprove;	// # of validations since the last improvement
+	std::vector<SimulationResult> history;	// Result after every validation of Run (stopEpoch is the validated epoch)
+
+	std::mt19937 gen;	// Random number engine of the devices (read noise and cycle-to-cycle variation)
+	RandomGenerator rng;	// Random numbers of the weight initialization and the training sample order
+	Profiler profiler;	// Phase timer (param->profile)
+	ActivityTrace activityTrace;	// NeuroSim activity for ./replay (param->activityTraceFile)
+	Telemetry telemetry;	// Device state of the layers (param->telemetryFile)
+	Chip *chip;		// Chip-level model of the run (param->chipReport, NULL otherwise)
+
+private:
+	void UpdateWeightHardware(Layer *layer, const double *input, const double *s);	// See Train.cpp
+	void UpdateWeightAlgorithm(Layer *layer, const double *input, const double *s);
+	void RefreshSelect(Layer *layer, int batchNum, std::mt19937& refreshGen);
+	void RefreshErase(Layer *layer);
+	void RefreshReWrite(Layer *layer);
+	SimulationResult CurrentResult(int stopEpoch, double area, double leakage);
+	double ArrayReadEnergy();
+	double ArrayWriteEnergy();
+	Simulator(const Simulator&);	// Not copyable (owns the layers)
+	Simulator& operator=(const Simulator&);
+};
+
+#endif
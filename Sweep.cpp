@@ -0,0 +1,220 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <omp.h>
+#include "Param.h"
+#include "Config.h"
+#include "IO.h"
+#include "Simulator.h"
+#include "Sweep.h"
+
+/* A configuration running in a child process */
+struct SweepJob {
+	pid_t pid;
+	int config;	// Index of the configuration in the sweep file
+	int slot;	// Core partition used by the child
+	int fd;		// Read end of the result pipe
+};
+
+/* Read the configurations, one per line (empty lines and # comments are skipped) */
+std::vector<std::string> ReadSweepFile(const char *sweepFileName) {
+	std::ifstream file(sweepFileName);
+	if (!file) {
+		std::cout << sweepFileName << " cannot be found!\n";
+		exit(-1);
+	}
+	std::vector<std::string> configs;
+	std::string line;
+	while (std::getline(file, line)) {
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+		if (line.find_first_not_of(" \t\r\n") == std::string::npos)
+			continue;
+		configs.push_back(line);
+	}
+	return configs;
+}
+
+/* Child process: apply the configuration on top of the parent's Param, simulate and send back the result */
+static void RunConfiguration(const std::string& config, int index, int slot, int numJobs, int fd, const char *logPrefix, const Param& baseParam, const Dataset& dataset) {
+	char logFileName[256];
+	snprintf(logFileName, sizeof(logFileName), "%s_%d.log", logPrefix, index);
+	if (!freopen(logFileName, "w", stdout)) {
+		printf("[Sweep] Error: cannot open %s\n", logFileName);
+		exit(-1);
+	}
+
+	/* Pin the child to its own partition of the cores */
+	int numCores = sysconf(_SC_NPROCESSORS_ONLN);
+	int numCoresPerJob = numCores / numJobs;
+	if (numCoresPerJob < 1)
+		numCoresPerJob = 1;
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	for (int c=0; c<numCoresPerJob; c++) {
+		CPU_SET((slot * numCoresPerJob + c) % numCores, &cpuSet);
+	}
+	sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+	omp_set_num_threads(numCoresPerJob);
+
+	/* The dataset is already loaded, so the parameters it depends on must not change */
+	Param param = baseParam;
+	std::istringstream args(config);
+	std::string arg;
+	while (args >> arg) {
+		ApplyArgument(&param, arg);
+	}
+	const Param *datasetParam = dataset.param;
+	if (param.numMnistTrainImages != datasetParam->numMnistTrainImages || param.numMnistTestImages != datasetParam->numMnistTestImages
+			|| param.nInput != datasetParam->nInput || param.nOutput != datasetParam->nOutput
+			|| param.numBitInput != datasetParam->numBitInput || param.BWthreshold != datasetParam->BWthreshold) {
+		puts("[Sweep] Error: the dataset parameters cannot be changed in a sweep configuration");
+		exit(-1);
+	}
+	printf("Configuration %d: %s\n", index, config.c_str());
+
+	SimulationResult result;
+	Simulator *simulator = new Simulator(param, dataset);
+	simulator->Run(&result);
+	delete simulator;
+	fflush(stdout);
+	if (write(fd, &result, sizeof(result)) != sizeof(result))
+		exit(-1);
+	exit(0);
+}
+
+void RunConfigurations(const std::vector<std::string>& configs, int numJobs, const char *logPrefix, const Param& param, const Dataset& dataset,
+		std::vector<SimulationResult> *results, std::vector<bool> *succeeded) {
+	int numConfigs = configs.size();
+	if (numJobs < 1)
+		numJobs = 1;
+
+	results->assign(numConfigs, SimulationResult());
+	succeeded->assign(numConfigs, false);
+	std::vector<bool> slotUsed(numJobs, false);
+	std::vector<SweepJob> running;
+	int next = 0;
+
+	/* Work queue: keep numJobs children busy until every configuration is done.
+	 * Fork only from the serial part of the parent (no OpenMP region has run yet). */
+	while (next < numConfigs || !running.empty()) {
+		while (next < numConfigs && (int)running.size() < numJobs) {
+			int slot = 0;
+			while (slotUsed[slot])
+				slot++;
+			int fds[2];
+			if (pipe(fds) != 0) {
+				puts("[Sweep] Error: cannot create pipe");
+				exit(-1);
+			}
+			fflush(stdout);
+			pid_t pid = fork();
+			if (pid < 0) {
+				puts("[Sweep] Error: fork failed");
+				exit(-1);
+			}
+			if (pid == 0) {
+				close(fds[0]);
+				RunConfiguration(configs[next], next, slot, numJobs, fds[1], logPrefix, param, dataset);
+			}
+			close(fds[1]);
+			SweepJob job = {pid, next, slot, fds[0]};
+			running.push_back(job);
+			slotUsed[slot] = true;
+			printf("[Sweep] Started configuration %d: %s\n", next, configs[next].c_str());
+			next++;
+		}
+
+		int status;
+		pid_t pid = wait(&status);
+		if (pid < 0)
+			break;
+		for (int i=0; i<running.size(); i++) {
+			if (running[i].pid != pid)
+				continue;
+			SweepJob job = running[i];
+			if (WIFEXITED(status) && WEXITSTATUS(status) == 0
+					&& read(job.fd, &(*results)[job.config], sizeof(SimulationResult)) == sizeof(SimulationResult)) {
+				(*succeeded)[job.config] = true;
+			}
+			close(job.fd);
+			slotUsed[job.slot] = false;
+			running.erase(running.begin() + i);
+			printf("[Sweep] Configuration %d %s\n", job.config, (*succeeded)[job.config]? "finished" : "failed (see its log)");
+			break;
+		}
+	}
+}
+
+void RunSweep(const char *sweepFileName, int numJobs, const char *outputFileName, const Param& param, const Dataset& dataset) {
+	std::vector<std::string> configs = ReadSweepFile(sweepFileName);
+	int numConfigs = configs.size();
+	std::vector<SimulationResult> results;
+	std::vector<bool> succeeded;
+	RunConfigurations(configs, numJobs, "sweep", param, dataset, &results, &succeeded);
+
+	/* Consolidated result table (tab separated, in the order of the sweep file) */
+	FILE *fp = fopen(outputFileName, "w");
+	if (!fp) {
+		printf("[Sweep] Error: cannot open %s\n", outputFileName);
+		exit(-1);
+	}
+	fprintf(fp, "id\tstatus\taccuracy(%%)\tstopEpoch\tarea(m^2)\tleakage(W)\treadLatency(s)\twriteLatency(s)\treadEnergy(J)\twriteEnergy(J)\tconfiguration\n");
+	for (int i=0; i<numConfigs; i++) {
+		if (succeeded[i]) {
+			fprintf(fp, "%d\tok\t%.2f\t%d\t%.4e\t%.4e\t%.4e\t%.4e\t%.4e\t%.4e\t%s\n", i, results[i].accuracy, results[i].stopEpoch, results[i].area,
+					results[i].leakage, results[i].readLatency, results[i].writeLatency, results[i].readEnergy, results[i].writeEnergy, configs[i].c_str());
+		} else {
+			fprintf(fp, "%d\tfailed\t\t\t\t\t\t\t\t\t%s\n", i, configs[i].c_str());
+		}
+	}
+	fclose(fp);
+	printf("[Sweep] %d configurations written to %s\n", numConfigs, outputFileName);
+}
@@ -36,10 +36,29 @@
 *   Xiaochen Peng   Email: xpeng15 at asu dot edu
 ********************************************************************************/
 
-#ifndef TRAIN_H_
-#define TRAIN_H_
+#ifndef SWEEP_H_
+#define SWEEP_H_
 
-void Train(const int numTrain, const int epochs);
+#include <string>
+#include <vector>
+#include "Param.h"
+#include "IO.h"
+#include "Simulator.h"
 
-#endif
+/* Configurations of a sweep file, one per line (empty lines and # comments are skipped) */
+std::vector<std::string> ReadSweepFile(const char *sweepFileName);
+
+/* Run the configurations (config files and key=value overrides, applied on top of param)
+ * in at most numJobs concurrent child processes, each logging to <logPrefix>_<index>.log.
+ * (*results)[i] is valid if (*succeeded)[i], a child that exits early has failed. */
+void RunConfigurations(const std::vector<std::string>& configs, int numJobs, const char *logPrefix, const Param& param, const Dataset& dataset,
+		std::vector<SimulationResult> *results, std::vector<bool> *succeeded);
 
+/* Run every configuration in sweepFileName (one line of config files and key=value
+ * overrides per configuration) with at most numJobs concurrent child processes.
+ * Each configuration is applied on top of param and simulated by its own Simulator.
+ * The children are forked after the dataset is loaded, so the dataset pages are
+ * shared read-only instead of being reparsed per configuration. */
+void RunSweep(const char *sweepFileName, int numJobs, const char *outputFileName, const Param& param, const Dataset& dataset);
+
+#endif
@@ -0,0 +1,239 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Param.h"
+#include "Cell.h"
+#include "Array.h"
+#include "Layer.h"
+#include "Telemetry.h"
+
+void Histogram::Reset(double low, double high, int numBins) {
+	this->low = low;
+	this->high = high;
+	counts.assign(numBins, 0);
+	numBelow = numAbove = 0;
+}
+
+void Histogram::Add(double x) {
+	if (x < low) {
+		numBelow++;
+		return;
+	}
+	if (x > high) {
+		numAbove++;
+		return;
+	}
+	int numBins = counts.size();
+	int bin = std::min((int)((x - low) / (high - low) * numBins), numBins - 1);
+	/* Compare with the exact bin edges, the division may round across them */
+	while (bin > 0 && x < Edge(bin))
+		bin--;
+	while (bin < numBins - 1 && x >= Edge(bin + 1))
+		bin++;
+	counts[bin]++;
+}
+
+void Histogram::Merge(const Histogram& other) {
+	for (int b=0; b<counts.size(); b++) {
+		counts[b] += other.counts[b];
+	}
+	numBelow += other.numBelow;
+	numAbove += other.numAbove;
+}
+
+void Histogram::Write(FILE *fp, const char *name) const {
+	fprintf(fp, "\"%s\":{\"low\":%.6e,\"high\":%.6e,\"below\":%lld,\"above\":%lld,\"counts\":[", name, low, high, (long long)numBelow, (long long)numAbove);
+	for (int b=0; b<counts.size(); b++) {
+		fprintf(fp, "%s%lld", b? "," : "", (long long)counts[b]);
+	}
+	fprintf(fp, "]}");
+}
+
+void WeightHistogram(const Layer *layer, double low, double high, int numBins, Histogram *histogram) {
+	histogram->Reset(low, high, numBins);
+	#pragma omp parallel
+	{
+		Histogram threadHistogram;
+		threadHistogram.Reset(low, high, numBins);
+		#pragma omp for nowait
+		for (int j=0; j<layer->numOutput; j++) {
+			for (int k=0; k<layer->numInput; k++) {
+				threadHistogram.Add(layer->weight[j][k]);
+			}
+		}
+		#pragma omp critical
+		histogram->Merge(threadHistogram);
+	}
+}
+
+Telemetry::Telemetry() {
+	fp = NULL;
+	numBins = 0;
+	minWeight = maxWeight = 0;
+}
+
+Telemetry::~Telemetry() {
+	Close();
+}
+
+void Telemetry::Open(const char *fileName, const Param& param, const std::vector<Layer*>& layers) {
+	Close();
+	fp = fopen(fileName, "w");
+	if (!fp) {
+		printf("[Telemetry] Error: cannot open %s\n", fileName);
+		exit(-1);
+	}
+	numBins = param.telemetryNumBins;
+	minWeight = param.minWeight;
+	maxWeight = param.maxWeight;
+	activity.assign(layers.size(), LayerActivity());
+	for (int l=0; l<layers.size(); l++) {
+		if (AnalogNVM *cell = dynamic_cast<AnalogNVM*>(layers[l]->array->cell[0][0])) {	// One bin per pulse count
+			activity[l].writePulses.Reset(-cell->maxNumLevelLTD - 0.5, cell->maxNumLevelLTP + 0.5, cell->maxNumLevelLTD + cell->maxNumLevelLTP + 1);
+		}
+		activity[l].numConversions = activity[l].numClipped = 0;
+	}
+}
+
+void Telemetry::AddWritePulses(int layer, const Array *array, int k, int colStart, int colEnd) {
+	Histogram& writePulses = activity[layer].writePulses;
+	for (int j=colStart; j<colEnd; j++) {
+		writePulses.Add(static_cast<AnalogNVM*>(array->cell[j][k])->numPulse);
+	}
+}
+
+void Telemetry::AddConversions(int layer, int numConversions, int numClipped) {
+	#pragma omp atomic
+	activity[layer].numConversions += numConversions;
+	if (numClipped) {
+		#pragma omp atomic
+		activity[layer].numClipped += numClipped;
+	}
+}
+
+/* Conductance state of the cells of one layer */
+struct CellState {
+	Histogram conductance, conductanceGp, conductanceGn;
+	int64_t numAtMax, numAtMin;		// Cells (either device of a PCM pair) at their maxConductance, at minConductance (both devices)
+	int64_t numAboveThr;	// PCM pairs with Gp or Gn above ThrConductance (the threshold refresh)
+
+	CellState(AnalogNVM *cell, int numBins): numAtMax(0), numAtMin(0), numAboveThr(0) {
+		conductance.Reset(cell->GetMinReadCurrent() / cell->readVoltage, cell->GetMaxReadCurrent() / cell->readVoltage, numBins);
+		if (cell->PCMON) {
+			conductanceGp.Reset(cell->avgMinConductance, cell->avgMaxConductance, numBins);
+			conductanceGn.Reset(cell->avgMinConductance, cell->avgMaxConductance, numBins);
+		}
+	}
+	void Add(const AnalogNVM *cell) {
+		conductance.Add(cell->conductance);
+		if (cell->PCMON) {
+			conductanceGp.Add(cell->conductanceGp);
+			conductanceGn.Add(cell->conductanceGn);
+			numAtMax += cell->conductanceGp >= cell->maxConductance || cell->conductanceGn >= cell->maxConductance;
+			numAtMin += cell->conductanceGp <= cell->minConductance && cell->conductanceGn <= cell->minConductance;
+			numAboveThr += cell->conductanceGp > cell->ThrConductance || cell->conductanceGn > cell->ThrConductance;
+		} else {
+			numAtMax += cell->conductance >= cell->maxConductance;
+			numAtMin += cell->conductance <= cell->minConductance;
+		}
+	}
+	void Merge(const CellState& other) {
+		conductance.Merge(other.conductance);
+		conductanceGp.Merge(other.conductanceGp);
+		conductanceGn.Merge(other.conductanceGn);
+		numAtMax += other.numAtMax;
+		numAtMin += other.numAtMin;
+		numAboveThr += other.numAboveThr;
+	}
+};
+
+void Telemetry::EndSection(int epoch, const std::vector<Layer*>& layers) {
+	if (!fp)
+		return;
+	for (int l=0; l<layers.size(); l++) {
+		const Layer *layer = layers[l];
+		Histogram weight;
+		WeightHistogram(layer, minWeight, maxWeight, numBins, &weight);
+		fprintf(fp, "{\"epoch\":%d,\"layer\":\"%s\",", epoch, layer->name.c_str());
+		weight.Write(fp, "weight");
+		if (AnalogNVM *cell0 = dynamic_cast<AnalogNVM*>(layer->array->cell[0][0])) {	// Analog eNVM
+			CellState state(cell0, numBins);
+			#pragma omp parallel
+			{
+				CellState threadState(cell0, numBins);
+				#pragma omp for nowait
+				for (int j=0; j<layer->numOutput; j++) {
+					for (int k=0; k<layer->numInput; k++) {
+						threadState.Add(static_cast<AnalogNVM*>(layer->array->cell[j][k]));
+					}
+				}
+				#pragma omp critical
+				state.Merge(threadState);
+			}
+			fprintf(fp, ",");
+			state.conductance.Write(fp, "conductance");
+			if (cell0->PCMON) {
+				fprintf(fp, ",");
+				state.conductanceGp.Write(fp, "conductanceGp");
+				fprintf(fp, ",");
+				state.conductanceGn.Write(fp, "conductanceGn");
+				fprintf(fp, ",\"aboveThrConductance\":%lld", (long long)state.numAboveThr);
+			}
+			fprintf(fp, ",\"atMaxConductance\":%lld,\"atMinConductance\":%lld,", (long long)state.numAtMax, (long long)state.numAtMin);
+			activity[l].writePulses.Write(fp, "writePulses");
+			fprintf(fp, ",\"adcConversions\":%lld,\"adcClipped\":%lld", (long long)activity[l].numConversions, (long long)activity[l].numClipped);
+		}
+		fprintf(fp, "}\n");
+		Histogram& writePulses = activity[l].writePulses;
+		writePulses.Reset(writePulses.low, writePulses.high, writePulses.counts.size());
+		activity[l].numConversions = activity[l].numClipped = 0;
+	}
+	fflush(fp);
+}
+
+void Telemetry::Close() {
+	if (fp) {
+		fclose(fp);
+		fp = NULL;
+	}
+}
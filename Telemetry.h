@@ -0,0 +1,102 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include <stdint.h>
+#include <cstdio>
+#include <vector>
+
+class Param;
+class Array;
+class Layer;
+
+/* Histogram of numBins equal bins over [low, high], the last bin includes high */
+struct Histogram {
+	double low, high;
+	std::vector<int64_t> counts;
+	int64_t numBelow, numAbove;		// Values outside [low, high]
+
+	Histogram(): low(0), high(0), numBelow(0), numAbove(0) {}
+	void Reset(double low, double high, int numBins);
+	double Edge(int bin) const { return low + (high - low) * bin / counts.size(); }
+	void Add(double x);
+	void Merge(const Histogram& other);
+	void Write(FILE *fp, const char *name) const;	// JSON member "name":{...}
+};
+
+/* Device state telemetry (param->telemetryFile): at every validation of Simulator::Run one JSON
+ * object per layer and line with the histograms of the weights and the cell conductances (Gp and Gn
+ * for PCM), the cells saturated against maxConductance/minConductance and above ThrConductance,
+ * and since the previous validation the distribution of the write pulses per cell write and the
+ * ADC conversions of ReadColumn that hit pSumMaxHardware. Every call is a no-op unless Open succeeded. */
+class Telemetry {
+public:
+	Telemetry();
+	~Telemetry();
+	void Open(const char *fileName, const Param& param, const std::vector<Layer*>& layers);
+	/* Pulses of the cells of row k from colStart to colEnd after a batch write, called inside the
+	 * critical section of the weight update */
+	void WritePulses(int layer, const Array *array, int k, int colStart, int colEnd) {
+		if (fp) AddWritePulses(layer, array, k, colStart, colEnd);
+	}
+	/* ADC conversions of a column read, thread safe */
+	void Conversions(int layer, int numConversions, int numClipped) {
+		if (fp) AddConversions(layer, numConversions, numClipped);
+	}
+	void EndSection(int epoch, const std::vector<Layer*>& layers);	// Write the state of every layer and restart the activity
+	void Close();
+
+private:
+	struct LayerActivity {
+		Histogram writePulses;	// numPulse of every selected cell of the batch writes (LTD < 0)
+		int64_t numConversions, numClipped;
+	};
+	void AddWritePulses(int layer, const Array *array, int k, int colStart, int colEnd);
+	void AddConversions(int layer, int numConversions, int numClipped);
+	FILE *fp;
+	int numBins;
+	double minWeight, maxWeight;	// Range of the weight histogram
+	std::vector<LayerActivity> activity;
+};
+
+/* Parallel histogram of the weights of the layer over [low, high] */
+void WeightHistogram(const Layer *layer, double low, double high, int numBins, Histogram *histogram);
+
+#endif
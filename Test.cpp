@@ -37,295 +37,183 @@
 ********************************************************************************/
 
 #include <cstdio>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <random>
+#include <algorithm>
 #include "formula.h"
 #include "Param.h"
 #include "Array.h"
-#include "Mapping.h"
 #include "NeuroSim.h"
+#include "Simulator.h"
+#include "Test.h"
+#include "Telemetry.h"
 
-extern Param *param;
+/* Select a fixed, label-stratified random subset of the testing set for the approximate validation */
+void Simulator::BuildValidationSubset() {
+	validationSubset.clear();
+	int numSubset = param->numValidationSubset;
+	if (numSubset <= 0 || numSubset >= param->numMnistTestImages)
+		return;
 
-extern std::vector< std::vector<double> > testInput;
-extern std::vector< std::vector<int> > dTestInput;
-extern std::vector< std::vector<double> > testOutput;
-
-extern std::vector< std::vector<double> > weight1;
-extern std::vector< std::vector<double> > weight2;
+	/* Group the testing images by their labels */
+	std::vector< std::vector<int> > imagesOfLabel(param->nOutput);
+	for (int i=0; i<param->numMnistTestImages; i++) {
+		int label = 0;
+		for (int j=0; j<param->nOutput; j++) {
+			if (testOutput[i][j] == 1) {
+				label = j;
+				break;
+			}
+		}
+		imagesOfLabel[label].push_back(i);
+	}
 
-extern Technology techIH;
-extern Technology techHO;
-extern Array *arrayIH;
-extern Array *arrayHO;
-extern SubArray *subArrayIH;
-extern SubArray *subArrayHO;
-extern Adder adderIH;
-extern Mux muxIH;
-extern RowDecoder muxDecoderIH;
-extern DFF dffIH;
-extern Adder adderHO;
-extern Mux muxHO;
-extern RowDecoder muxDecoderHO;
-extern DFF dffHO;
+	/* Use a separate engine so that the subset does not disturb the random sequence of training */
+	std::mt19937 subsetGen(param->validationSubsetSeed);
+	int numAssigned = 0;
+	std::vector<int> numPerLabel(param->nOutput);
+	std::vector<double> remainder(param->nOutput);
+	for (int j=0; j<param->nOutput; j++) {
+		double quota = (double)imagesOfLabel[j].size() * numSubset / param->numMnistTestImages;
+		numPerLabel[j] = (int)quota;
+		remainder[j] = quota - numPerLabel[j];
+		numAssigned += numPerLabel[j];
+	}
+	while (numAssigned < numSubset) {	// Give the rounding leftovers to the labels with the largest remainders
+		int jMax = std::max_element(remainder.begin(), remainder.end()) - remainder.begin();
+		numPerLabel[jMax]++;
+		remainder[jMax] = -1;
+		numAssigned++;
+	}
+	for (int j=0; j<param->nOutput; j++) {
+		std::shuffle(imagesOfLabel[j].begin(), imagesOfLabel[j].end(), subsetGen);
+		numPerLabel[j] = std::min(numPerLabel[j], (int)imagesOfLabel[j].size());
+		validationSubset.insert(validationSubset.end(), imagesOfLabel[j].begin(), imagesOfLabel[j].begin() + numPerLabel[j]);
+	}
+	std::sort(validationSubset.begin(), validationSubset.end());	// Keep the original image order for memory locality
+}
 
-extern int correct;		// # of correct prediction
+/* Wilson score interval of the accuracy measured on numTotal images */
+void AccuracyConfidenceInterval(int numCorrect, int numTotal, double z, double *lower, double *upper) {
+	if (numTotal <= 0) {
+		*lower = *upper = 0;
+		return;
+	}
+	double p = (double)numCorrect / numTotal;
+	double denom = 1 + z * z / numTotal;
+	double center = (p + z * z / (2 * numTotal)) / denom;
+	double halfWidth = z * sqrt(p * (1 - p) / numTotal + z * z / (4.0 * numTotal * numTotal)) / denom;
+	*lower = std::max(0.0, center - halfWidth);
+	*upper = std::min(1.0, center + halfWidth);
+}
 
-/* Validation */
-void Validate() {
-	int numBatchReadSynapse;    // # of read synapses in a batch read operation (decide later)
-	double outN1[param->nHide]; // Net input to the hidden layer [param->nHide]
-	double a1[param->nHide];    // Net output of hidden layer [param->nHide] also the input of hidden layer to output layer
-	int da1[param->nHide];  // Digitized net output of hidden layer [param->nHide] also the input of hidden layer to output layer
-	double outN2[param->nOutput];   // Net input to the output layer [param->nOutput]
-	double a2[param->nOutput];  // Net output of output layer [param->nOutput]
-	double tempMax;
-	int countNum;
-	correct = 0;
-	int countOutn2[10];
-	double sumArrayReadEnergyIH = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-	double sumNeuroSimReadEnergyIH = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-	double sumReadLatencyIH = 0;    // Use a temporary variable here since OpenMP does not support reduction on class member
-	double readVoltageIH = static_cast<eNVM*>(arrayIH->cell[0][0])->readVoltage;
-	double readPulseWidthIH = static_cast<eNVM*>(arrayIH->cell[0][0])->readPulseWidth;
-	double sumArrayReadEnergyHO = 0;    // Use a temporary variable here since OpenMP does not support reduction on class member
-	double sumNeuroSimReadEnergyHO = 0; // Use a temporary variable here since OpenMP does not support reduction on class member
-	double sumReadLatencyHO = 0;    // Use a temporary variable here since OpenMP does not support reduction on class member
-	double readVoltageHO = static_cast<eNVM*>(arrayHO->cell[0][0])->readVoltage;
-	double readPulseWidthHO = static_cast<eNVM*>(arrayHO->cell[0][0])->readPulseWidth;
-	std::fill_n(countOutn2, 10, 0);
-	#pragma omp parallel for private(outN1, a1, da1, outN2, a2, tempMax, countNum, numBatchReadSynapse) reduction(+: correct, sumArrayReadEnergyIH, sumNeuroSimReadEnergyIH, sumArrayReadEnergyHO, sumNeuroSimReadEnergyHO, sumReadLatencyIH, sumReadLatencyHO)
-	for (int i = 0; i < param->numMnistTestImages; i++)
+/* Validation (on the full testing set, or on the validation subset if useSubset is true). With countCost false
+ * the read cost is neither added to the totals nor traced (e.g. a repeated validation for the exact accuracy). */
+void Simulator::Validate(bool useSubset, bool countCost) {
+	PROFILE_SCOPE(profiler, PHASE_VALIDATE);
+	int numLayers = layers.size();
+	int numCorrect = 0;	// Use a temporary variable here since OpenMP does not support reduction on class member
+	/* Read cost of every layer. Use temporary variables here since OpenMP does not support reduction on class member */
+	std::vector<double> sumArrayReadEnergy(numLayers, 0);
+	std::vector<double> sumNeuroSimReadEnergy(numLayers, 0);
+	std::vector<double> sumReadLatency(numLayers, 0);
+	std::vector<CostBreakdown> sumCost(numLayers);
+	if (validationSubset.empty())
+		useSubset = false;
+	int numTestImages = useSubset? (int)validationSubset.size() : param->numMnistTestImages;
+	double scale = (double)param->numMnistTestImages / numTestImages;	// Scale of the subset cost up to the full testing set
+	double traceWeight = (param->useHardwareInTraining || !countCost)? 0 : scale;	// Only the offline classification is traced
+	#pragma omp parallel
 	{
-		// Forward propagation
-		/* First layer from input layer to the hidden layer */
-		std::fill_n(outN1, param->nHide, 0);
-		std::fill_n(a1, param->nHide, 0);
-		if (param->useHardwareInTestingFF) {    // Hardware
-			for (int j=0; j<param->nHide; j++) {
-				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-					if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-						sumArrayReadEnergyIH += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * param->nInput; // All WLs open
-					}
-				} else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayIH->cell[0][0])) { // Digital eNVM
-					if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-						sumArrayReadEnergyIH += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd;  // Selected WL
-					} else {    // Cross-point
-						sumArrayReadEnergyIH += arrayIH->wireCapRow * techIH.vdd * techIH.vdd * (param->nInput - 1);    // Unselected WLs
-					}
-				}
-				for (int n=0; n<param->numBitInput; n++) {
-					double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1) * arrayIH->arrayRowSize;   // Max algorithm partial weighted sum for the nth vector bit (if both max input value and max weight are 1)
-					if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-						double Isum = 0;    // weighted sum current
-						double IsumMax = 0; // Max weighted sum current
-						double inputSum = 0;    // Weighted sum current of input vector * weight=1 column
-						for (int k=0; k<param->nInput; k++) {
-							if ((dTestInput[i][k]>>n) & 1) {    // if the nth bit of dTestInput[i][k] is 1
-								Isum += arrayIH->ReadCell(j,k);
-								inputSum += arrayIH->GetMaxCellReadCurrent(j,k);
-								sumArrayReadEnergyIH += arrayIH->wireCapRow * readVoltageIH * readVoltageIH;   // Selected BLs (1T1R) or Selected WLs (cross-point)
-							}
-							IsumMax += arrayIH->GetMaxCellReadCurrent(j,k);
-						}
-						sumArrayReadEnergyIH += Isum * readVoltageIH * readPulseWidthIH;
-						int outputDigits = 2 * CurrentToDigits(Isum, IsumMax) - CurrentToDigits(inputSum, IsumMax);
-						outN1[j] += DigitsToAlgorithm(outputDigits, pSumMaxAlgorithm);
-					} else {    // SRAM or digital eNVM
-						int Dsum = 0;
-						int DsumMax = 0;
-						int inputSum = 0;
-						for (int k=0; k<param->nInput; k++) {
-							if ((dTestInput[i][k]>>n) & 1) {    // if the nth bit of dTestInput[i][k] is 1
-								Dsum += (int)(arrayIH->ReadCell(j,k));
-								inputSum += pow(2, arrayIH->numCellPerSynapse) - 1;
-							}
-							DsumMax += pow(2, arrayIH->numCellPerSynapse) - 1;
-						}
-						if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayIH->cell[0][0])) {    // Digital eNVM
-							sumArrayReadEnergyIH += static_cast<DigitalNVM*>(arrayIH->cell[0][0])->readEnergy * arrayIH->numCellPerSynapse * arrayIH->arrayRowSize;
-						} else {
-							sumArrayReadEnergyIH += static_cast<SRAM*>(arrayIH->cell[0][0])->readEnergy * arrayIH->numCellPerSynapse * arrayIH->arrayRowSize;
+		std::vector< std::vector<double> > a(numLayers);	// Net output of every layer, also the input of the next layer
+		std::vector< std::vector<int> > da(numLayers);		// Digitized net output of every hidden layer, also the input of the next layer
+		for (int l=0; l<numLayers; l++) {
+			a[l].resize(layers[l]->numOutput);
+			da[l].resize(layers[l]->numOutput);
+		}
+		/* Read cost of the images of this thread */
+		std::vector<CostBreakdown> threadCost(numLayers);	// Array read energy and NeuroSim modules per component
+		std::vector<uint64_t> inputMask;	// Packed digitized input of the layer, see PackInput
+		std::vector<double> threadNeuroSimReadEnergy(numLayers, 0);
+		std::vector<double> threadReadLatency(numLayers, 0);
+		#pragma omp for reduction(+: numCorrect)
+		for (int s = 0; s < numTestImages; s++)
+		{
+			int i = useSubset? validationSubset[s] : s;	// Index of the testing image
+			// Forward propagation
+			for (int l=0; l<numLayers; l++) {
+				Layer *layer = layers[l];
+				if (param->useHardwareInTestingFF) {    // Hardware
+					const int *input = l? &da[l-1][0] : &dTestInput[i][0];
+					PackInput(layer, input, &inputMask);
+					for (int j=0; j<layer->numOutput; j++) {
+						a[l][j] = sigmoid(ReadColumn(layer, j, input, &inputMask[0], threadCost[l].readEnergy));
+						if (!layer->output) {
+							da[l][j] = round_th(a[l][j]*(param->numInputLevel-1), param->Hthreshold);
 						}
-						outN1[j] += (double)(2 * Dsum - inputSum) / DsumMax * pSumMaxAlgorithm;
 					}
-				}
-				a1[j] = sigmoid(outN1[j]);
-				//da1[j] = round(a1[j] * (param->numInputLevel - 1));
-				da1[j] = round_th(a1[j]*(param->numInputLevel-1), param->Hthreshold);
-			}
-
-			numBatchReadSynapse = (int)ceil((double)param->nHide/param->numColMuxed);
-			#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-			for (int j=0; j<param->nHide; j+=numBatchReadSynapse) {
-				int numActiveRows = 0;  // Number of selected rows for NeuroSim
-				for (int n=0; n<param->numBitInput; n++) {
-					for (int k=0; k<param->nInput; k++) {
-						if ((dTestInput[i][k]>>n) & 1) {    // if the nth bit of dTestInput[i][k] is 1
-							numActiveRows++;
+					#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
+					NeuroSimRead(layer, input, &threadNeuroSimReadEnergy[l], &threadReadLatency[l], traceWeight, &threadCost[l]);
+				} else {    // Algorithm
+					const double *input = l? &a[l-1][0] : &testInput[i][0];
+					for (int j=0; j<layer->numOutput; j++) {
+						double outN = 0;	// Net input of neuron j
+						for (int k=0; k<layer->numInput; k++) {
+							outN += 2 * input[k] * layer->weight[j][k] - input[k];
 						}
+						a[l][j] = sigmoid(outN);
 					}
 				}
-				subArrayIH->activityRowRead = (double)numActiveRows/param->nInput/param->numBitInput;
-				sumNeuroSimReadEnergyIH += NeuroSimSubArrayReadEnergy(subArrayIH);
-				sumNeuroSimReadEnergyIH += NeuroSimNeuronReadEnergy(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-				sumReadLatencyIH += NeuroSimSubArrayReadLatency(subArrayIH);
-				sumReadLatencyIH += NeuroSimNeuronReadLatency(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-			}
-		} else {    // Algorithm
-			for (int j=0; j<param->nHide; j++){
-				for (int k=0; k<param->nInput; k++){
-					outN1[j] += 2 * testInput[i][k] * weight1[j][k] - testInput[i][k];
-				}
-				a1[j] = sigmoid(outN1[j]);
 			}
-		}
 
-		/* Second layer from hidden layer to the output layer */
-		tempMax = 0;
-		countNum = 0;
-		std::fill_n(outN2, param->nOutput, 0);
-		std::fill_n(a2, param->nOutput, 0);
-		if (param->useHardwareInTestingFF) {  // Hardware
-			for (int j=0; j<param->nOutput; j++) {
-				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-					if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-						sumArrayReadEnergyHO += arrayHO->wireGateCapRow * techHO.vdd * techHO.vdd * param->nHide; // All WLs open
-					}
-				} else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayHO->cell[0][0])) {
-					if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-						sumArrayReadEnergyHO += arrayHO->wireGateCapRow * techHO.vdd * techHO.vdd;  // Selected WL
-					} else {    // Cross-point
-						sumArrayReadEnergyHO += arrayHO->wireCapRow * techHO.vdd * techHO.vdd * (param->nHide - 1); // Unselected WLs
-					}
-				}
-				for (int n=0; n<param->numBitInput; n++) {
-					double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1) * arrayHO->arrayRowSize;    // Max algorithm partial weighted sum for the nth vector bit (if both max input value and max weight are 1)
-					if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog NVM
-						double Isum = 0;    // weighted sum current
-						double IsumMax = 0; // Max weighted sum current
-						double a1Sum = 0;   // Weighted sum current of a1 vector * weight=1 column
-						for (int k=0; k<param->nHide; k++) {
-							if ((da1[k]>>n) & 1) {    // if the nth bit of da1[k] is 1
-								Isum += arrayHO->ReadCell(j,k);
-								a1Sum += arrayHO->GetMaxCellReadCurrent(j,k);
-								sumArrayReadEnergyHO += arrayHO->wireCapRow * readVoltageHO * readVoltageHO;   // Selected BLs (1T1R) or Selected WLs (cross-point)
-							}
-							IsumMax += arrayHO->GetMaxCellReadCurrent(j,k);
-						}
-						sumArrayReadEnergyHO += Isum * readVoltageHO * readPulseWidthHO;
-						int outputDigits = 2 * CurrentToDigits(Isum, IsumMax) - CurrentToDigits(a1Sum, IsumMax);
-						outN2[j] += DigitsToAlgorithm(outputDigits, pSumMaxAlgorithm);
-					} else {    // SRAM or digital eNVM
-						int Dsum = 0;
-						int DsumMax = 0;
-						int a1Sum = 0;
-						for (int k=0; k<param->nHide; k++) {
-							if ((da1[k]>>n) & 1) {    // if the nth bit of da1[k] is 1
-								Dsum += (int)(arrayHO->ReadCell(j,k));
-								a1Sum += pow(2, arrayHO->numCellPerSynapse) - 1;
-							}
-							DsumMax += pow(2, arrayHO->numCellPerSynapse) - 1;
-						}
-						if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayHO->cell[0][0])) {    // Digital eNVM
-							sumArrayReadEnergyHO += static_cast<DigitalNVM*>(arrayHO->cell[0][0])->readEnergy * arrayHO->numCellPerSynapse * arrayHO->arrayRowSize;
-						} else {
-							sumArrayReadEnergyHO += static_cast<SRAM*>(arrayHO->cell[0][0])->readEnergy * arrayHO->numCellPerSynapse * arrayHO->arrayRowSize;
-						}
-						outN2[j] += (double)(2 * Dsum - a1Sum) / DsumMax * pSumMaxAlgorithm;
-					}
-				}
-				a2[j] = sigmoid(outN2[j]);
-				if (a2[j] > tempMax) {
-					tempMax = a2[j];
+			/* Prediction: the first output neuron with the largest output */
+			const std::vector<double>& aOutput = a[numLayers-1];
+			double tempMax = 0;
+			int countNum = 0;
+			for (int j=0; j<aOutput.size(); j++) {
+				if (aOutput[j] > tempMax) {
+					tempMax = aOutput[j];
 					countNum = j;
 				}
 			}
-
-			numBatchReadSynapse = (int)ceil((double)param->nOutput/param->numColMuxed);
-			#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-			for (int j=0; j<param->nOutput; j+=numBatchReadSynapse) {
-				int numActiveRows = 0;  // Number of selected rows for NeuroSim
-				for (int n=0; n<param->numBitInput; n++) {
-					for (int k=0; k<param->nHide; k++) {
-						if ((da1[k]>>n) & 1) {    // if the nth bit of da1[k] is 1
-							numActiveRows++;
-						}
-					}
-				}
-				subArrayHO->activityRowRead = (double)numActiveRows/param->nHide/param->numBitInput;
-				sumNeuroSimReadEnergyHO += NeuroSimSubArrayReadEnergy(subArrayHO);
-				sumNeuroSimReadEnergyHO += NeuroSimNeuronReadEnergy(subArrayHO, adderHO, muxHO, muxDecoderHO, dffHO);
-				sumReadLatencyHO += NeuroSimSubArrayReadLatency(subArrayHO);
-				sumReadLatencyHO += NeuroSimNeuronReadLatency(subArrayHO, adderHO, muxHO, muxDecoderHO, dffHO);
-			}
-		} else {    // Algorithm
-			for (int j=0; j<param->nOutput; j++) {
-				for (int k=0; k<param->nHide; k++) {
-					outN2[j] += 2 * a1[k] * weight2[j][k] - a1[k];
-				}
-				a2[j] = sigmoid(outN2[j]);
-				if (a2[j] > tempMax) {
-					tempMax = a2[j];
-					countNum = j;
-				}
+			if (testOutput[i][countNum] == 1) {
+				numCorrect++;
 			}
 		}
-		if (testOutput[i][countNum] == 1) {
-			correct++;
+		#pragma omp critical
+		for (int l=0; l<numLayers; l++) {
+			sumArrayReadEnergy[l] += ArrayCost(threadCost[l].readEnergy);
+			sumNeuroSimReadEnergy[l] += threadNeuroSimReadEnergy[l];
+			sumReadLatency[l] += threadReadLatency[l];
+			sumCost[l].Add(threadCost[l], 1);
 		}
 	}
+	correct = numCorrect;
 	if (param->PrintWeightdist) {
-		int numweight[10];
-		int numweight2[10];
-		std::fill_n(numweight, 10, 0);
-		std::fill_n(numweight2, 10, 0);
-		/* ARRAYIH*/
-		for (int i = 0; i < param->nHide; i++) {
-			for (int j = 0; j < param->nInput; j++) {
-				if (0 <= weight1[i][j] && weight1[i][j] < 0.1) { numweight[0] += 1; }
-				else if (0.1 <= weight1[i][j] && weight1[i][j] < 0.2) { numweight[1] += 1; }
-				else if (0.2 <= weight1[i][j] && weight1[i][j] < 0.3) { numweight[2] += 1; }
-				else if (0.3 <= weight1[i][j] && weight1[i][j] < 0.4) { numweight[3] += 1; }
-				else if (0.4 <= weight1[i][j] && weight1[i][j] < 0.5) { numweight[4] += 1; }
-				else if (0.5 <= weight1[i][j] && weight1[i][j] < 0.6) { numweight[5] += 1; }
-				else if (0.6 <= weight1[i][j] && weight1[i][j] < 0.7) { numweight[6] += 1; }
-				else if (0.7 <= weight1[i][j] && weight1[i][j] < 0.8) { numweight[7] += 1; }
-				else if (0.8 <= weight1[i][j] && weight1[i][j] < 0.9) { numweight[8] += 1; }
-				else if (0.9 <= weight1[i][j] && weight1[i][j] <= 1) { numweight[9] += 1; }
-			}
-		}
-		/* ARRAYHO*/
-		for (int i = 0; i < param->nOutput; i++) {
-			for (int j = 0; j < param->nHide; j++) {
-				if (0 <= weight2[i][j] && weight2[i][j] < 0.1) { numweight2[0] += 1; }
-				else if (0.1 <= weight2[i][j] && weight2[i][j] < 0.2) { numweight2[1] += 1; }
-				else if (0.2 <= weight2[i][j] && weight2[i][j] < 0.3) { numweight2[2] += 1; }
-				else if (0.3 <= weight2[i][j] && weight2[i][j] < 0.4) { numweight2[3] += 1; }
-				else if (0.4 <= weight2[i][j] && weight2[i][j] < 0.5) { numweight2[4] += 1; }
-				else if (0.5 <= weight2[i][j] && weight2[i][j] < 0.6) { numweight2[5] += 1; }
-				else if (0.6 <= weight2[i][j] && weight2[i][j] < 0.7) { numweight2[6] += 1; }
-				else if (0.7 <= weight2[i][j] && weight2[i][j] < 0.8) { numweight2[7] += 1; }
-				else if (0.8 <= weight2[i][j] && weight2[i][j] < 0.9) { numweight2[8] += 1; }
-				else if (0.9 <= weight2[i][j] && weight2[i][j] <= 1) { numweight2[9] += 1; }
+		for (int l=0; l<numLayers; l++) {
+			Histogram numweight;
+			WeightHistogram(layers[l], 0, 1, 10, &numweight);
+			for (int i = 0; i < 10; i++) {
+				std::cout << "weight" << l + 1 << i << ":" << numweight.counts[i] << std::endl;
 			}
 		}
-		for (int i = 0; i < 10; i++) {
-			std::cout << "weight1" << i << ":" << numweight[i] << std::endl;
-		}
-		for (int i = 0; i < 10; i++) {
-			std::cout << "weight2" << i << ":" << numweight2[i] << std::endl;
+	}
+	numValidated = numTestImages;
+	if (!param->useHardwareInTraining && countCost) {    // Calculate the classification latency and energy only for offline classification
+		/* Scale the subset cost up to the full testing set so that the reported numbers stay comparable */
+		for (int l=0; l<numLayers; l++) {
+			layers[l]->array->readEnergy += sumArrayReadEnergy[l] * scale;
+			layers[l]->subArray->readDynamicEnergy += sumNeuroSimReadEnergy[l] * scale;
+			layers[l]->subArray->readLatency += sumReadLatency[l] * scale;
+			layers[l]->cost.Add(sumCost[l], scale);
 		}
 	}
-	if (!param->useHardwareInTraining) {    // Calculate the classification latency and energy only for offline classification
-		arrayIH->readEnergy += sumArrayReadEnergyIH;
-		subArrayIH->readDynamicEnergy += sumNeuroSimReadEnergyIH;
-		arrayHO->readEnergy += sumArrayReadEnergyHO;
-		subArrayHO->readDynamicEnergy += sumNeuroSimReadEnergyHO;
-		subArrayIH->readLatency += sumReadLatencyIH;
-		subArrayHO->readLatency += sumReadLatencyHO;
+	if (chip && param->useHardwareInTestingFF) {	// Per inference cost of the chip report, also for online training
+		for (int l=0; l<numLayers; l++) {
+			chip->SetInferenceCost(l, (sumArrayReadEnergy[l] + sumNeuroSimReadEnergy[l]) / numTestImages, sumReadLatency[l] / numTestImages);
+		}
 	}
-	
-}
 
+}
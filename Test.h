@@ -39,6 +39,6 @@
 #ifndef TEST_H_
 #define TEST_H_
 
-void Validate();
+void AccuracyConfidenceInterval(int numCorrect, int numTotal, double z, double *lower, double *upper);
 
 #endif
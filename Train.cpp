@@ -41,1822 +41,728 @@
 #include <iostream>
 #include <vector>
 #include <random>
+#include <algorithm>
 #include "formula.h"
 #include "Param.h"
 #include "Array.h"
-#include "Mapping.h"
 #include "NeuroSim.h"
-
-extern Param *param;
-
-extern std::vector< std::vector<double> > Input;
-extern std::vector< std::vector<int> > dInput;
-extern std::vector< std::vector<double> > Output;
-
-extern std::vector< std::vector<double> > weight1;
-extern std::vector< std::vector<double> > weight2;
-extern std::vector< std::vector<double> > deltaWeight1;
-extern std::vector< std::vector<double> > deltaWeight2;
-
-extern Technology techIH;
-extern Technology techHO;
-extern Array *arrayIH;
-extern Array *arrayHO;
-extern SubArray *subArrayIH;
-extern SubArray *subArrayHO;
-extern Adder adderIH;
-extern Mux muxIH;
-extern RowDecoder muxDecoderIH;
-extern DFF dffIH;
-extern Adder adderHO;
-extern Mux muxHO;
-extern RowDecoder muxDecoderHO;
-extern DFF dffHO;
-
-void Train(const int numTrain, const int epochs) {
-	int numBatchReadSynapse;	// # of read synapses in a batch read operation (decide later)
-	int numBatchWriteSynapse;	// # of write synapses in a batch write operation (decide later)
-	double outN1[param->nHide]; // Net input to the hidden layer [param->nHide]
-	double a1[param->nHide];    // Net output of hidden layer [param->nHide] also the input of hidden layer to output layer
-	int da1[param->nHide];  // Digitized net output of hidden layer [param->nHide] also the input of hidden layer to output layer
-	double outN2[param->nOutput];   // Net input to the output layer [param->nOutput]
-	double a2[param->nOutput];  // Net output of output layer [param->nOutput]
-	//std::vector<std::vector<double>>
-	double s1[param->nHide];    // Output delta from input layer to the hidden layer [param->nHide]
-	double s2[param->nOutput];  // Output delta from hidden layer to the output layer [param->nOutput]
-	for (int t = 0; t < epochs; t++) {
-		for (int batchSize = 0; batchSize < numTrain; batchSize++) {
-
-			int i = rand() % param->numMnistTrainImages;  // Randomize sample
-
-			// Forward propagation
-			/* First layer (input layer to the hidden layer) */
-			std::fill_n(outN1, param->nHide, 0);
-			std::fill_n(a1, param->nHide, 0);
-			if (param->useHardwareInTrainingFF) {   // Hardware
-				double sumArrayReadEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-				double readVoltage = static_cast<eNVM*>(arrayIH->cell[0][0])->readVoltage;
-				double readPulseWidth = static_cast<eNVM*>(arrayIH->cell[0][0])->readPulseWidth;
-#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-				for (int j = 0; j < param->nHide; j++) {
-					if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-						if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-							sumArrayReadEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * param->nInput; // All WLs open
-						}
-					}
-					else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayIH->cell[0][0])) { // Digital eNVM
-						if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-							sumArrayReadEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd; // Selected WL
-						}
-						else {    // Cross-point
-							sumArrayReadEnergy += arrayIH->wireCapRow * techIH.vdd * techIH.vdd * (param->nInput - 1);  // Unselected WLs
-						}
-					}
-					for (int n = 0; n < param->numBitInput; n++) {
-						double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1) * arrayIH->arrayRowSize;  // Max algorithm partial weighted sum for the nth vector bit (if both max input value and max weight are 1)
-						//numInputlevel=2, pSumMaxAlgoritmh=100; 
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-							double Isum = 0;    // weighted sum current
-							double IsumMax = 0; // Max weighted sum current
-							double inputSum = 0;    // Weighted sum current of input vector * weight=1 column
-							for (int k = 0; k < param->nInput; k++) {
-								if ((dInput[i][k] >> n) & 1) {    // if the nth bit of dInput[i][k] is 1
-									Isum += arrayIH->ReadCell(j, k);
-									
-									inputSum += arrayIH->GetMaxCellReadCurrent(j, k);
-									sumArrayReadEnergy += arrayIH->wireCapRow * readVoltage * readVoltage; // Selected BLs (1T1R) or Selected WLs (cross-point)
-								}
-								IsumMax += arrayIH->GetMaxCellReadCurrent(j, k);
-							}
-							//std::cout << Isum << std::endl;
-							//std::cout << IsumMax << std::endl;
-							sumArrayReadEnergy += Isum * readVoltage * readPulseWidth;
-							//int outputDigits = CurrentToDigits(Isum, IsumMax);
-							int outputDigits = 2* CurrentToDigits(Isum, IsumMax) - CurrentToDigits(inputSum, IsumMax);
-							//int outputDigits = 2*CurrentToDigits(Isum, IsumMax) - CurrentToDigits(inputSum, IsumMax);
-							//std::cout << outputDigits << std::endl;
-							outN1[j] += DigitsToAlgorithm(outputDigits, pSumMaxAlgorithm);
-							//std::cout << outN1[j] << std::endl;
-							//̰ -10 ~ 10 ̰ .
-						}
-						else {    // SRAM or digital eNVM
-							int Dsum = 0;
-							int DsumMax = 0;
-							int inputSum = 0;
-							for (int k = 0; k < param->nInput; k++) {
-								if ((dInput[i][k] >> n) & 1) {    // if the nth bit of dInput[i][k] is 1
-									Dsum += (int)(arrayIH->ReadCell(j, k));
-									inputSum += pow(2, arrayIH->numCellPerSynapse) - 1;
-								}
-								DsumMax += pow(2, arrayIH->numCellPerSynapse) - 1;
-							}
-							if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayIH->cell[0][0])) {    // Digital eNVM
-								sumArrayReadEnergy += static_cast<DigitalNVM*>(arrayIH->cell[0][0])->readEnergy * arrayIH->numCellPerSynapse * arrayIH->arrayRowSize;
-							}
-							else {    // SRAM
-								sumArrayReadEnergy += static_cast<SRAM*>(arrayIH->cell[0][0])->readEnergy * arrayIH->numCellPerSynapse * arrayIH->arrayRowSize;
-							}
-							outN1[j] += (double)(2 * Dsum - inputSum) / DsumMax * pSumMaxAlgorithm;
+#include "Simulator.h"
+
+/* Bit planes of the digitized input vector for the packed synapses: bit k of plane n is bit n of input[k],
+ * every plane has (numInput+63)/64 words */
+void Simulator::PackInput(const Layer *layer, const int *input, std::vector<uint64_t> *inputMask) {
+	int numWords = (layer->numInput + 63) / 64;
+	inputMask->assign(param->numBitInput * numWords, 0);
+	for (int n = 0; n < param->numBitInput; n++) {
+		uint64_t *plane = &(*inputMask)[n * numWords];
+		for (int k = 0; k < layer->numInput; k++) {
+			plane[k >> 6] |= (uint64_t)((input[k] >> n) & 1) << (k & 63);
+		}
+	}
+}
+
+/* Weighted sum of column j of the layer's array for the digitized input vector (bit by bit over numBitInput).
+ * Every tile row digitizes its own partial sum of every input bit, which are then shift-added digitally.
+ * An analog tile reads the current of every row that is active in any bit once and adds it to the partial sum of
+ * every bit the row is active in, except with read noise where every bit cycle is a separate noisy read.
+ * The array read energy is added term by term to arrayReadEnergy[NUM_ARRAY_COSTS], per component (see CostBreakdown.h),
+ * which is an OpenMP reduction variable of the caller. inputMask is the input packed by PackInput. */
+double Simulator::ReadColumn(Layer *layer, int j, const int *input, const uint64_t *inputMask, double *arrayReadEnergy) {
+	Array *array = layer->array;
+	double vdd = layer->tech.vdd;
+	double outN = 0;	// Net input of neuron j
+	int numConversions = 0, numClipped = 0;	// ADC conversions of the partial sums, and those at the full scale
+	int numBitInput = param->numBitInput;
+	int numWords = (layer->numInput + 63) / 64;	// Words of every bit plane of inputMask
+	int numTiles = (layer->numInput + layer->tileRows - 1) / layer->tileRows;
+	/* Partial weighted sum (algorithm value) and cell read energy of input bit n and tile row t at n * numTiles + t,
+	 * shift-added bit by bit at the end */
+	std::vector<double> partialSum(numBitInput * numTiles), cellReadEnergy(numBitInput * numTiles);
+	std::vector<double> Isum(numBitInput);		// Weighted sum current of every input bit
+	std::vector<double> inputSum(numBitInput);	// Weighted sum current of input vector * weight=1 column of every input bit
+	if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[0][0])) {  // Analog eNVM
+		if (static_cast<eNVM*>(array->cell[0][0])->cmosAccess) {  // 1T1R
+			arrayReadEnergy[COST_SELECTED_LINES] += array->wireGateCapRow * vdd * vdd * layer->numInput; // All WLs open
+		}
+	}
+	else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(array->cell[0][0])) { // Digital eNVM
+		if (static_cast<eNVM*>(array->cell[0][0])->cmosAccess) {  // 1T1R
+			arrayReadEnergy[COST_SELECTED_LINES] += array->wireGateCapRow * vdd * vdd; // Selected WL
+		}
+		else {    // Cross-point
+			arrayReadEnergy[COST_UNSELECTED_LINES] += array->wireCapRow * vdd * vdd * (layer->tileRows - 1) * layer->numTileRow;  // Unselected WLs of every tile
+		}
+	}
+	for (int t = 0; t < numTiles; t++) {	// Every tile row
+		int rowStart = t * layer->tileRows;
+		int rowEnd = std::min(rowStart + layer->tileRows, layer->numInput);
+		if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[0][0])) {  // Analog eNVM
+			double readVoltage = static_cast<eNVM*>(array->cell[0][0])->readVoltage;
+			double readPulseWidth = static_cast<eNVM*>(array->cell[0][0])->readPulseWidth;
+			bool readNoise = static_cast<eNVM*>(array->cell[0][0])->readNoise;
+			double IsumMax = 0; // Max weighted sum current
+			std::fill(Isum.begin(), Isum.end(), 0);
+			std::fill(inputSum.begin(), inputSum.end(), 0);
+			for (int k = rowStart; k < rowEnd; k++) {
+				IsumMax += array->GetMaxCellReadCurrent(j, k);
+			}
+			for (int w = rowStart >> 6; w <= (rowEnd - 1) >> 6; w++) {
+				uint64_t rowMask = ~0ULL;	// Rows of the tile in word w
+				if (w == rowStart >> 6) {
+					rowMask &= ~0ULL << (rowStart & 63);
+				}
+				if (w == (rowEnd - 1) >> 6) {
+					rowMask &= ~0ULL >> (63 - ((rowEnd - 1) & 63));
+				}
+				uint64_t active = 0;	// Rows that are active in any bit
+				for (int n = 0; n < numBitInput; n++) {
+					active |= inputMask[n * numWords + w];
+				}
+				for (active &= rowMask; active; active &= active - 1) {
+					int k = w * 64 + __builtin_ctzll(active);
+					double I = readNoise? 0 : array->ReadCell(j, k);
+					double Imax = array->GetMaxCellReadCurrent(j, k);
+					for (int n = 0; n < numBitInput; n++) {
+						if ((inputMask[n * numWords + w] >> (k & 63)) & 1) {    // if the nth bit of input[k] is 1
+							Isum[n] += readNoise? array->ReadCell(j, k) : I;
+							inputSum[n] += Imax;
+							arrayReadEnergy[COST_SELECTED_LINES] += array->wireCapRow * readVoltage * readVoltage; // Selected BLs (1T1R) or Selected WLs (cross-point)
 						}
 					}
-					a1[j] = sigmoid(outN1[j]);
-					da1[j] = round_th(a1[j] * (param->numInputLevel - 1), param->Hthreshold);
-					// -4.3 ==> -4  -4.7 ==> -5 , 4.3 ==> 4 , 4.7 ==> 5
 				}
-				arrayIH->readEnergy += sumArrayReadEnergy;
-
-				numBatchReadSynapse = (int)ceil((double)param->nHide / param->numColMuxed);
-				// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-				for (int j = 0; j < param->nHide; j += numBatchReadSynapse) {
-					int numActiveRows = 0;  // Number of selected rows for NeuroSim
-					for (int n = 0; n < param->numBitInput; n++) {
-						for (int k = 0; k < param->nInput; k++) {
-							if ((dInput[i][k] >> n) & 1) {    // if the nth bit of dInput[i][k] is 1
-								numActiveRows++;
-							}
+			}
+			for (int n = 0; n < numBitInput; n++) {
+				double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1) * (rowEnd - rowStart);  // Max algorithm partial weighted sum of the tile for the nth vector bit (if both max input value and max weight are 1)
+				int IsumDigits = CurrentToDigits(Isum[n], IsumMax);
+				numConversions++;
+				numClipped += IsumDigits >= param->pSumMaxHardware;
+				int outputDigits = 2 * IsumDigits - CurrentToDigits(inputSum[n], IsumMax);
+				cellReadEnergy[n * numTiles + t] = Isum[n] * readVoltage * readPulseWidth;
+				partialSum[n * numTiles + t] = DigitsToAlgorithm(outputDigits, pSumMaxAlgorithm);
+			}
+		}
+		else {    // SRAM or digital eNVM
+			for (int n = 0; n < numBitInput; n++) {
+				double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1) * (rowEnd - rowStart);  // Max algorithm partial weighted sum of the tile for the nth vector bit (if both max input value and max weight are 1)
+				int Dsum = 0;
+				int DsumMax = 0;
+				int inputSum = 0;
+				if (array->weightPlane) {	// Popcount of the packed bit planes
+					const uint64_t *mask = inputMask + n * numWords;
+					int maxWeightDigits = (1 << array->numCellPerSynapse) - 1;
+					Dsum = array->PackedColumnSum(j, mask, rowStart, rowEnd);
+					inputSum = PopcountRange(mask, mask, rowStart, rowEnd) * maxWeightDigits;
+					DsumMax = (rowEnd - rowStart) * maxWeightDigits;
+				}
+				else {
+					for (int k = rowStart; k < rowEnd; k++) {
+						if ((input[k] >> n) & 1) {    // if the nth bit of input[k] is 1
+							Dsum += (int)(array->ReadCell(j, k));
+							inputSum += pow(2, array->numCellPerSynapse) - 1;
 						}
+						DsumMax += pow(2, array->numCellPerSynapse) - 1;
 					}
-					subArrayIH->activityRowRead = (double)numActiveRows / param->nInput / param->numBitInput;
-					subArrayIH->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayIH);
-					subArrayIH->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-					subArrayIH->readLatency += NeuroSimSubArrayReadLatency(subArrayIH);
-					subArrayIH->readLatency += NeuroSimNeuronReadLatency(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
 				}
+				if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(array->cell[0][0])) {    // Digital eNVM
+					cellReadEnergy[n * numTiles + t] = static_cast<DigitalNVM*>(array->cell[0][0])->readEnergy * array->numCellPerSynapse * (rowEnd - rowStart);
+				}
+				else {    // SRAM
+					cellReadEnergy[n * numTiles + t] = static_cast<SRAM*>(array->cell[0][0])->readEnergy * array->numCellPerSynapse * (rowEnd - rowStart);
+				}
+				partialSum[n * numTiles + t] = (double)(2 * Dsum - inputSum) / DsumMax * pSumMaxAlgorithm;
 			}
-			else {    // Algorithm
-#pragma omp parallel for
-				for (int j = 0; j < param->nHide; j++) {
-					for (int k = 0; k < param->nInput; k++) {
-						outN1[j] += 2 * Input[i][k] * weight1[j][k] - Input[i][k];
-					}
-					a1[j] = sigmoid(outN1[j]);
+		}
+	}
+	/* Shift-add of the bits (pSumMaxAlgorithm already carries the 2^n weight) */
+	for (int n = 0; n < numBitInput; n++) {
+		for (int t = 0; t < numTiles; t++) {
+			arrayReadEnergy[COST_CELLS] += cellReadEnergy[n * numTiles + t];
+			outN += partialSum[n * numTiles + t];
+		}
+	}
+	if (numConversions) {	// The digital sums of SRAM and digital eNVM are not converted
+		telemetry.Conversions(layer->index, numConversions, numClipped);
+	}
+	return outN;
+}
+
+/* NeuroSim read cost of the layer's tiles for one input vector, once per column batch (numColMuxed) of a tile.
+ * Not thread safe: NeuroSim functions may update their member variables. The events are traced with
+ * traceWeight (0: not traced) and the modules are added to *cost if not NULL. */
+void Simulator::NeuroSimRead(Layer *layer, const int *input, double *readEnergy, double *readLatency, double traceWeight, CostBreakdown *cost) {
+	std::vector<double> activityRowRead(layer->numTileRow);	// Activity of every tile row
+	int timedTileRow = 0;	// The busiest tile row, which sets the latency
+	for (int r = 0; r < layer->numTileRow; r++) {
+		int rowStart = r * layer->tileRows;
+		int rowEnd = std::min(rowStart + layer->tileRows, layer->numInput);
+		int numActiveRows = 0;  // Number of selected rows for NeuroSim
+		for (int n = 0; n < param->numBitInput; n++) {
+			for (int k = rowStart; k < rowEnd; k++) {
+				if ((input[k] >> n) & 1) {    // if the nth bit of input[k] is 1
+					numActiveRows++;
 				}
 			}
+		}
+		activityRowRead[r] = (double)numActiveRows / layer->tileRows / param->numBitInput;
+		if (activityRowRead[r] > activityRowRead[timedTileRow]) {
+			timedTileRow = r;
+		}
+	}
+	int numBatchReadSynapse = (int)ceil((double)layer->tileCols / param->numColMuxed);	// # of read synapses of a tile in a batch read operation
+	for (int j = 0; j < layer->tileCols; j += numBatchReadSynapse) {
+		for (int r = 0; r < layer->numTileRow; r++) {
+			layer->ReadCost(activityRowRead[r], r == timedTileRow, readEnergy, readLatency, cost);
+			if (traceWeight > 0) { activityTrace.Read(layer->index, activityRowRead[r], true, r == timedTileRow, traceWeight); }
+		}
+	}
+}
+
+void Simulator::Train(const int numTrain, const int epochs) {
+	int numLayers = layers.size();
+	std::vector< std::vector<double> > a(numLayers);	// Net output of every layer, also the input of the next layer
+	std::vector< std::vector<int> > da(numLayers);		// Digitized net output of every hidden layer, also the input of the next layer
+	std::vector< std::vector<double> > s(numLayers);	// Output delta of every layer
+	std::vector<uint64_t> inputMask;	// Packed digitized input of the layer, see PackInput
+	int64_t numSynapses = 0;	// # of synapses of the network
+	for (int l = 0; l < numLayers; l++) {
+		a[l].resize(layers[l]->numOutput);
+		da[l].resize(layers[l]->numOutput);
+		s[l].resize(layers[l]->numOutput);
+		numSynapses += (int64_t)layers[l]->numInput * layers[l]->numOutput;
+	}
+	for (int t = 0; t < epochs; t++) {
+		profiler.BeginEpoch();
+		for (int batchSize = 0; batchSize < numTrain; batchSize++) {
 
-			/* Second layer (hidder layer to the output layer) */
-			std::fill_n(outN2, param->nOutput, 0);
-			std::fill_n(a2, param->nOutput, 0);
-			if (param->useHardwareInTrainingFF) {   // Hardware
-				double sumArrayReadEnergy = 0;  // Use a temporary variable here since OpenMP does not support reduction on class member
-				double readVoltage = static_cast<eNVM*>(arrayHO->cell[0][0])->readVoltage;
-				double readPulseWidth = static_cast<eNVM*>(arrayHO->cell[0][0])->readPulseWidth;
-#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-				for (int j = 0; j < param->nOutput; j++) {
-					if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-						if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-							sumArrayReadEnergy += arrayHO->wireGateCapRow * techHO.vdd * techHO.vdd * param->nHide; // All WLs open
-						}
-					}
-					else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayHO->cell[0][0])) { // Digital eNVM
-						if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-							sumArrayReadEnergy += arrayHO->wireGateCapRow * techHO.vdd * techHO.vdd;    // Selected WL
-						}
-						else {    // Cross-point
-							sumArrayReadEnergy += arrayHO->wireCapRow * techHO.vdd * techHO.vdd * (param->nHide - 1);   // Unselected WLs
+			int i = rng.Rand() % param->numMnistTrainImages;  // Randomize sample
+
+			// Forward propagation
+			for (int l = 0; l < numLayers; l++) {
+				Layer *layer = layers[l];
+				const double *input = l? &a[l-1][0] : &Input[i][0];
+				if (param->useHardwareInTrainingFF) {   // Hardware
+					PROFILE_SCOPE(profiler, layer->output? PHASE_FORWARD_HO : PHASE_FORWARD_IH);
+					const int *dInputLayer = l? &da[l-1][0] : &dInput[i][0];
+					double sumArrayReadEnergy[NUM_ARRAY_COSTS] = {0};   // Use a temporary variable here since OpenMP does not support reduction on class member
+					PackInput(layer, dInputLayer, &inputMask);
+#pragma omp parallel for reduction(+: sumArrayReadEnergy[:NUM_ARRAY_COSTS])
+					for (int j = 0; j < layer->numOutput; j++) {
+						a[l][j] = sigmoid(ReadColumn(layer, j, dInputLayer, &inputMask[0], sumArrayReadEnergy));
+						if (!layer->output) {
+							da[l][j] = round_th(a[l][j] * (param->numInputLevel - 1), param->Hthreshold);
 						}
 					}
-					for (int n = 0; n < param->numBitInput; n++) {
-						double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1) * arrayHO->arrayRowSize;    // Max algorithm partial weighted sum for the nth vector bit (if both max input value and max weight are 1)
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-							double Isum = 0;    // weighted sum current
-							double IsumMax = 0; // Max weighted sum current
-							double a1Sum = 0;   // Weighted sum current of a1 vector * weight=1 column
-							for (int k = 0; k < param->nHide; k++) {
-								if ((da1[k] >> n) & 1) {    // if the nth bit of da1[k] is 1
-									Isum += arrayHO->ReadCell(j, k);
-									a1Sum += arrayHO->GetMaxCellReadCurrent(j, k);
-									sumArrayReadEnergy += arrayHO->wireCapRow * readVoltage * readVoltage; // Selected BLs (1T1R) or Selected WLs (cross-point)
-								}
-								IsumMax += arrayHO->GetMaxCellReadCurrent(j, k);
-							}
-							sumArrayReadEnergy += Isum * readVoltage * readPulseWidth;
-							int outputDigits = 2 * CurrentToDigits(Isum, IsumMax) - CurrentToDigits(a1Sum, IsumMax);
-							outN2[j] += DigitsToAlgorithm(outputDigits, pSumMaxAlgorithm);
-						}
-						else {    // SRAM or digital eNVM
-							int Dsum = 0;
-							int DsumMax = 0;
-							int a1Sum = 0;
-							for (int k = 0; k < param->nHide; k++) {
-								if ((da1[k] >> n) & 1) {    // if the nth bit of da1[k] is 1
-									Dsum += (int)(arrayHO->ReadCell(j, k));
-									a1Sum += pow(2, arrayHO->numCellPerSynapse) - 1;
-								}
-								DsumMax += pow(2, arrayHO->numCellPerSynapse) - 1;
-							}
-							if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayHO->cell[0][0])) {    // Digital eNVM
-								sumArrayReadEnergy += static_cast<DigitalNVM*>(arrayHO->cell[0][0])->readEnergy * arrayHO->numCellPerSynapse * arrayHO->arrayRowSize;
-							}
-							else {
-								sumArrayReadEnergy += static_cast<SRAM*>(arrayHO->cell[0][0])->readEnergy * arrayHO->numCellPerSynapse * arrayHO->arrayRowSize;
-							}
-							outN2[j] += (double)(2 * Dsum - a1Sum) / DsumMax * pSumMaxAlgorithm;
-						}
+					layer->array->readEnergy += ArrayCost(sumArrayReadEnergy);
+					for (int c = 0; c < NUM_ARRAY_COSTS; c++) {
+						layer->cost.readEnergy[c] += sumArrayReadEnergy[c];
 					}
-					a2[j] = sigmoid(outN2[j]);
-				}
-				arrayHO->readEnergy += sumArrayReadEnergy;
 
-				numBatchReadSynapse = (int)ceil((double)param->nOutput / param->numColMuxed);
-				// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-				for (int j = 0; j < param->nOutput; j += numBatchReadSynapse) {
-					int numActiveRows = 0;  // Number of selected rows for NeuroSim
-					for (int n = 0; n < param->numBitInput; n++) {
-						for (int k = 0; k < param->nHide; k++) {
-							if ((da1[k] >> n) & 1) {    // if the nth bit of da1[k] is 1
-								numActiveRows++;
-							}
-						}
-					}
-					subArrayHO->activityRowRead = (double)numActiveRows / param->nHide / param->numBitInput;
-					subArrayHO->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayHO);
-					subArrayHO->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayHO, adderHO, muxHO, muxDecoderHO, dffHO);
-					subArrayHO->readLatency += NeuroSimSubArrayReadLatency(subArrayHO);
-					subArrayHO->readLatency += NeuroSimNeuronReadLatency(subArrayHO, adderHO, muxHO, muxDecoderHO, dffHO);
+					// Don't parallelize this since there may be update of member variables inside NeuroSim functions
+					PROFILE_SCOPE(profiler, layer->output? PHASE_FORWARD_HO_NEUROSIM : PHASE_FORWARD_IH_NEUROSIM);
+					NeuroSimRead(layer, dInputLayer, &layer->subArray->readDynamicEnergy, &layer->subArray->readLatency, 1, &layer->cost);
 				}
-			}
-			else {
+				else {    // Algorithm
+					PROFILE_SCOPE(profiler, layer->output? PHASE_FORWARD_HO : PHASE_FORWARD_IH);
 #pragma omp parallel for
-				for (int j = 0; j < param->nOutput; j++) {
-					for (int k = 0; k < param->nHide; k++) {
-						outN2[j] += 2 * a1[k] * weight2[j][k] - a1[k];
+					for (int j = 0; j < layer->numOutput; j++) {
+						double outN = 0;	// Net input of neuron j
+						for (int k = 0; k < layer->numInput; k++) {
+							outN += 2 * input[k] * layer->weight[j][k] - input[k];
+						}
+						a[l][j] = sigmoid(outN);
 					}
-					a2[j] = sigmoid(outN2[j]);
 				}
 			}
 
 			// Backpropagation
-			/* Second layer (hidder layer to the output layer) */
-			for (int j = 0; j < param->nOutput; j++) {
-				s2[j] = -2 * a2[j] * (1 - a2[j])*(Output[i][j] - a2[j]);
-			}
+			{
+				PROFILE_SCOPE(profiler, PHASE_BACKPROP);
+				/* Output layer */
+				for (int j = 0; j < layers[numLayers-1]->numOutput; j++) {
+					s[numLayers-1][j] = -2 * a[numLayers-1][j] * (1 - a[numLayers-1][j]) * (Output[i][j] - a[numLayers-1][j]);
+				}
 
-			/* First layer (input layer to the hidden layer) */
-			std::fill_n(s1, param->nHide, 0);
+				/* Hidden layers, through the weights of the next layer */
+				for (int l = numLayers - 2; l >= 0; l--) {
+					const Layer *next = layers[l+1];
+					std::fill(s[l].begin(), s[l].end(), 0);
 #pragma omp parallel for
-			for (int j = 0; j < param->nHide; j++) {
-				for (int k = 0; k < param->nOutput; k++) {
-					s1[j] += a1[j] * (1 - a1[j]) * (2 * weight2[k][j] - 1) * s2[k];
+					for (int j = 0; j < layers[l]->numOutput; j++) {
+						for (int k = 0; k < next->numOutput; k++) {
+							s[l][j] += a[l][j] * (1 - a[l][j]) * (2 * next->weight[k][j] - 1) * s[l+1][k];
+						}
+					}
 				}
 			}
 
 			// Weight update
-			/* Update weight of the first layer (input layer to the hidden layer) */
-			if (param->useHardwareInTrainingWU) {
-				double sumArrayWriteEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-				double sumNeuroSimWriteEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-				double sumWriteLatencyAnalogNVM = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-				double numWriteOperation = 0;	// Average number of write batches in the whole array. Use a temporary variable here since OpenMP does not support reduction on class member
-				double writeVoltageLTP = static_cast<eNVM*>(arrayIH->cell[0][0])->writeVoltageLTP;
-				double writeVoltageLTD = static_cast<eNVM*>(arrayIH->cell[0][0])->writeVoltageLTD;
-				double writePulseWidthLTP = static_cast<eNVM*>(arrayIH->cell[0][0])->writePulseWidthLTP;
-				double writePulseWidthLTD = static_cast<eNVM*>(arrayIH->cell[0][0])->writePulseWidthLTD;
-				numBatchWriteSynapse = (int)ceil((double)arrayIH->arrayColSize / param->numWriteColMuxed);
-#pragma omp parallel for reduction(+: sumArrayWriteEnergy, sumNeuroSimWriteEnergy, sumWriteLatencyAnalogNVM)
-				for (int k = 0; k < param->nInput; k++) {
-					int numWriteOperationPerRow = 0;	// Number of write batches in a row that have any weight change
-					int numWriteCellPerOperation = 0;	// Average number of write cells per batch in a row (for digital eNVM)
-					for (int j = 0; j < param->nHide; j += numBatchWriteSynapse) {
-						/* Batch write */
-						int start = j;
-						int end = j + numBatchWriteSynapse - 1;
-						if (end >= param->nHide) {
-							end = param->nHide - 1;
-						}
-						double maxLatencyLTP = 0;	// Max latency for AnalogNVM's LTP or weight increase in this batch write
-						double maxLatencyLTD = 0;	// Max latency for AnalogNVM's LTD or weight decrease in this batch write
-						bool weightChangeBatch = false;	// Specify if there is any weight change in the entire write batch
-						for (int jj = start; jj <= end; jj++) { // Selected cells
-							deltaWeight1[jj][k] = -param->alpha1 * s1[jj] * Input[i][k];
-							arrayIH->WriteCell(jj, k, deltaWeight1[jj][k], param->maxWeight, param->minWeight, true);
-							//weight1[jj][k] += deltaWeight1[jj][k];
-							weight1[jj][k] = arrayIH->ConductanceToWeight(jj, k, param->maxWeight, param->minWeight);//eltaWeight1[jj][k];
-							//arrayIH->WriteCell(jj, k, deltaWeight1[jj][k], param->maxWeight, param->minWeight, true);
-							//weight1[jj][k] = arrayIH->ConductanceToWeight(jj, k, param->maxWeight, param->minWeight);
-							//std::cout << jj << "," << k << ":" << weight1[jj][k] << std::endl;
-							if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[jj][k])) {	// Analog eNVM
-								weightChangeBatch = weightChangeBatch || static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->numPulse;
-								/* Get maxLatencyLTP and maxLatencyLTD */
-								if (static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeLatencyLTP > maxLatencyLTP)
-									maxLatencyLTP = static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeLatencyLTP;
-								if (static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeLatencyLTD > maxLatencyLTD)
-									maxLatencyLTD = static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeLatencyLTD;
-							}
-							else {	// SRAM and digital eNVM
-								weightChangeBatch = weightChangeBatch || arrayIH->weightChange[jj][k];
-							}
-						}
-						numWriteOperationPerRow += weightChangeBatch;
-						for (int jj = start; jj <= end; jj++) { // Selected cells
-							if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-								/* Set the max latency for all the selected cells in this batch */
-								static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeLatencyLTP = maxLatencyLTP;
-								static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeLatencyLTD = maxLatencyLTD;
-								if (param->writeEnergyReport && weightChangeBatch) {
-									if (static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->nonIdenticalPulse) {	// Non-identical write pulse scheme
-										if (static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->numPulse > 0) {	// LTP
-											static_cast<eNVM*>(arrayIH->cell[jj][k])->writeVoltageLTP = sqrt(static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeVoltageSquareSum / static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->numPulse);	// RMS value of LTP write voltage
-											static_cast<eNVM*>(arrayIH->cell[jj][k])->writeVoltageLTD = static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VinitLTD + 0.5 * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VstepLTD * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->maxNumLevelLTD;	// Use average voltage of LTD write voltage
-										}
-										else if (static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->numPulse < 0) {	// LTD
-											static_cast<eNVM*>(arrayIH->cell[jj][k])->writeVoltageLTP = static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VinitLTP + 0.5 * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VstepLTP * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->maxNumLevelLTP;    // Use average voltage of LTP write voltage
-											static_cast<eNVM*>(arrayIH->cell[jj][k])->writeVoltageLTD = sqrt(static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeVoltageSquareSum / (-1 * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->numPulse));    // RMS value of LTD write voltage
-										}
-										else {	// Half-selected during LTP and LTD phases
-											static_cast<eNVM*>(arrayIH->cell[jj][k])->writeVoltageLTP = static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VinitLTP + 0.5 * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VstepLTP * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->maxNumLevelLTP;    // Use average voltage of LTP write voltage
-											static_cast<eNVM*>(arrayIH->cell[jj][k])->writeVoltageLTD = static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VinitLTD + 0.5 * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->VstepLTD * static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->maxNumLevelLTD;    // Use average voltage of LTD write voltage
-										}
-									}
-									static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->WriteEnergyCalculation(arrayIH->wireCapCol);
-									sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayIH->cell[jj][k])->writeEnergy;
-								}
-							}
-							else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayIH->cell[0][0])) { // Digital eNVM
-								if (param->writeEnergyReport && arrayIH->weightChange[jj][k]) {
-									for (int n = 0; n < arrayIH->numCellPerSynapse; n++) {  // n=0 is LSB
-										sumArrayWriteEnergy += static_cast<DigitalNVM*>(arrayIH->cell[(jj + 1) * arrayIH->numCellPerSynapse - (n + 1)][k])->writeEnergy;
-										int bitPrev = static_cast<DigitalNVM*>(arrayIH->cell[(jj + 1) * arrayIH->numCellPerSynapse - (n + 1)][k])->bitPrev;
-										int bit = static_cast<DigitalNVM*>(arrayIH->cell[(jj + 1) * arrayIH->numCellPerSynapse - (n + 1)][k])->bit;
-										if (bit != bitPrev) {
-											numWriteCellPerOperation += 1;
-										}
-									}
-								}
-							}
-							else {    // SRAM
-								if (param->writeEnergyReport && arrayIH->weightChange[jj][k]) {
-									sumArrayWriteEnergy += static_cast<SRAM*>(arrayIH->cell[jj * arrayIH->numCellPerSynapse][k])->writeEnergy;
-								}
-							}
-						}
-						/* Latency for each batch write in Analog eNVM */
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {	// Analog eNVM
-							sumWriteLatencyAnalogNVM += maxLatencyLTP + maxLatencyLTD;
-						}
-						/* Energy consumption on array caps for eNVM */
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-							if (param->writeEnergyReport && weightChangeBatch) {
-								if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->nonIdenticalPulse) { // Non-identical write pulse scheme
-									writeVoltageLTP = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->VinitLTP + 0.5 * static_cast<AnalogNVM*>(arrayIH->cell[0][0])->VstepLTP * static_cast<AnalogNVM*>(arrayIH->cell[0][0])->maxNumLevelLTP;    // Use average voltage of LTP write voltage
-									writeVoltageLTD = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->VinitLTD + 0.5 * static_cast<AnalogNVM*>(arrayIH->cell[0][0])->VstepLTD * static_cast<AnalogNVM*>(arrayIH->cell[0][0])->maxNumLevelLTD;    // Use average voltage of LTD write voltage
-								}
-								if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-									// The energy on selected SLs is included in WriteCell()
-									sumArrayWriteEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-									sumArrayWriteEnergy += arrayIH->wireCapRow * writeVoltageLTP * writeVoltageLTP;   // Selected BL (LTP phases)
-									sumArrayWriteEnergy += arrayIH->wireCapCol * writeVoltageLTP * writeVoltageLTP * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-									// No LTD part because all unselected rows and columns are V=0
-								}
-								else {
-									sumArrayWriteEnergy += arrayIH->wireCapRow * writeVoltageLTP * writeVoltageLTP;    // Selected WL (LTP phase)
-									sumArrayWriteEnergy += arrayIH->wireCapRow * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-									sumArrayWriteEnergy += arrayIH->wireCapCol * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-									sumArrayWriteEnergy += arrayIH->wireCapRow * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-									sumArrayWriteEnergy += arrayIH->wireCapCol * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-								}
-							}
-						}
-						else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayIH->cell[0][0])) { // Digital eNVM
-							if (param->writeEnergyReport && weightChangeBatch) {
-								if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-									// The energy on selected columns is included in WriteCell()
-									sumArrayWriteEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 for both SET and RESET phases)
-								}
-								else {    // Cross-point
-									sumArrayWriteEnergy += arrayIH->wireCapRow * writeVoltageLTP * writeVoltageLTP;   // Selected WL (SET phase)
-									sumArrayWriteEnergy += arrayIH->wireCapRow * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nInput - 1);    // Unselected WLs (SET phase)
-									sumArrayWriteEnergy += arrayIH->wireCapCol * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nHide - numBatchWriteSynapse) * arrayIH->numCellPerSynapse;   // Unselected BLs (SET phase)
-									sumArrayWriteEnergy += arrayIH->wireCapRow * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nInput - 1);   // Unselected WLs (RESET phase)
-									sumArrayWriteEnergy += arrayIH->wireCapCol * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nHide - numBatchWriteSynapse) * arrayIH->numCellPerSynapse;   // Unselected BLs (RESET phase)
-								}
-							}
-						}
-						/* Half-selected cells for eNVM */
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-							if (!static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess && param->writeEnergyReport) { // Cross-point
-								for (int jj = 0; jj < param->nHide; jj++) { // Half-selected cells in the same row
-									if (jj >= start && jj <= end) { continue; } // Skip the selected cells
-									sumArrayWriteEnergy += (writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayIH->cell[jj][k])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayIH->cell[jj][k])->conductanceAtHalfVwLTD * maxLatencyLTD);
-								}
-								for (int kk = 0; kk < param->nInput; kk++) {    // Half-selected cells in other rows
-									// Note that here is a bit inaccurate if using OpenMP, because the weight on other rows (threads) are also being updated
-									if (kk == k) { continue; } // Skip the selected row
-									for (int jj = start; jj <= end; jj++) {
-										sumArrayWriteEnergy += (writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayIH->cell[jj][kk])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayIH->cell[jj][kk])->conductanceAtHalfVwLTD * maxLatencyLTD);
-									}
-								}
-							}
+			for (int l = 0; l < numLayers; l++) {
+				const double *input = l? &a[l-1][0] : &Input[i][0];
+				PROFILE_SCOPE(profiler, layers[l]->output? PHASE_UPDATE_HO : PHASE_UPDATE_IH);
+				if (param->useHardwareInTrainingWU) {
+					UpdateWeightHardware(layers[l], input, &s[l][0]);
+				}
+				else {
+					UpdateWeightAlgorithm(layers[l], input, &s[l][0]);
+				}
+			}
+
+			/*======================================PCM Operation===============================*/
+			if (param->useHardwareInTraining) {
+				std::vector<Layer*> pcmLayers;	// Layers of PCM (PCMON only exists on analog eNVM)
+				for (int l = 0; l < numLayers; l++) {
+					AnalogNVM *pcm = dynamic_cast<AnalogNVM*>(layers[l]->array->cell[0][0]);
+					if (pcm && pcm->PCMON) {
+						pcmLayers.push_back(layers[l]);
+					}
+				}
+				if (!pcmLayers.empty() && (batchSize + 1) % param->numImageperRESET == 0) {	// Occasional RESET every numImageperRESET images
+					PROFILE_SCOPE(profiler, PHASE_REFRESH);
+					std::mt19937 refreshGen;	// Random selection of the Line and Sporadic refresh, shared by the layers
+					refreshGen.seed((epoch + t) * numTrain + batchSize);	// Reproducible, with a different selection at every refresh
+					int batchNum = (batchSize + 1) / param->numImageperRESET;
+					for (int l = 0; l < pcmLayers.size(); l++) {
+						RefreshSelect(pcmLayers[l], batchNum, refreshGen);
+					}
+					for (int l = 0; l < pcmLayers.size(); l++) {
+						RefreshErase(pcmLayers[l]);
+					}
+					for (int l = 0; l < pcmLayers.size(); l++) {
+						RefreshReWrite(pcmLayers[l]);
+					}
+				}
+			}
+			PROFILE_WORK(profiler, 1, param->useHardwareInTrainingFF? param->numBitInput * numSynapses : 0,
+					param->useHardwareInTrainingWU? numSynapses : 0);
+		}
+		profiler.EndEpoch(epoch + t + 1);
+	}
+}
+
+/* Write the weight change -alpha*s[j]*input[k] of the layer to its array in batches of
+ * numWriteColMuxed columns per row of every tile, and add the write energy and latency of the array and its core */
+void Simulator::UpdateWeightHardware(Layer *layer, const double *input, const double *s) {
+	Array *array = layer->array;
+	SubArray *subArray = layer->subArray;
+	int numInput = layer->numInput;
+	int numOutput = layer->numOutput;
+	int tileRows = layer->tileRows;
+	int tileCols = layer->tileCols;
+	double vdd = layer->tech.vdd;
+	double sumArrayWriteEnergy[NUM_ARRAY_COSTS] = {0};   // Per component (see CostBreakdown.h). Use a temporary variable here since OpenMP does not support reduction on class member
+	double sumNeuroSimWriteEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
+	std::vector<double> sumWriteLatencyAnalogNVM(layer->numTileRow * layer->numTileCol, 0);	// Device write latency of analog eNVM of every tile, the tiles are written in parallel
+	double numWriteOperation = 0;	// Average number of write batches per row of a tile. Use a temporary variable here since OpenMP does not support reduction on class member
+	eNVM *device = dynamic_cast<eNVM*>(array->cell[0][0]);	// NULL for SRAM
+	double writeVoltageLTP = device? device->writeVoltageLTP : 0;
+	double writeVoltageLTD = device? device->writeVoltageLTD : 0;
+	int numBatchWriteSynapse = (int)ceil((double)tileCols / param->numWriteColMuxed);	// # of write synapses of a tile in a batch write operation
+#pragma omp parallel for reduction(+: sumArrayWriteEnergy[:NUM_ARRAY_COSTS], sumNeuroSimWriteEnergy, numWriteOperation)
+	for (int k = 0; k < numInput; k++) {
+		int rowStart = k / tileRows * tileRows;	// First row of the tile row
+		int rowEnd = std::min(rowStart + tileRows, numInput);
+		for (int colStart = 0; colStart < numOutput; colStart += tileCols) {	// The row in every tile of the tile row
+			int colEnd = std::min(colStart + tileCols, numOutput);
+			int numWriteOperationPerRow = 0;	// Number of write batches in a row that have any weight change
+			int numWriteCellPerOperation = 0;	// Average number of write cells per batch in a row (for digital eNVM)
+			double writeLatencyAnalogNVM = 0;	// Device write latency of analog eNVM of the row of the tile
+			for (int j = colStart; j < colEnd; j += numBatchWriteSynapse) {
+				PROFILE_SCOPE(profiler, PHASE_WRITE_BATCH);
+				/* Batch write */
+				int start = j;
+				int end = j + numBatchWriteSynapse - 1;
+				if (end >= colEnd) {
+					end = colEnd - 1;
+				}
+				double maxLatencyLTP = 0;	// Max latency for AnalogNVM's LTP or weight increase in this batch write
+				double maxLatencyLTD = 0;	// Max latency for AnalogNVM's LTD or weight decrease in this batch write
+				bool weightChangeBatch = false;	// Specify if there is any weight change in the entire write batch
+				for (int jj = start; jj <= end; jj++) { // Selected cells
+					layer->deltaWeight[jj][k] = -layer->alpha * s[jj] * input[k];
+					array->WriteCell(jj, k, layer->deltaWeight[jj][k], param->maxWeight, param->minWeight, true);
+					layer->weight[jj][k] = array->ConductanceToWeight(jj, k, param->maxWeight, param->minWeight);
+					if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[jj][k])) {	// Analog eNVM
+						weightChangeBatch = weightChangeBatch || static_cast<AnalogNVM*>(array->cell[jj][k])->numPulse;
+						/* Get maxLatencyLTP and maxLatencyLTD */
+						if (static_cast<AnalogNVM*>(array->cell[jj][k])->writeLatencyLTP > maxLatencyLTP)
+							maxLatencyLTP = static_cast<AnalogNVM*>(array->cell[jj][k])->writeLatencyLTP;
+						if (static_cast<AnalogNVM*>(array->cell[jj][k])->writeLatencyLTD > maxLatencyLTD)
+							maxLatencyLTD = static_cast<AnalogNVM*>(array->cell[jj][k])->writeLatencyLTD;
+					}
+					else {	// SRAM and digital eNVM
+						weightChangeBatch = weightChangeBatch || array->weightChange[jj][k];
+					}
+				}
+				numWriteOperationPerRow += weightChangeBatch;
+				for (int jj = start; jj <= end; jj++) { // Selected cells
+					if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[0][0])) {  // Analog eNVM
+						AnalogNVM *cell = static_cast<AnalogNVM*>(array->cell[jj][k]);
+						/* Set the max latency for all the selected cells in this batch */
+						cell->writeLatencyLTP = maxLatencyLTP;
+						cell->writeLatencyLTD = maxLatencyLTD;
+						if (param->writeEnergyReport && weightChangeBatch) {
+							if (cell->nonIdenticalPulse) {	// Non-identical write pulse scheme
+								if (cell->numPulse > 0) {	// LTP
+									cell->writeVoltageLTP = sqrt(cell->writeVoltageSquareSum / cell->numPulse);	// RMS value of LTP write voltage
+									cell->writeVoltageLTD = cell->VinitLTD + 0.5 * cell->VstepLTD * cell->maxNumLevelLTD;	// Use average voltage of LTD write voltage
+								}
+								else if (cell->numPulse < 0) {	// LTD
+									cell->writeVoltageLTP = cell->VinitLTP + 0.5 * cell->VstepLTP * cell->maxNumLevelLTP;    // Use average voltage of LTP write voltage
+									cell->writeVoltageLTD = sqrt(cell->writeVoltageSquareSum / (-1 * cell->numPulse));    // RMS value of LTD write voltage
+								}
+								else {	// Half-selected during LTP and LTD phases
+									cell->writeVoltageLTP = cell->VinitLTP + 0.5 * cell->VstepLTP * cell->maxNumLevelLTP;    // Use average voltage of LTP write voltage
+									cell->writeVoltageLTD = cell->VinitLTD + 0.5 * cell->VstepLTD * cell->maxNumLevelLTD;    // Use average voltage of LTD write voltage
+								}
+							}
+							cell->WriteEnergyCalculation(array->wireCapCol);
+							sumArrayWriteEnergy[COST_CELLS] += cell->writeEnergy;
 						}
-						else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayIH->cell[0][0])) { // Digital eNVM
-							if (!static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess && param->writeEnergyReport && weightChangeBatch) { // Cross-point
-								for (int jj = 0; jj < param->nHide; jj++) {    // Half-selected synapses in the same row
-									if (jj >= start && jj <= end) { continue; } // Skip the selected synapses
-									for (int n = 0; n < arrayIH->numCellPerSynapse; n++) {  // n=0 is LSB
-										int colIndex = (jj + 1) * arrayIH->numCellPerSynapse - (n + 1);
-										sumArrayWriteEnergy += writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayIH->cell[colIndex][k])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayIH->cell[colIndex][k])->conductanceAtHalfVwLTD * maxLatencyLTD;
-									}
-								}
-								for (int kk = 0; kk < param->nInput; kk++) {   // Half-selected synapses in other rows
-									// Note that here is a bit inaccurate if using OpenMP, because the weight on other rows (threads) are also being updated
-									if (kk == k) { continue; } // Skip the selected row
-									for (int jj = start; jj <= end; jj++) {
-										for (int n = 0; n < arrayIH->numCellPerSynapse; n++) {  // n=0 is LSB
-											int colIndex = (jj + 1) * arrayIH->numCellPerSynapse - (n + 1);
-											sumArrayWriteEnergy += writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayIH->cell[colIndex][kk])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayIH->cell[colIndex][kk])->conductanceAtHalfVwLTD * maxLatencyLTD;
-										}
-									}
+					}
+					else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(array->cell[0][0])) { // Digital eNVM
+						if (param->writeEnergyReport && array->weightChange[jj][k]) {
+							for (int n = 0; n < array->numCellPerSynapse; n++) {  // n=0 is LSB
+								DigitalNVM *cell = static_cast<DigitalNVM*>(array->cell[(jj + 1) * array->numCellPerSynapse - (n + 1)][k]);
+								sumArrayWriteEnergy[COST_CELLS] += cell->writeEnergy;
+								if (cell->bit != cell->bitPrev) {
+									numWriteCellPerOperation += 1;
 								}
 							}
 						}
 					}
-					/* Calculate the average number of write pulses on the selected row */
-#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-					{
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-							int sumNumWritePulse = 0;
-							for (int j = 0; j < param->nHide; j++) {
-								sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayIH->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
-							}
-							subArrayIH->numWritePulse = sumNumWritePulse / param->nHide;
-							double writeVoltageSquareSumRow = 0;
-							if (param->writeEnergyReport) {
-								if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->nonIdenticalPulse) { // Non-identical write pulse scheme
-									for (int j = 0; j < param->nHide; j++) {
-										writeVoltageSquareSumRow += static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeVoltageSquareSum;
-									}
-									if (sumNumWritePulse > 0) {	// Prevent division by 0
-										subArrayIH->cell.writeVoltage = sqrt(writeVoltageSquareSumRow / sumNumWritePulse);	// RMS value of write voltage in a row
-									}
-									else {
-										subArrayIH->cell.writeVoltage = 0;
-									}
-								}
-							}
+					else {    // SRAM
+						if (param->writeEnergyReport && array->weightChange[jj][k]) {
+							sumArrayWriteEnergy[COST_CELLS] += static_cast<SRAM*>(array->cell[jj * array->numCellPerSynapse][k])->writeEnergy;
 						}
-						numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-						sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayIH, numWriteOperationPerRow, numWriteCellPerOperation);
 					}
-					numWriteOperation += numWriteOperationPerRow;
 				}
-				arrayIH->writeEnergy += sumArrayWriteEnergy;
-				subArrayIH->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-				numWriteOperation = numWriteOperation / param->nInput;
-				subArrayIH->writeLatency += NeuroSimSubArrayWriteLatency(subArrayIH, numWriteOperation, sumWriteLatencyAnalogNVM);
-			}
-			else {
-#pragma omp parallel for
-				for (int j = 0; j < param->nHide; j++) {
-					for (int k = 0; k < param->nInput; k++) {
-						deltaWeight1[j][k] = -param->alpha1 * s1[j] * Input[i][k];
-						weight1[j][k] = weight1[j][k] + deltaWeight1[j][k];
-						if (weight1[j][k] > param->maxWeight) {
-							deltaWeight1[j][k] -= weight1[j][k] - param->maxWeight;
-							weight1[j][k] = param->maxWeight;
-						}
-						else if (weight1[j][k] < param->minWeight) {
-							deltaWeight1[j][k] += param->minWeight - weight1[j][k];
-							weight1[j][k] = param->minWeight;
+				/* Latency for each batch write in Analog eNVM */
+				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[0][0])) {	// Analog eNVM
+					writeLatencyAnalogNVM += maxLatencyLTP + maxLatencyLTD;
+				}
+				/* Energy consumption on array caps for eNVM */
+				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[0][0])) {  // Analog eNVM
+					if (param->writeEnergyReport && weightChangeBatch) {
+						if (static_cast<AnalogNVM*>(array->cell[0][0])->nonIdenticalPulse) { // Non-identical write pulse scheme
+							writeVoltageLTP = static_cast<AnalogNVM*>(array->cell[0][0])->VinitLTP + 0.5 * static_cast<AnalogNVM*>(array->cell[0][0])->VstepLTP * static_cast<AnalogNVM*>(array->cell[0][0])->maxNumLevelLTP;    // Use average voltage of LTP write voltage
+							writeVoltageLTD = static_cast<AnalogNVM*>(array->cell[0][0])->VinitLTD + 0.5 * static_cast<AnalogNVM*>(array->cell[0][0])->VstepLTD * static_cast<AnalogNVM*>(array->cell[0][0])->maxNumLevelLTD;    // Use average voltage of LTD write voltage
+						}
+						if (static_cast<eNVM*>(array->cell[0][0])->cmosAccess) {  // 1T1R
+							// The energy on selected SLs is included in WriteCell()
+							sumArrayWriteEnergy[COST_SELECTED_LINES] += array->wireGateCapRow * vdd * vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
+							sumArrayWriteEnergy[COST_SELECTED_LINES] += array->wireCapRow * writeVoltageLTP * writeVoltageLTP;   // Selected BL (LTP phases)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapCol * writeVoltageLTP * writeVoltageLTP * (tileCols - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
+							// No LTD part because all unselected rows and columns are V=0
 						}
-						if (param->useHardwareInTrainingFF) {
-							arrayIH->WriteCell(j, k, deltaWeight1[j][k], param->maxWeight, param->minWeight, false);
+						else {
+							sumArrayWriteEnergy[COST_SELECTED_LINES] += array->wireCapRow * writeVoltageLTP * writeVoltageLTP;    // Selected WL (LTP phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapRow * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (tileRows - 1);  // Unselected WLs (LTP phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapCol * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (tileCols - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapRow * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (tileRows - 1);    // Unselected WLs (LTD phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapCol * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (tileCols - numBatchWriteSynapse); // Unselected BLs (LTD phase)
 						}
 					}
 				}
-			}
-
-			/* Update weight of the second layer (hidden layer to the output layer) */
-			if (param->useHardwareInTrainingWU) {
-				double sumArrayWriteEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-				double sumNeuroSimWriteEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
-				double sumWriteLatencyAnalogNVM = 0;	// Use a temporary variable here since OpenMP does not support reduction on class member
-				double numWriteOperation = 0;	// Average number of write batches in the whole array. Use a temporary variable here since OpenMP does not support reduction on class member
-				double writeVoltageLTP = static_cast<eNVM*>(arrayHO->cell[0][0])->writeVoltageLTP;
-				double writeVoltageLTD = static_cast<eNVM*>(arrayHO->cell[0][0])->writeVoltageLTD;
-				double writePulseWidthLTP = static_cast<eNVM*>(arrayHO->cell[0][0])->writePulseWidthLTP;
-				double writePulseWidthLTD = static_cast<eNVM*>(arrayHO->cell[0][0])->writePulseWidthLTD;
-				numBatchWriteSynapse = (int)ceil((double)arrayHO->arrayColSize / param->numWriteColMuxed);
-				#pragma omp parallel for reduction(+: sumArrayWriteEnergy, sumNeuroSimWriteEnergy, sumWriteLatencyAnalogNVM)
-				for (int k = 0; k < param->nHide; k++) {
-					int numWriteOperationPerRow = 0;    // Number of write batches in a row that have any weight change
-					int numWriteCellPerOperation = 0;   // Average number of write cells per batch in a row (for digital eNVM)
-					for (int j = 0; j < param->nOutput; j += numBatchWriteSynapse) {
-						/* Batch write */
-						int start = j;
-						int end = j + numBatchWriteSynapse - 1;
-						if (end >= param->nOutput) {
-							end = param->nOutput - 1;
-						}
-						double maxLatencyLTP = 0;   // Max latency for AnalogNVM's LTP or weight increase in this batch write
-						double maxLatencyLTD = 0;   // Max latency for AnalogNVM's LTD or weight decrease in this batch write
-						bool weightChangeBatch = false; // Specify if there is any weight change in the entire write batch
-						for (int jj = start; jj <= end; jj++) { // Selected cells
-							deltaWeight2[jj][k] = -param->alpha2 * s2[jj] * a1[k];
-							arrayHO->WriteCell(jj, k, deltaWeight2[jj][k], param->maxWeight, param->minWeight, true);
-							//double conductanceGp = static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->conductanceGp;
-							//std::cout << conductanceGp << std::endl;
-							weight2[jj][k] = arrayHO->ConductanceToWeight(jj, k, param->maxWeight, param->minWeight);//+deltaWeight2[jj][k];
-							//weight2[jj][k] += deltaWeight2[jj][k];
-							if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[jj][k])) { // Analog eNVM
-								weightChangeBatch = weightChangeBatch || static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->numPulse;
-								/* Get maxLatencyLTP and maxLatencyLTD */
-								if (static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeLatencyLTP > maxLatencyLTP)
-									maxLatencyLTP = static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeLatencyLTP;
-								if (static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeLatencyLTD > maxLatencyLTD)
-									maxLatencyLTD = static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeLatencyLTD;
-							}
-							else {    // SRAM and digital eNVM
-								weightChangeBatch = weightChangeBatch || arrayHO->weightChange[jj][k];
-							}
-						}
-						numWriteOperationPerRow += weightChangeBatch;
-						for (int jj = start; jj <= end; jj++) { // Selected cells
-							if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-								/* Set the max latency for all the cells in this batch */
-								static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeLatencyLTP = maxLatencyLTP;
-								static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeLatencyLTD = maxLatencyLTD;
-								if (param->writeEnergyReport && weightChangeBatch) {
-									if (static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->nonIdenticalPulse) { // Non-identical write pulse scheme
-										if (static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->numPulse > 0) {  // LTP
-											static_cast<eNVM*>(arrayHO->cell[jj][k])->writeVoltageLTP = sqrt(static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeVoltageSquareSum / static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->numPulse);   // RMS value of LTP write voltage
-											static_cast<eNVM*>(arrayHO->cell[jj][k])->writeVoltageLTD = static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VinitLTD + 0.5 * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VstepLTD * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->maxNumLevelLTD;    // Use average voltage of LTD write voltage
-										}
-										else if (static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->numPulse < 0) {    // LTD
-											static_cast<eNVM*>(arrayHO->cell[jj][k])->writeVoltageLTP = static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VinitLTP + 0.5 * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VstepLTP * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->maxNumLevelLTP;    // Use average voltage of LTP write voltage
-											static_cast<eNVM*>(arrayHO->cell[jj][k])->writeVoltageLTD = sqrt(static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->writeVoltageSquareSum / (-1 * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->numPulse));    // RMS value of LTD write voltage
-										}
-										else {	// Half-selected during LTP and LTD phases
-											static_cast<eNVM*>(arrayHO->cell[jj][k])->writeVoltageLTP = static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VinitLTP + 0.5 * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VstepLTP * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->maxNumLevelLTP;    // Use average voltage of LTP write voltage
-											static_cast<eNVM*>(arrayHO->cell[jj][k])->writeVoltageLTD = static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VinitLTD + 0.5 * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->VstepLTD * static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->maxNumLevelLTD;    // Use average voltage of LTD write voltage
-										}
-									}
-									static_cast<AnalogNVM*>(arrayHO->cell[jj][k])->WriteEnergyCalculation(arrayHO->wireCapCol);
-									sumArrayWriteEnergy += static_cast<eNVM*>(arrayHO->cell[jj][k])->writeEnergy;
-								}
-							}
-							else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayHO->cell[0][0])) { // Digital eNVM
-								if (param->writeEnergyReport && arrayHO->weightChange[jj][k]) {
-									for (int n = 0; n < arrayHO->numCellPerSynapse; n++) {  // n=0 is LSB
-										sumArrayWriteEnergy += static_cast<DigitalNVM*>(arrayHO->cell[(jj + 1) * arrayHO->numCellPerSynapse - (n + 1)][k])->writeEnergy;
-										int bitPrev = static_cast<DigitalNVM*>(arrayHO->cell[(jj + 1) * arrayHO->numCellPerSynapse - (n + 1)][k])->bitPrev;
-										int bit = static_cast<DigitalNVM*>(arrayHO->cell[(jj + 1) * arrayHO->numCellPerSynapse - (n + 1)][k])->bit;
-										if (bit != bitPrev) {
-											numWriteCellPerOperation += 1;
-										}
-									}
-								}
-							}
-							else {    // SRAM
-								if (param->writeEnergyReport && arrayHO->weightChange[jj][k]) {
-									sumArrayWriteEnergy += static_cast<SRAM*>(arrayHO->cell[jj * arrayHO->numCellPerSynapse][k])->writeEnergy;
-								}
-							}
+				else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(array->cell[0][0])) { // Digital eNVM
+					if (param->writeEnergyReport && weightChangeBatch) {
+						if (static_cast<eNVM*>(array->cell[0][0])->cmosAccess) {  // 1T1R
+							// The energy on selected columns is included in WriteCell()
+							sumArrayWriteEnergy[COST_SELECTED_LINES] += array->wireGateCapRow * vdd * vdd * 2;   // Selected WL (*2 for both SET and RESET phases)
 						}
-						/* Latency for each batch write in Analog eNVM */
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-							sumWriteLatencyAnalogNVM += maxLatencyLTP + maxLatencyLTD;
+						else {    // Cross-point
+							sumArrayWriteEnergy[COST_SELECTED_LINES] += array->wireCapRow * writeVoltageLTP * writeVoltageLTP;   // Selected WL (SET phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapRow * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (tileRows - 1);    // Unselected WLs (SET phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapCol * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (tileCols - numBatchWriteSynapse) * array->numCellPerSynapse;   // Unselected BLs (SET phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapRow * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (tileRows - 1);   // Unselected WLs (RESET phase)
+							sumArrayWriteEnergy[COST_UNSELECTED_LINES] += array->wireCapCol * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (tileCols - numBatchWriteSynapse) * array->numCellPerSynapse;   // Unselected BLs (RESET phase)
 						}
-						/* Energy consumption on array caps for eNVM */
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-							if (param->writeEnergyReport && weightChangeBatch) {
-								if (static_cast<AnalogNVM*>(arrayHO->cell[0][0])->nonIdenticalPulse) { // Non-identical write pulse scheme
-									writeVoltageLTP = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->VinitLTP + 0.5 * static_cast<AnalogNVM*>(arrayHO->cell[0][0])->VstepLTP * static_cast<AnalogNVM*>(arrayHO->cell[0][0])->maxNumLevelLTP;    // Use average voltage of LTP write voltage
-									writeVoltageLTD = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->VinitLTD + 0.5 * static_cast<AnalogNVM*>(arrayHO->cell[0][0])->VstepLTD * static_cast<AnalogNVM*>(arrayHO->cell[0][0])->maxNumLevelLTD;    // Use average voltage of LTD write voltage
-								}
-								if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-									// The energy on selected SLs is included in WriteCell()
-									sumArrayWriteEnergy += arrayHO->wireGateCapRow * techHO.vdd * techHO.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-									sumArrayWriteEnergy += arrayHO->wireCapRow * writeVoltageLTP * writeVoltageLTP;   // Selected BL (LTP phases)
-									sumArrayWriteEnergy += arrayHO->wireCapCol * writeVoltageLTP * writeVoltageLTP * (param->nOutput - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-									// No LTD part because all unselected rows and columns are V=0
-								}
-								else {
-									sumArrayWriteEnergy += arrayHO->wireCapRow * writeVoltageLTP * writeVoltageLTP;   // Selected WL (LTP phase)
-									sumArrayWriteEnergy += arrayHO->wireCapRow * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nHide - 1);    // Unselected WLs (LTP phase)
-									sumArrayWriteEnergy += arrayHO->wireCapCol * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nOutput - numBatchWriteSynapse); // Unselected BLs (LTP phase)
-									sumArrayWriteEnergy += arrayHO->wireCapRow * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nHide - 1);    // Unselected WLs (LTD phase)
-									sumArrayWriteEnergy += arrayHO->wireCapCol * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nOutput - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-								}
-							}
+					}
+				}
+				/* Half-selected cells for eNVM */
+				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[0][0])) {  // Analog eNVM
+					if (!static_cast<eNVM*>(array->cell[0][0])->cmosAccess && param->writeEnergyReport) { // Cross-point
+						for (int jj = colStart; jj < colEnd; jj++) { // Half-selected cells in the same row of the tile
+							if (jj >= start && jj <= end) { continue; } // Skip the selected cells
+							sumArrayWriteEnergy[COST_HALF_SELECTED_CELLS] += (writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(array->cell[jj][k])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(array->cell[jj][k])->conductanceAtHalfVwLTD * maxLatencyLTD);
 						}
-						else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayHO->cell[0][0])) { // Digital eNVM
-							if (param->writeEnergyReport && weightChangeBatch) {
-								if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-									// The energy on selected columns is included in WriteCell()
-									sumArrayWriteEnergy += arrayHO->wireGateCapRow * techHO.vdd * techHO.vdd * 2;   // Selected WL (*2 for both SET and RESET phases)
-								}
-								else {    // Cross-point
-									sumArrayWriteEnergy += arrayHO->wireCapRow * writeVoltageLTP * writeVoltageLTP;   // Selected WL (SET phase)
-									sumArrayWriteEnergy += arrayHO->wireCapRow * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nInput - 1);    // Unselected WLs (SET phase)
-									sumArrayWriteEnergy += arrayHO->wireCapCol * writeVoltageLTP / 2 * writeVoltageLTP / 2 * (param->nHide - numBatchWriteSynapse) * arrayHO->numCellPerSynapse;  // Unselected BLs (SET phase)
-									sumArrayWriteEnergy += arrayHO->wireCapRow * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nInput - 1);  // Unselected WLs (RESET phase)
-									sumArrayWriteEnergy += arrayHO->wireCapCol * writeVoltageLTD / 2 * writeVoltageLTD / 2 * (param->nHide - numBatchWriteSynapse) * arrayHO->numCellPerSynapse;  // Unselected BLs (RESET phase)
-								}
+						for (int kk = rowStart; kk < rowEnd; kk++) {    // Half-selected cells in other rows of the tile
+							// Note that here is a bit inaccurate if using OpenMP, because the weight on other rows (threads) are also being updated
+							if (kk == k) { continue; } // Skip the selected row
+							for (int jj = start; jj <= end; jj++) {
+								sumArrayWriteEnergy[COST_HALF_SELECTED_CELLS] += (writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(array->cell[jj][kk])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(array->cell[jj][kk])->conductanceAtHalfVwLTD * maxLatencyLTD);
 							}
 						}
-						/* Half-selected cells for eNVM */
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-							if (!static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess && param->writeEnergyReport) { // Cross-point
-								for (int jj = 0; jj < param->nOutput; jj++) {    // Half-selected cells in the same row
-									if (jj >= start && jj <= end) { continue; } // Skip the selected cells
-									sumArrayWriteEnergy += (writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayHO->cell[jj][k])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayHO->cell[jj][k])->conductanceAtHalfVwLTD * maxLatencyLTD);
-								}
-								for (int kk = 0; kk < param->nHide; kk++) { // Half-selected cells in other rows
-									// Note that here is a bit inaccurate if using OpenMP, because the weight on other rows (threads) are also being updated
-									if (kk == k) { continue; }  // Skip the selected row
-									for (int jj = start; jj <= end; jj++) {
-										sumArrayWriteEnergy += (writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayHO->cell[jj][kk])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayHO->cell[jj][kk])->conductanceAtHalfVwLTD * maxLatencyLTD);
-									}
-								}
+					}
+				}
+				else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(array->cell[0][0])) { // Digital eNVM
+					if (!static_cast<eNVM*>(array->cell[0][0])->cmosAccess && param->writeEnergyReport && weightChangeBatch) { // Cross-point
+						for (int jj = colStart; jj < colEnd; jj++) {    // Half-selected synapses in the same row of the tile
+							if (jj >= start && jj <= end) { continue; } // Skip the selected synapses
+							for (int n = 0; n < array->numCellPerSynapse; n++) {  // n=0 is LSB
+								int colIndex = (jj + 1) * array->numCellPerSynapse - (n + 1);
+								sumArrayWriteEnergy[COST_HALF_SELECTED_CELLS] += writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(array->cell[colIndex][k])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(array->cell[colIndex][k])->conductanceAtHalfVwLTD * maxLatencyLTD;
 							}
 						}
-						else if (DigitalNVM *temp = dynamic_cast<DigitalNVM*>(arrayHO->cell[0][0])) { // Digital eNVM
-							if (!static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess && param->writeEnergyReport && weightChangeBatch) { // Cross-point
-								for (int jj = 0; jj < param->nOutput; jj++) {    // Half-selected synapses in the same row
-									if (jj >= start && jj <= end) { continue; } // Skip the selected synapses
-									for (int n = 0; n < arrayHO->numCellPerSynapse; n++) {  // n=0 is LSB
-										int colIndex = (jj + 1) * arrayHO->numCellPerSynapse - (n + 1);
-										sumArrayWriteEnergy += writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayHO->cell[colIndex][k])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayHO->cell[colIndex][k])->conductanceAtHalfVwLTD * maxLatencyLTD;
-									}
-								}
-								for (int kk = 0; kk < param->nHide; kk++) {    // Half-selected synapses in other rows
-									// Note that here is a bit inaccurate if using OpenMP, because the weight on other rows (threads) are also being updated
-									if (kk == k) { continue; }  // Skip the selected row
-									for (int jj = start; jj <= end; jj++) {
-										for (int n = 0; n < arrayHO->numCellPerSynapse; n++) {  // n=0 is LSB
-											int colIndex = (jj + 1) * arrayHO->numCellPerSynapse - (n + 1);
-											sumArrayWriteEnergy += writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(arrayHO->cell[colIndex][kk])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(arrayHO->cell[colIndex][kk])->conductanceAtHalfVwLTD * maxLatencyLTD;
-										}
-									}
+						for (int kk = rowStart; kk < rowEnd; kk++) {   // Half-selected synapses in other rows of the tile
+							// Note that here is a bit inaccurate if using OpenMP, because the weight on other rows (threads) are also being updated
+							if (kk == k) { continue; } // Skip the selected row
+							for (int jj = start; jj <= end; jj++) {
+								for (int n = 0; n < array->numCellPerSynapse; n++) {  // n=0 is LSB
+									int colIndex = (jj + 1) * array->numCellPerSynapse - (n + 1);
+									sumArrayWriteEnergy[COST_HALF_SELECTED_CELLS] += writeVoltageLTP / 2 * writeVoltageLTP / 2 * static_cast<eNVM*>(array->cell[colIndex][kk])->conductanceAtHalfVwLTP * maxLatencyLTP + writeVoltageLTD / 2 * writeVoltageLTD / 2 * static_cast<eNVM*>(array->cell[colIndex][kk])->conductanceAtHalfVwLTD * maxLatencyLTD;
 								}
 							}
 						}
 					}
-					/* Calculate the average number of write pulses on the selected row */
+				}
+			}
+			/* Calculate the average number of write pulses on the selected row */
 #pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-					{
-						if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-							int sumNumWritePulse = 0;
-							for (int j = 0; j < param->nOutput; j++) {
-								sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayHO->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
+			{
+				PROFILE_SCOPE(profiler, PHASE_NEUROSIM_WRITE);
+				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(array->cell[0][0])) {  // Analog eNVM
+					int sumNumWritePulse = 0;
+					for (int j = colStart; j < colEnd; j++) {
+						sumNumWritePulse += abs(static_cast<AnalogNVM*>(array->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
+					}
+					subArray->numWritePulse = sumNumWritePulse / (colEnd - colStart);
+					telemetry.WritePulses(layer->index, array, k, colStart, colEnd);
+					double writeVoltageSquareSumRow = 0;
+					if (param->writeEnergyReport) {
+						if (static_cast<AnalogNVM*>(array->cell[0][0])->nonIdenticalPulse) { // Non-identical write pulse scheme
+							for (int j = colStart; j < colEnd; j++) {
+								writeVoltageSquareSumRow += static_cast<AnalogNVM*>(array->cell[j][k])->writeVoltageSquareSum;
 							}
-							subArrayHO->numWritePulse = sumNumWritePulse / param->nOutput;
-							double writeVoltageSquareSumRow = 0;
-							if (param->writeEnergyReport) {
-								if (static_cast<AnalogNVM*>(arrayHO->cell[0][0])->nonIdenticalPulse) { // Non-identical write pulse scheme
-									for (int j = 0; j < param->nOutput; j++) {
-										writeVoltageSquareSumRow += static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeVoltageSquareSum;
-									}
-									if (sumNumWritePulse > 0) {	// Prevent division by 0
-										subArrayHO->cell.writeVoltage = sqrt(writeVoltageSquareSumRow / sumNumWritePulse);  // RMS value of write voltage in a row
-									}
-									else {
-										subArrayHO->cell.writeVoltage = 0;
-									}
-								}
+							if (sumNumWritePulse > 0) {	// Prevent division by 0
+								subArray->cell.writeVoltage = sqrt(writeVoltageSquareSumRow / sumNumWritePulse);	// RMS value of write voltage in a row
+							}
+							else {
+								subArray->cell.writeVoltage = 0;
 							}
 						}
-						numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-						sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayHO, numWriteOperationPerRow, numWriteCellPerOperation);
 					}
-					numWriteOperation += numWriteOperationPerRow;
 				}
-
-				arrayHO->writeEnergy += sumArrayWriteEnergy;
-				subArrayHO->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-				numWriteOperation = numWriteOperation / param->nHide;
-				subArrayHO->writeLatency += NeuroSimSubArrayWriteLatency(subArrayHO, numWriteOperation, sumWriteLatencyAnalogNVM);
+				numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
+				sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArray, numWriteOperationPerRow, numWriteCellPerOperation);
+				layer->cost.AddSubArrayWriteEnergy(subArray);
+				activityTrace.WriteRow(layer->index, subArray, numWriteOperationPerRow, numWriteCellPerOperation);
+				sumWriteLatencyAnalogNVM[rowStart / tileRows * layer->numTileCol + colStart / tileCols] += writeLatencyAnalogNVM;
 			}
-			else {
+			numWriteOperation += numWriteOperationPerRow;
+		}
+	}
+	array->writeEnergy += ArrayCost(sumArrayWriteEnergy);
+	for (int c = 0; c < NUM_ARRAY_COSTS; c++) {
+		layer->cost.writeEnergy[c] += sumArrayWriteEnergy[c];
+	}
+	subArray->writeDynamicEnergy += sumNeuroSimWriteEnergy;
+	numWriteOperation = numWriteOperation / (numInput * layer->numTileCol);
+	double maxWriteLatencyAnalogNVM = *std::max_element(sumWriteLatencyAnalogNVM.begin(), sumWriteLatencyAnalogNVM.end());	// The slowest tile
+	double writeLatency = NeuroSimSubArrayWriteLatency(subArray, numWriteOperation, maxWriteLatencyAnalogNVM);
+	subArray->writeLatency += writeLatency;
+	layer->cost.AddSubArrayWriteLatency(subArray, writeLatency, COST_CELLS);
+	activityTrace.WriteArray(layer->index, subArray, numWriteOperation, maxWriteLatencyAnalogNVM);
+}
+
+/* Apply the weight change -alpha*s[j]*input[k] in the algorithm, clipped to [minWeight, maxWeight]
+ * (and to the array without any cost if only the feed forward uses the hardware) */
+void Simulator::UpdateWeightAlgorithm(Layer *layer, const double *input, const double *s) {
 #pragma omp parallel for
-				for (int j = 0; j < param->nOutput; j++) {
-					for (int k = 0; k < param->nHide; k++) {
-						deltaWeight2[j][k] = -param->alpha2 * s2[j] * a1[k];
-						weight2[j][k] = weight2[j][k] + deltaWeight2[j][k];
-						if (weight2[j][k] > param->maxWeight) {
-							deltaWeight2[j][k] -= weight2[j][k] - param->maxWeight;
-							weight2[j][k] = param->maxWeight;
-						}
-						else if (weight2[j][k] < param->minWeight) {
-							deltaWeight2[j][k] += param->minWeight - weight2[j][k];
-							weight2[j][k] = param->minWeight;
-						}
-						if (param->useHardwareInTrainingFF) {
-							arrayHO->WriteCell(j, k, deltaWeight2[j][k], param->maxWeight, param->minWeight, false);
-						}
-					}
-				}
+	for (int j = 0; j < layer->numOutput; j++) {
+		for (int k = 0; k < layer->numInput; k++) {
+			double& weight = layer->weight[j][k];
+			double& deltaWeight = layer->deltaWeight[j][k];
+			deltaWeight = -layer->alpha * s[j] * input[k];
+			weight = weight + deltaWeight;
+			if (weight > param->maxWeight) {
+				deltaWeight -= weight - param->maxWeight;
+				weight = param->maxWeight;
 			}
-			/*======================================PCM Operation===============================*/
-
-			if (param->useHardwareInTraining) {
-				if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->PCMON) {
-					if (((batchSize + 1) % param->numImageperRESET == 0)) { //occational RESET numImageperRESET=100
-						if (param->RandomRefresh) { //Refresh random cell			
-							// Line  Refresh 
-							/*Read All first Layer*/
-							if(param->mode == 0){ // Line mode
-								std::mt19937 Randgen;
-								Randgen.seed(std::time(0));
-								double RandNum = 0;
-								int Ref[param->nHide];
-								int count1 = 0;
-								int num1, num2, temp = 0;
-								std::uniform_real_distribution<double> dist(0, 1);
-								std::uniform_int_distribution<int> distIH(0, param->nHide - 1);
-								std::fill_n(Ref, param->nHide, 0);
-								double maxConductance = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->maxConductance;
-								double ResetThr = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->ThrConductance;
-								double sumArrayReadEnergy = 0; // Read Energy  ӽ 
-								double readVoltage = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readVoltage;
-								double readPulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readPulseWidth;
-								#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-								for (int j = 0; j < param->nHide; j++) {
-									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) { //Analog PCM
-										if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->cmosAccess) { //1T1R
-											sumArrayReadEnergy += arrayIH->wireCapRow*techIH.vdd*techIH.vdd*param->nInput;// All WLs open
-										}
-									}
-									Ref[j] = j;
-								}
-								for (int a = 0; a < param->NumRefHiddenLayer * 100; a++) { //Shuffle 
-									num1 = distIH(Randgen);
-									num2 = distIH(Randgen);
-									temp = Ref[num1];
-									Ref[num1] = Ref[num2];
-									Ref[num2] = temp;
-								}
-								for (int k = 0; k < param->nInput; k++) {
-									for (int j = 0; j < param->nHide; j++) {
-										//std::cout << RandNum << std::endl;
-										for (int a = 0; a < param->NumRefHiddenLayer; a++) {
-											if (j == Ref[a]) {
-												static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = true;
-											
-											}
-										}
-									}
-
-								}
-								//std::cout << count1 << std::endl;
-								//std::cout << count1 << std :: endl;
-								/*Read Second Layer*/
-								int Ref2[param->nOutput];
-								int count2 = 0;
-								num1, num2, temp = 0;
-								//std::uniform_real_distribution<double> dist(0, 1);
-								std::uniform_int_distribution<int> distIH2(0, param->nOutput - 1);
-								std::fill_n(Ref2, param->nOutput, 0);
-								maxConductance = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->maxConductance;
-								ResetThr = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->ThrConductance;
-								sumArrayReadEnergy = 0; // Read Energy  ӽ 
-								readVoltage = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->readVoltage;
-								readPulseWidth = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->readPulseWidth;
-#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-								for (int j = 0; j < param->nOutput; j++) {
-									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) { //Analog PCM
-										if (static_cast<AnalogNVM*>(arrayHO->cell[0][0])->cmosAccess) { //1T1R
-											sumArrayReadEnergy += arrayHO->wireCapRow*techIH.vdd*techIH.vdd*param->nHide;// All WLs open
-										}
-									}
-									Ref2[j] = j;
-								}
-								for (int a = 0; a < param->NumRefOutputLayer * 100; a++) { //Shuffle 
-									num1 = distIH2(Randgen);
-									num2 = distIH2(Randgen);
-									temp = Ref2[num1];
-									Ref2[num1] = Ref2[num2];
-									Ref2[num2] = temp;
-								}
-								for (int k = 0; k < param->nHide; k++) {
-									for (int j = 0; j < param->nOutput; j++) {
-										//std::cout << RandNum << std::endl;
-										for (int a = 0; a < param->NumRefOutputLayer; a++) {
-											if (j == Ref2[a]) {
-												static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = true;
-												//count2+=1;
-											}
-										}
-
-
-
-									}
-
-								}
-								//std::cout << count2 << std::endl;
-								arrayHO->readEnergy += sumArrayReadEnergy;
-								// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-								subArrayHO->activityRowRead = 1;
-								subArrayHO->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayHO);
-								subArrayHO->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayHO, adderIH, muxIH, muxDecoderIH, dffIH);
-								subArrayHO->readLatency += NeuroSimSubArrayReadLatency(subArrayHO);
-								subArrayHO->readLatency += NeuroSimNeuronReadLatency(subArrayHO, adderIH, muxIH, muxDecoderIH, dffIH);
-							}
-							else if (param->mode == 1) { // Sporadic
-								std::mt19937 Randgen;
-								Randgen.seed(std::time(0));
-								double RandNum = 0;
-								int count1 = 0;
-								std::uniform_real_distribution<double> dist(0, 1);
-								double maxConductance = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->maxConductance;
-								double ResetThr = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->ThrConductance;
-								double sumArrayReadEnergy = 0; // Read Energy  ӽ 
-								double readVoltage = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readVoltage;
-								double readPulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readPulseWidth;
-									#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-								for (int j = 0; j < param->nHide; j++) {
-									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) { //Analog PCM
-										if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->cmosAccess) { //1T1R
-											sumArrayReadEnergy += arrayIH->wireCapRow*techIH.vdd*techIH.vdd*param->nInput;// All WLs open
-										}
-									}
-									for (int n = 0; n < param->numBitInput; n++) {
-										double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1)*arrayIH->arrayRowSize; // numInputLevel= 2 (black or white)
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {
-											double Isum = 0; // weight sum current
-											double IsumMax = 0; //Max weight sum current
-											double inputSum = 0;  // weight sum current of input vector
-											for (int k = 0; k < param->nInput; k++) {
-												RandNum = dist(Randgen);
-												Isum += arrayIH->ReadCell(j, k);
-												if (RandNum < param->ActDeviceIH) {
-													static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = true;
-												}
-												else {
-													static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = false;
-												}
-											}
-											sumArrayReadEnergy += Isum * readVoltage*readPulseWidth; //Read energy  
-										}
-
-									}
-								}
-								arrayIH->readEnergy += sumArrayReadEnergy;
-								// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-								subArrayIH->activityRowRead = 1;
-								subArrayIH->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayIH);
-								subArrayIH->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-								subArrayIH->readLatency += NeuroSimSubArrayReadLatency(subArrayIH);
-								subArrayIH->readLatency += NeuroSimNeuronReadLatency(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-
-								/*Read All Second Layer*/
-								maxConductance = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->maxConductance;
-								ResetThr = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->ThrConductance;
-								sumArrayReadEnergy = 0; // Read Energy  ӽ 
-								readVoltage = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->readVoltage;
-								readPulseWidth = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->readPulseWidth;
-#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-								for (int j = 0; j < param->nOutput; j++) {
-									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) { //Analog PCM
-										if (static_cast<AnalogNVM*>(arrayHO->cell[0][0])->cmosAccess) { //1T1R
-											sumArrayReadEnergy += arrayHO->wireCapRow*techIH.vdd*techIH.vdd*param->nInput;// All WLs open
-										}
-									}
-									for (int n = 0; n < param->numBitInput; n++) {
-										double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1)*(arrayHO->arrayRowSize); // numInputLevel= 2 (black or white)
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {
-											RandNum = dist(Randgen);
-											double Isum = 0; // weight sum current
-											double IsumMax = 0; //Max weight sum current
-											double inputSum = 0;  // weight sum current of input vector
-											for (int k = 0; k < param->nHide; k++) {
-												//std::cout << RandNum
-												Isum += arrayHO->ReadCell(j, k);
-												if (RandNum < param->ActDeviceHO) {
-													static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = true;
-												}
-												else {
-													static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = false;
-												}
-												/*	else
-													{
-														static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = false;
-
-													}*/
-											}
-											sumArrayReadEnergy += Isum * readVoltage*readPulseWidth;
-										}
-
-									}
-								}
-								arrayHO->readEnergy += sumArrayReadEnergy;
-								// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-								subArrayHO->activityRowRead = 1;
-								subArrayHO->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayIH);
-								subArrayHO->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-								subArrayHO->readLatency += NeuroSimSubArrayReadLatency(subArrayIH);
-								subArrayHO->readLatency += NeuroSimNeuronReadLatency(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-							}
-							else if (param->mode == 2) { // Sequential
-							int count1 = 0;
-							int batchNum = (batchSize + 1) / param->numImageperRESET;
-							double maxConductance = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->maxConductance;
-							double ResetThr = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->ThrConductance;
-							double sumArrayReadEnergy = 0; // Read Energy  ӽ 
-							double readVoltage = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readVoltage;
-							double readPulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readPulseWidth;
-							int RefStart;
-							int RefEnd;
-						
-							int RefLayer[param->NumRefHiddenLayer];
-							std::fill_n(RefLayer, param->NumRefHiddenLayer, 0);
-							RefStart = (batchNum*param->NumRefHiddenLayer);
-							//std::cout << RefStart << std::endl;
-							RefEnd = ((batchSize + 1)*param->NumRefHiddenLayer);
-							for (int i = 0; i < param->NumRefHiddenLayer; i++) {
-								RefLayer[i] = (RefStart + i)%param->nHide;
-								//std::cout << RefLayer[i] << std::endl;
-							}
-								#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-							for (int j = 0; j < param->nHide; j++) {
-								if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) { //Analog PCM
-									if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->cmosAccess) { //1T1R
-										sumArrayReadEnergy += arrayIH->wireCapRow*techIH.vdd*techIH.vdd*param->nInput;// All WLs open
-									}
-								}
-							}
-							for (int k = 0; k < param->nInput; k++) {
-								for (int j = 0; j < param->nHide; j++) {
-									//std::cout << RandNum << std::endl;
-									for (int a = 0; a < param->NumRefHiddenLayer; a++) {
-										if (j == RefLayer[a]) {
-										
-											static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = true;
-											//count1 += 1;
-											//std::cout << j<<std::endl;
-										}
-									}
-
-								}
-
-							}
-							//std::cout << count1 << std::endl;
-							//std::cout << count1 << std :: endl;
-							/*Read Second Layer*/
-							RefStart;
-							RefEnd;
-							int RefLayer2[param->NumRefOutputLayer];
-						
-							std::fill_n(RefLayer2, param->NumRefOutputLayer, 0);
-							RefStart = (batchNum*param->NumRefOutputLayer);
-							RefEnd = ((batchSize + 1)*param->NumRefOutputLayer);
-							for (int i = 0; i < param->NumRefOutputLayer; i++) {
-								RefLayer2[i] = (RefStart + i) % param->nOutput;
-							}
-							#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-							for (int j = 0; j < param->nHide; j++) {
-								if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) { //Analog PCM
-									if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->cmosAccess) { //1T1R
-										sumArrayReadEnergy += arrayIH->wireCapRow*techIH.vdd*techIH.vdd*param->nInput;// All WLs open
-									}
-								}
-							}
-							for (int k = 0; k < param->nHide; k++) {
-								for (int j = 0; j < param->nOutput; j++) {
-									//std::cout << RandNum << std::endl;
-
-									for (int a = 0; a < param->NumRefOutputLayer; a++) {
-										if (j == RefLayer2[a]) {
-											
-											static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = true;
-										}
-									}
-
-								}
-							}
-							
-							arrayHO->readEnergy += sumArrayReadEnergy;
-							// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-							subArrayHO->activityRowRead = 1;
-							subArrayHO->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayHO);
-							subArrayHO->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayHO, adderIH, muxIH, muxDecoderIH, dffIH);
-							subArrayHO->readLatency += NeuroSimSubArrayReadLatency(subArrayHO);
-							subArrayHO->readLatency += NeuroSimNeuronReadLatency(subArrayHO, adderIH, muxIH, muxDecoderIH, dffIH);
-							}
-
-							/*ERASE Opeartion*/
-							/*==================Erase First Layer===================*/
-							double sumArrayWriteEnergy = 0;
-							double sumNeuroSimWriteEnergy = 0;
-							double sumWriteLatencyAnalogPCM = 0;
-							double numWriteOperation = 0;
-							double RESETVoltage = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->RESETVoltage;
-							double RESETPulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->RESETPulseWidth;
-							int count4 = 0;
-							#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-							for (int k = 0; k < param->nInput; k++) {
-								int numWriteOperationPerRow = 0;
-								int numWriteCellPerOperation = 0;
-								double maxLatencyLTP = 0;
-								for (int j = 0; j < param->nHide; j++) {
-									if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										arrayIH->EraseCell(j, k, param->maxWeight, param->minWeight);
-										//count4 += 1;
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											static_cast<AnalogNVM*>(arrayIH->cell[j][k])->EraseEnergyCalculation(arrayIH->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage *RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else { //Saturation ȵȰ ׳ .
-										count4 += 1;
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if (!static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess && param->writeEnergyReport) { // Cross-point
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-											}
-										}
-									}
-								}
-							}
-							//std::cout << count4 << std::endl;
-							/* Calculate the average number of write pulses on the selected row */
-				//		#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables ɼ ŭ
-				//	{
-				//		if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-				//			int sumNumWritePulse = 0;
-				//			for (int j = 0; j < param->nHide; j++) {
-				//				sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayIH->cell[j][k])->numPulse);    // Note that LTD has negative pulse number/										}
-				//				subArrayIH->numWritePulse = sumNumWritePulse / param->nHide;
-				//				double writeVoltageSquareSumRow = 0;
-				//			}
-				//			numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-				//			sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayIH, numWriteOperationPerRow, numWriteCellPerOperation);
-				//		}
-				//		numWriteOperation += numWriteOperationPerRow;
-				//	}
-				//}
-							arrayIH->writeEnergy += sumArrayWriteEnergy;
-							subArrayIH->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayIH->writeLatency += NeuroSimSubArrayWriteLatency(subArrayIH, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-							/*==================Erase Second Layer===================*/
-							sumArrayWriteEnergy = 0;
-							sumNeuroSimWriteEnergy = 0;
-							sumWriteLatencyAnalogPCM = 0;
-							numWriteOperation = 0;
-							RESETVoltage = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->RESETVoltage;
-							RESETPulseWidth = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->RESETPulseWidth;
-							int count3 = 0;
-							/*double Gp = 0;
-							double Gn = 0;*/
-							#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-						
-							for (int k = 0; k < param->nHide; k++) {
-								int numWriteOperationPerRow = 0;
-								int numWriteCellPerOperation = 0;
-								double maxLatencyLTP = 0;
-
-								for (int j = 0; j < param->nOutput; j++) {
-
-									if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										count3 += 1;
-										arrayHO->EraseCell(j, k, param->maxWeight, param->minWeight);
-										/*double Gp = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductanceGp;
-										double Gn = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductanceGn;
-										std::cout << "GP: " << Gp << "GN: " << Gn << std::endl;*/
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											//static_cast<AnalogNVM*>(arrayHO->cell[j][k])->EraseEnergyCalculation(arrayHO->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayHO->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage*RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else { //Saturation ȵ 
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if ((!static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) && param->writeEnergyReport) { // Cross-point
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-
-											}
-										}
-									}
-								}
-
-							}
-							//std::cout <<count3 << std::endl;
-							/*if (expc == 1000) {
-								std::cout << batchSize << std::endl;
-							}*/
-							//			/* Calculate the average number of write pulses on the selected row */
-							//		#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-							//			{
-							//				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-							//					int sumNumWritePulse = 0;
-							//					for (int j = 0; j < param->nHide; j++) {
-							//						sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayHO->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
-							//					}
-							//					subArrayHO->numWritePulse = sumNumWritePulse / param->nHide;
-							//					double writeVoltageSquareSumRow = 0;
-							//				}
-							//				numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-							//				sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayHO, numWriteOperationPerRow, numWriteCellPerOperation);
-							//			}
-							//			numWriteOperation += numWriteOperationPerRow;		
-							//}
-							arrayHO->writeEnergy += sumArrayWriteEnergy;
-							subArrayHO->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayHO->writeLatency += NeuroSimSubArrayWriteLatency(subArrayHO, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-							/*SET Operation*/
-							/*ReWrite First Layer*/
-							sumArrayWriteEnergy = 0;
-							sumNeuroSimWriteEnergy = 0;
-							sumWriteLatencyAnalogPCM = 0;
-							numWriteOperation = 0;
-							double writeVoltageLTP = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->writeVoltageLTP;
-							double writePulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->writePulseWidthLTP;
-#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-							for (int k = 0; k < param->nInput; k++) {
-								for (int j = 0; j < param->nHide; j++) {
-									int numWriteOperationPerRow = 0;
-									int numWriteCellPerOperation = 0;
-									double maxLatencyLTP = 0;
-									double Gp = 0;
-									double Gn = 0;
-									if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										double conductancePrevGp = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->conductanceGpPrev;
-										double conductancePrevGn = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->conductanceGnPrev;
-										static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = false;
-										//ERAESE weight  0.5
-										/*std::cout << "w: " << weightGp;*/
-										arrayIH->WriteCell(j, k, weight1[j][k] - 0.5, param->maxWeight, param->minWeight, false);
-										//arrayIH->ReWriteCell(j, k, weight1[j][k], param->maxWeight, param->minWeight); // regular true: weight update , false: Ͽ update 
-										//weight1[j][k] = arrayIH->ConductanceToWeight(j, k, param->maxWeight, param->minWeight);
-										/*double w = arrayIH->ConductanceToWeight(j, k, param->maxWeight, param->minWeight);
-										std::cout << j <<","<< k << ":" << w << std::endl;
-										/*Gp = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductanceGp;
-										Gn = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductanceGn;
-										std::cout << "GP: " << Gp << "Gn: "<< Gn;*/
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											static_cast<AnalogNVM*>(arrayIH->cell[j][k])->WriteEnergyCalculation(arrayIH->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage *RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else {
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if ((!static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) && param->writeEnergyReport) { // Cross-point
-
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-
-
-											}
-										}
-									}
-								}
-								///* Calculate the average number of write pulses on the selected row */
-								//#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-								//{
-								//	if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-								//		int sumNumWritePulse = 0;
-								//		for (int j = 0; j < param->nHide; j++) {
-								//			sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayIH->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
-								//		}
-								//		subArrayIH->numWritePulse = sumNumWritePulse / param->nHide;
-								//		double writeVoltageSquareSumRow = 0;
-								//	}
-								//	numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-								//	sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayIH, numWriteOperationPerRow, numWriteCellPerOperation);
-								//}
-								//numWriteOperation += numWriteOperationPerRow;
-
-							}
-
-							arrayIH->writeEnergy += sumArrayWriteEnergy;
-							subArrayIH->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayIH->writeLatency += NeuroSimSubArrayWriteLatency(subArrayIH, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-							/*SET Second Layer*/
-							sumArrayWriteEnergy = 0;
-							sumNeuroSimWriteEnergy = 0;
-							sumWriteLatencyAnalogPCM = 0;
-							numWriteOperation = 0;
-							writeVoltageLTP = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->writeVoltageLTP;
-							writePulseWidth = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->writePulseWidthLTP;
-#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-							for (int k = 0; k < param->nHide; k++) {
-								for (int j = 0; j < param->nOutput; j++) {
-									int numWriteOperationPerRow = 0;
-									int numWriteCellPerOperation = 0;
-									double maxLatencyLTP = 0;
-
-									if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										double conductancePrevGp = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->conductanceGpPrev;
-										double conductancePrevGn = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->conductanceGnPrev;
-										static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = false;
-										arrayHO->WriteCell(j, k, weight2[j][k] - 0.5, param->maxWeight, param->minWeight, false);
-										//arrayHO->ReWriteCell(j, k, weight2[j][k], param->maxWeight, param->minWeight); // regular true: weight update , false: Ͽ update 
-										//weight2[j][k] = arrayHO->ConductanceToWeight(j, k, param->maxWeight, param->minWeight);
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											static_cast<AnalogNVM*>(arrayHO->cell[j][k])->WriteEnergyCalculation(arrayHO->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayHO->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage *RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else {
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if ((!static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) && param->writeEnergyReport) { // Cross-point
-
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-
-
-											}
-										}
-									}
-								}
-								//								/* Calculate the average number of write pulses on the selected row */
-								//#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-								//								{
-								//									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-								//										int sumNumWritePulse = 0;
-								//										for (int j = 0; j < param->nHide; j++) {
-								//											sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayHO->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
-								//										}
-								//										subArrayHO->numWritePulse = sumNumWritePulse / param->nHide;
-								//										double writeVoltageSquareSumRow = 0;
-								//									}
-								//									numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-								//									sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayHO, numWriteOperationPerRow, numWriteCellPerOperation);
-								//								}
-								//								numWriteOperation += numWriteOperationPerRow;
-
-
-							}
-							arrayHO->writeEnergy += sumArrayWriteEnergy;
-							subArrayHO->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayHO->writeLatency += NeuroSimSubArrayWriteLatency(subArrayHO, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-						}
-						else {
-							/*Read All first Layer*/
-							double maxConductance = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->maxConductance;
-							double ResetThr = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->ThrConductance;
-							double sumArrayReadEnergy = 0; // Read Energy  ӽ 
-							double readVoltage = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readVoltage;
-							double readPulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->readPulseWidth;
-						#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-							for (int j = 0; j < param->nHide; j++) {
-								if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) { //Analog PCM
-									if (static_cast<AnalogNVM*>(arrayIH->cell[0][0])->cmosAccess) { //1T1R
-										sumArrayReadEnergy += arrayIH->wireCapRow*techIH.vdd*techIH.vdd*param->nInput;// All WLs open
-									}
-								}
-								for (int n = 0; n < param->numBitInput; n++) {
-									double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1)*arrayIH->arrayRowSize; // numInputLevel= 2 (black or white)
-									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {
-										double Isum = 0; // weight sum current
-										double IsumMax = 0; //Max weight sum current
-										double inputSum = 0;  // weight sum current of input vector
-										for (int k = 0; k < param->nInput; k++) {
-											Isum += arrayIH->ReadCell(j, k);
-											if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductanceGp > ResetThr) {
-												static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = true;
-											}
-											else if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductanceGn > ResetThr) {
-												static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = true;
-											}
-											else {
-												static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM = false;
-											}
-										}
-										sumArrayReadEnergy += Isum * readVoltage*readPulseWidth; //Read energy  
-									}
-
-								}
-							}
-							arrayIH->readEnergy += sumArrayReadEnergy;
-							// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-							subArrayIH->activityRowRead = 1;
-							subArrayIH->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayIH);
-							subArrayIH->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-							subArrayIH->readLatency += NeuroSimSubArrayReadLatency(subArrayIH);
-							subArrayIH->readLatency += NeuroSimNeuronReadLatency(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-
-							/*Read All Second Layer*/
-							maxConductance = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->maxConductance;
-							ResetThr = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->ThrConductance;
-							sumArrayReadEnergy = 0; // Read Energy  ӽ 
-							readVoltage = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->readVoltage;
-							readPulseWidth = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->readPulseWidth;
-						#pragma omp parallel for reduction(+: sumArrayReadEnergy)
-							for (int j = 0; j < param->nOutput; j++) {
-								if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) { //Analog PCM
-									if (static_cast<AnalogNVM*>(arrayHO->cell[0][0])->cmosAccess) { //1T1R
-										sumArrayReadEnergy += arrayHO->wireCapRow*techIH.vdd*techIH.vdd*param->nInput;// All WLs open
-									}
-								}
-								for (int n = 0; n < param->numBitInput; n++) {
-									double pSumMaxAlgorithm = pow(2, n) / (param->numInputLevel - 1)*(arrayHO->arrayRowSize); // numInputLevel= 2 (black or white)
-									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {
-										double Isum = 0; // weight sum current
-										double IsumMax = 0; //Max weight sum current
-										double inputSum = 0;  // weight sum current of input vector
-										for (int k = 0; k < param->nHide; k++) {
-											//std::cout << RandNum;
-											Isum += arrayHO->ReadCell(j, k);
-											if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductanceGp > ResetThr) {
-												static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = true;
-											}
-											else if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductanceGn > ResetThr) {
-												static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = true;
-											}
-											else {
-												static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = true;
-											}
-											/*	else
-												{
-													static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM = false;
-
-												}*/
-										}
-										sumArrayReadEnergy += Isum * readVoltage*readPulseWidth;
-									}
-
-								}
-							}
-							arrayHO->readEnergy += sumArrayReadEnergy;
-							// Don't parallelize this loop since there may be update of member variables inside NeuroSim functions
-							subArrayHO->activityRowRead = 1;
-							subArrayHO->readDynamicEnergy += NeuroSimSubArrayReadEnergy(subArrayIH);
-							subArrayHO->readDynamicEnergy += NeuroSimNeuronReadEnergy(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-							subArrayHO->readLatency += NeuroSimSubArrayReadLatency(subArrayIH);
-							subArrayHO->readLatency += NeuroSimNeuronReadLatency(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-
-							/*ERASE Opeartion*/
-							/*==================Erase First Layer===================*/
-							double sumArrayWriteEnergy = 0;
-							double sumNeuroSimWriteEnergy = 0;
-							double sumWriteLatencyAnalogPCM = 0;
-							double numWriteOperation = 0;
-							double RESETVoltage = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->RESETVoltage;
-							double RESETPulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->RESETPulseWidth;
-#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-							for (int k = 0; k < param->nInput; k++) {
-								int numWriteOperationPerRow = 0;
-								int numWriteCellPerOperation = 0;
-								double maxLatencyLTP = 0;
-								for (int j = 0; j < param->nHide; j++) {
-									if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										arrayIH->EraseCell(j, k, param->maxWeight, param->minWeight);
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											static_cast<AnalogNVM*>(arrayIH->cell[j][k])->EraseEnergyCalculation(arrayIH->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage *RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else { //Saturation ȵȰ ׳ .
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if (!static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess && param->writeEnergyReport) { // Cross-point
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-											}
-										}
-									}
-								}
-							}
-
-							/* Calculate the average number of write pulses on the selected row */
-				//		#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables ɼ ŭ
-				//	{
-				//		if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-				//			int sumNumWritePulse = 0;
-				//			for (int j = 0; j < param->nHide; j++) {
-				//				sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayIH->cell[j][k])->numPulse);    // Note that LTD has negative pulse number/										}
-				//				subArrayIH->numWritePulse = sumNumWritePulse / param->nHide;
-				//				double writeVoltageSquareSumRow = 0;
-				//			}
-				//			numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-				//			sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayIH, numWriteOperationPerRow, numWriteCellPerOperation);
-				//		}
-				//		numWriteOperation += numWriteOperationPerRow;
-				//	}
-				//}
-							arrayIH->writeEnergy += sumArrayWriteEnergy;
-							subArrayIH->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayIH->writeLatency += NeuroSimSubArrayWriteLatency(subArrayIH, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-							/*==================Erase Second Layer===================*/
-							sumArrayWriteEnergy = 0;
-							sumNeuroSimWriteEnergy = 0;
-							sumWriteLatencyAnalogPCM = 0;
-							numWriteOperation = 0;
-							RESETVoltage = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->RESETVoltage;
-							RESETPulseWidth = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->RESETPulseWidth;
-							/*double Gp = 0;
-							double Gn = 0;*/
-#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-							//int expc = 0;
-							for (int k = 0; k < param->nHide; k++) {
-								int numWriteOperationPerRow = 0;
-								int numWriteCellPerOperation = 0;
-								double maxLatencyLTP = 0;
-
-								for (int j = 0; j < param->nOutput; j++) {
-
-									if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										//expc += 1;
-										arrayHO->EraseCell(j, k, param->maxWeight, param->minWeight);
-										/*double Gp = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductanceGp;
-										double Gn = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductanceGn;
-										std::cout << "GP: " << Gp << "GN: " << Gn << std::endl;*/
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											//static_cast<AnalogNVM*>(arrayHO->cell[j][k])->EraseEnergyCalculation(arrayHO->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayHO->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage*RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else { //Saturation ȵ 
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if ((!static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) && param->writeEnergyReport) { // Cross-point
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-
-											}
-										}
-									}
-								}
-
-							}
-							/*if (expc == 1000) {
-								std::cout << batchSize << std::endl;
-							}*/
-							//			/* Calculate the average number of write pulses on the selected row */
-							//		#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-							//			{
-							//				if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-							//					int sumNumWritePulse = 0;
-							//					for (int j = 0; j < param->nHide; j++) {
-							//						sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayHO->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
-							//					}
-							//					subArrayHO->numWritePulse = sumNumWritePulse / param->nHide;
-							//					double writeVoltageSquareSumRow = 0;
-							//				}
-							//				numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-							//				sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayHO, numWriteOperationPerRow, numWriteCellPerOperation);
-							//			}
-							//			numWriteOperation += numWriteOperationPerRow;		
-							//}
-							arrayHO->writeEnergy += sumArrayWriteEnergy;
-							subArrayHO->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayHO->writeLatency += NeuroSimSubArrayWriteLatency(subArrayHO, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-							/*SET Operation*/
-							/*ReWrite First Layer*/
-							sumArrayWriteEnergy = 0;
-							sumNeuroSimWriteEnergy = 0;
-							sumWriteLatencyAnalogPCM = 0;
-							numWriteOperation = 0;
-							double writeVoltageLTP = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->writeVoltageLTP;
-							double writePulseWidth = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->writePulseWidthLTP;
-#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-							for (int k = 0; k < param->nInput; k++) {
-								for (int j = 0; j < param->nHide; j++) {
-									int numWriteOperationPerRow = 0;
-									int numWriteCellPerOperation = 0;
-									double maxLatencyLTP = 0;
-									double Gp = 0;
-									double Gn = 0;
-									if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										double conductancePrevGp = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->conductanceGpPrev;
-										double conductancePrevGn = static_cast<AnalogNVM*>(arrayIH->cell[0][0])->conductanceGnPrev;
-
-										//ERAESE weight  0.5
-										/*std::cout << "w: " << weightGp;*/
-										arrayIH->WriteCell(j, k, weight1[j][k] - 0.5, param->maxWeight, param->minWeight, false);
-										//arrayIH->ReWriteCell(j, k, weight1[j][k], param->maxWeight, param->minWeight); // regular true: weight update , false: Ͽ update 
-										//weight1[j][k] = arrayIH->ConductanceToWeight(j, k, param->maxWeight, param->minWeight);
-										/*double w = arrayIH->ConductanceToWeight(j, k, param->maxWeight, param->minWeight);
-										std::cout << j <<","<< k << ":" << w << std::endl;
-										/*Gp = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductanceGp;
-										Gn = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductanceGn;
-										std::cout << "GP: " << Gp << "Gn: "<< Gn;*/
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											static_cast<AnalogNVM*>(arrayIH->cell[j][k])->WriteEnergyCalculation(arrayIH->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayIH->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayIH->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage *RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayIH->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayIH->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else {
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-											if ((!static_cast<eNVM*>(arrayIH->cell[0][0])->cmosAccess) && param->writeEnergyReport) { // Cross-point
-
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-
-
-											}
-										}
-									}
-								}
-								///* Calculate the average number of write pulses on the selected row */
-								//#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-								//{
-								//	if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayIH->cell[0][0])) {  // Analog eNVM
-								//		int sumNumWritePulse = 0;
-								//		for (int j = 0; j < param->nHide; j++) {
-								//			sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayIH->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
-								//		}
-								//		subArrayIH->numWritePulse = sumNumWritePulse / param->nHide;
-								//		double writeVoltageSquareSumRow = 0;
-								//	}
-								//	numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-								//	sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayIH, numWriteOperationPerRow, numWriteCellPerOperation);
-								//}
-								//numWriteOperation += numWriteOperationPerRow;
-
-							}
-
-							arrayIH->writeEnergy += sumArrayWriteEnergy;
-							subArrayIH->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayIH->writeLatency += NeuroSimSubArrayWriteLatency(subArrayIH, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-							/*SET Second Layer*/
-							sumArrayWriteEnergy = 0;
-							sumNeuroSimWriteEnergy = 0;
-							sumWriteLatencyAnalogPCM = 0;
-							numWriteOperation = 0;
-							writeVoltageLTP = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->writeVoltageLTP;
-							writePulseWidth = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->writePulseWidthLTP;
-#pragma omp parallel for reduction(+:sumArrayWriteEnergy,sumNeuroSimWriteEnergy,sumWriteLatencyAnalogPCM)
-							for (int k = 0; k < param->nHide; k++) {
-								for (int j = 0; j < param->nOutput; j++) {
-									int numWriteOperationPerRow = 0;
-									int numWriteCellPerOperation = 0;
-									double maxLatencyLTP = 0;
-
-									if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->SaturationPCM) { //SET Saturation   RESET operation 
-										double conductancePrevGp = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->conductanceGpPrev;
-										double conductancePrevGn = static_cast<AnalogNVM*>(arrayHO->cell[0][0])->conductanceGnPrev;
-
-										arrayHO->WriteCell(j, k, weight2[j][k] - 0.5, param->maxWeight, param->minWeight, false);
-										//arrayHO->ReWriteCell(j, k, weight2[j][k], param->maxWeight, param->minWeight); // regular true: weight update , false: Ͽ update 
-										//weight2[j][k] = arrayHO->ConductanceToWeight(j, k, param->maxWeight, param->minWeight);
-										numWriteCellPerOperation += 1;
-										if (static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP > maxLatencyLTP) {
-											maxLatencyLTP = static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeLatencyLTP;
-										}
-										if (param->writeEnergyReport) {
-											static_cast<AnalogNVM*>(arrayHO->cell[j][k])->WriteEnergyCalculation(arrayHO->wireCapCol);
-										}
-										sumArrayWriteEnergy += static_cast<AnalogNVM*>(arrayHO->cell[j][k])->writeEnergy;
-										/* Latency for each batch write in Analog eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {	// Analog eNVM
-											sumWriteLatencyAnalogPCM += maxLatencyLTP;
-										}
-										/* Energy consumption on array caps for eNVM */
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if (param->writeEnergyReport) {
-												if (static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) {  // 1T1R
-													// The energy on selected SLs is included in WriteCell()
-													sumArrayWriteEnergy += arrayHO->wireGateCapRow * techIH.vdd * techIH.vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage * RESETVoltage;   // Selected BL (LTP phases)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage * RESETVoltage * (param->nHide - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
-													// No LTD part because all unselected rows and columns are V=0
-												}
-												else {
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage *RESETVoltage;    // Selected WL (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);  // Unselected WLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol *RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
-													sumArrayWriteEnergy += arrayHO->wireCapRow * RESETVoltage / 2 * RESETVoltage / 2 * (param->nInput - 1);    // Unselected WLs (LTD phase)
-													sumArrayWriteEnergy += arrayHO->wireCapCol * RESETVoltage / 2 * RESETVoltage / 2 * (param->nHide - numBatchWriteSynapse); // Unselected BLs (LTD phase)
-												}
-											}
-										}
-									}
-									/*Half selected Cell*/
-									else {
-										if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-											if ((!static_cast<eNVM*>(arrayHO->cell[0][0])->cmosAccess) && param->writeEnergyReport) { // Cross-point
-
-												sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayHO->cell[j][k])->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * static_cast<AnalogNVM*>(arrayIH->cell[j][k])->conductance * maxLatencyLTP);
-
-
-											}
-										}
-									}
-								}
-								//								/* Calculate the average number of write pulses on the selected row */
-								//#pragma omp critical    // Use critical here since NeuroSim class functions may update its member variables
-								//								{
-								//									if (AnalogNVM *temp = dynamic_cast<AnalogNVM*>(arrayHO->cell[0][0])) {  // Analog eNVM
-								//										int sumNumWritePulse = 0;
-								//										for (int j = 0; j < param->nHide; j++) {
-								//											sumNumWritePulse += abs(static_cast<AnalogNVM*>(arrayHO->cell[j][k])->numPulse);    // Note that LTD has negative pulse number
-								//										}
-								//										subArrayHO->numWritePulse = sumNumWritePulse / param->nHide;
-								//										double writeVoltageSquareSumRow = 0;
-								//									}
-								//									numWriteCellPerOperation = (double)numWriteCellPerOperation / numWriteOperationPerRow;
-								//									sumNeuroSimWriteEnergy += NeuroSimSubArrayWriteEnergy(subArrayHO, numWriteOperationPerRow, numWriteCellPerOperation);
-								//								}
-								//								numWriteOperation += numWriteOperationPerRow;
-
-
-							}
-							arrayHO->writeEnergy += sumArrayWriteEnergy;
-							subArrayHO->writeDynamicEnergy += sumNeuroSimWriteEnergy;
-							numWriteOperation = numWriteOperation / param->nInput;
-							subArrayHO->writeLatency += NeuroSimSubArrayWriteLatency(subArrayHO, numWriteOperation, sumWriteLatencyAnalogPCM);
-
-
-
-
-
-						}
-					}
+			else if (weight < param->minWeight) {
+				deltaWeight += param->minWeight - weight;
+				weight = param->minWeight;
+			}
+			if (param->useHardwareInTrainingFF) {
+				layer->array->WriteCell(j, k, deltaWeight, param->maxWeight, param->minWeight, false);
 			}
 		}
 	}
+}
+
+/* Energy on the array caps of the tile for writing one cell of the PCM refresh with voltage,
+ * added term by term to *energy (an OpenMP reduction variable of the caller) */
+static void AddRefreshWireEnergy(const Layer *layer, double voltage, int numBatchWriteSynapse, double *energy) {
+	const Array *array = layer->array;
+	double vdd = layer->tech.vdd;
+	if (static_cast<eNVM*>(array->cell[0][0])->cmosAccess) {  // 1T1R
+		// The energy on selected SLs is included in WriteCell()
+		*energy += array->wireGateCapRow * vdd * vdd * 2;   // Selected WL (*2 means both LTP and LTD phases)
+		*energy += array->wireCapRow * voltage * voltage;   // Selected BL (LTP phases)
+		*energy += array->wireCapCol * voltage * voltage * (layer->tileCols - numBatchWriteSynapse);   // Unselected SLs (LTP phase)
+		// No LTD part because all unselected rows and columns are V=0
+	}
+	else {
+		*energy += array->wireCapRow * voltage * voltage;    // Selected WL (LTP phase)
+		*energy += array->wireCapRow * voltage / 2 * voltage / 2 * (layer->tileRows - 1);  // Unselected WLs (LTP phase)
+		*energy += array->wireCapCol * voltage / 2 * voltage / 2 * (layer->tileCols - numBatchWriteSynapse);   // Unselected BLs (LTP phase)
+		*energy += array->wireCapRow * voltage / 2 * voltage / 2 * (layer->tileRows - 1);    // Unselected WLs (LTD phase)
+		*energy += array->wireCapCol * voltage / 2 * voltage / 2 * (layer->tileCols - numBatchWriteSynapse); // Unselected BLs (LTD phase)
+	}
+}
+
+/* Mark the PCM cells of the layer to be refreshed (SaturationPCM) and add the cost of reading the array:
+ * Line refreshes numRefresh random columns, Sequential the next numRefresh columns, Sporadic every cell
+ * with the probability actDevice, and the threshold refresh (RandomRefresh=false) the cells above ThrConductance */
+void Simulator::RefreshSelect(Layer *layer, int batchNum, std::mt19937& refreshGen) {
+	Array *array = layer->array;
+	AnalogNVM *pcm = static_cast<AnalogNVM*>(array->cell[0][0]);
+	double vdd = layer->tech.vdd;
+	double readVoltage = pcm->readVoltage;
+	double readPulseWidth = pcm->readPulseWidth;
+	double ResetThr = pcm->ThrConductance;
+	int numRefresh = std::min(layer->numRefresh, layer->numOutput);	// # of refreshed columns of Line and Sequential
+	bool sporadic = param->RandomRefresh && param->mode == Param::Sporadic;
+	bool readCells = !param->RandomRefresh || sporadic;	// Only the threshold and Sporadic refresh look at the cells
+
+	if (param->RandomRefresh && param->mode == Param::Line) {
+		std::vector<int> Ref(layer->numOutput);	// Shuffled column indices
+		for (int j = 0; j < layer->numOutput; j++) {
+			Ref[j] = j;
+		}
+		std::uniform_int_distribution<int> dist(0, layer->numOutput - 1);
+		for (int a = 0; a < numRefresh * 100; a++) {
+			int num1 = dist(refreshGen);
+			int num2 = dist(refreshGen);
+			std::swap(Ref[num1], Ref[num2]);
+		}
+		for (int a = 0; a < numRefresh; a++) {
+			for (int k = 0; k < layer->numInput; k++) {
+				static_cast<AnalogNVM*>(array->cell[Ref[a]][k])->SaturationPCM = true;
+			}
+		}
 	}
+	else if (param->RandomRefresh && param->mode == Param::Sequential) {
+		for (int a = 0; a < numRefresh; a++) {
+			int j = (batchNum * numRefresh + a) % layer->numOutput;
+			for (int k = 0; k < layer->numInput; k++) {
+				static_cast<AnalogNVM*>(array->cell[j][k])->SaturationPCM = true;
+			}
+		}
 	}
 
+	double sumArrayReadEnergy = 0; // Use a temporary variable here since OpenMP does not support reduction on class member
+	std::uniform_real_distribution<double> dist(0, 1);
+	/* The Sporadic draws stay serial so that the selection is reproducible */
+#pragma omp parallel for reduction(+: sumArrayReadEnergy) if (!sporadic)
+	for (int j = 0; j < layer->numOutput; j++) {
+		if (pcm->cmosAccess) { //1T1R
+			sumArrayReadEnergy += array->wireCapRow * vdd * vdd * layer->numInput;	// All WLs open
+		}
+		if (!readCells) { continue; }
+		for (int n = 0; n < param->numBitInput; n++) {
+			double Isum = 0; // weight sum current
+			for (int k = 0; k < layer->numInput; k++) {
+				AnalogNVM *cell = static_cast<AnalogNVM*>(array->cell[j][k]);
+				if (sporadic) {
+					cell->SaturationPCM = dist(refreshGen) < layer->actDevice;
+				}
+				Isum += array->ReadCell(j, k);
+				if (!sporadic) {
+					cell->SaturationPCM = cell->conductanceGp > ResetThr || cell->conductanceGn > ResetThr;
+				}
+			}
+			sumArrayReadEnergy += Isum * readVoltage * readPulseWidth;
+		}
+	}
+	array->readEnergy += sumArrayReadEnergy;
+	layer->cost.readEnergy[COST_REFRESH] += sumArrayReadEnergy;
+
+	SubArray *subArray = layer->subArray;
+	for (int rowStart = 0; rowStart < layer->numInput; rowStart += layer->tileRows) {	// All the rows of every tile, the first tile row is full and sets the latency
+		double activityRowRead = (double)(std::min(rowStart + layer->tileRows, layer->numInput) - rowStart) / layer->tileRows;
+		layer->ReadCost(activityRowRead, rowStart == 0, &subArray->readDynamicEnergy, &subArray->readLatency, &layer->cost);
+		activityTrace.Read(layer->index, activityRowRead, false, rowStart == 0);
+	}
+}
+
+/* RESET the selected PCM cells of the layer */
+void Simulator::RefreshErase(Layer *layer) {
+	Array *array = layer->array;
+	SubArray *subArray = layer->subArray;
+	double RESETVoltage = static_cast<AnalogNVM*>(array->cell[0][0])->RESETVoltage;
+	bool crossPoint = !static_cast<eNVM*>(array->cell[0][0])->cmosAccess;
+	int numBatchWriteSynapse = (int)ceil((double)layer->tileCols / param->numWriteColMuxed);
+	double sumArrayWriteEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
+	double sumWriteLatencyAnalogPCM = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
+#pragma omp parallel for reduction(+: sumArrayWriteEnergy, sumWriteLatencyAnalogPCM)
+	for (int k = 0; k < layer->numInput; k++) {
+		double maxLatencyLTP = 0;	// Max RESET latency so far in the row
+		for (int j = 0; j < layer->numOutput; j++) {
+			AnalogNVM *cell = static_cast<AnalogNVM*>(array->cell[j][k]);
+			if (cell->SaturationPCM) {
+				array->EraseCell(j, k, param->maxWeight, param->minWeight);
+				if (cell->writeLatencyLTP > maxLatencyLTP) {
+					maxLatencyLTP = cell->writeLatencyLTP;
+				}
+				if (param->writeEnergyReport) {
+					cell->EraseEnergyCalculation(array->wireCapCol);
+				}
+				sumArrayWriteEnergy += cell->writeEnergy;
+				sumWriteLatencyAnalogPCM += maxLatencyLTP;
+				if (param->writeEnergyReport) {
+					AddRefreshWireEnergy(layer, RESETVoltage, numBatchWriteSynapse, &sumArrayWriteEnergy);
+				}
+			}
+			else if (crossPoint && param->writeEnergyReport) {	// Half-selected cell
+				sumArrayWriteEnergy += (RESETVoltage / 2 * RESETVoltage / 2 * cell->conductance * maxLatencyLTP + RESETVoltage / 2 * RESETVoltage / 2 * cell->conductance * maxLatencyLTP);
+			}
+		}
+	}
+	array->writeEnergy += sumArrayWriteEnergy;
+	layer->cost.writeEnergy[COST_REFRESH] += sumArrayWriteEnergy;
+	/* The refresh writes are not batched, so there is no NeuroSim write energy and numWriteOperation is 0 */
+	double writeLatency = NeuroSimSubArrayWriteLatency(subArray, 0, sumWriteLatencyAnalogPCM);
+	subArray->writeLatency += writeLatency;
+	layer->cost.AddSubArrayWriteLatency(subArray, writeLatency, COST_REFRESH);
+	activityTrace.WriteArray(layer->index, subArray, 0, sumWriteLatencyAnalogPCM);
+}
+
+/* SET the erased PCM cells of the layer back to their weights */
+void Simulator::RefreshReWrite(Layer *layer) {
+	Array *array = layer->array;
+	SubArray *subArray = layer->subArray;
+	double RESETVoltage = static_cast<AnalogNVM*>(array->cell[0][0])->RESETVoltage;
+	int numBatchWriteSynapse = (int)ceil((double)layer->tileCols / param->numWriteColMuxed);
+	double sumArrayWriteEnergy = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
+	double sumWriteLatencyAnalogPCM = 0;   // Use a temporary variable here since OpenMP does not support reduction on class member
+#pragma omp parallel for reduction(+: sumArrayWriteEnergy, sumWriteLatencyAnalogPCM)
+	for (int k = 0; k < layer->numInput; k++) {
+		for (int j = 0; j < layer->numOutput; j++) {
+			AnalogNVM *cell = static_cast<AnalogNVM*>(array->cell[j][k]);
+			if (cell->SaturationPCM) {
+				cell->SaturationPCM = false;
+				array->WriteCell(j, k, layer->weight[j][k] - 0.5, param->maxWeight, param->minWeight, false);	// The erased cell holds the weight 0.5
+				/* The ideal write takes the pulses of RealDevice::ReWrite from the erased state */
+				array->CountPulses(j, k, (int)(2 * fabs(layer->weight[j][k] - 0.5) / (param->maxWeight - param->minWeight) * cell->maxNumLevelLTP), 0);
+				double maxLatencyLTP = 0;
+				if (cell->writeLatencyLTP > maxLatencyLTP) {
+					maxLatencyLTP = cell->writeLatencyLTP;
+				}
+				if (param->writeEnergyReport) {
+					cell->WriteEnergyCalculation(array->wireCapCol);
+				}
+				sumArrayWriteEnergy += cell->writeEnergy;
+				sumWriteLatencyAnalogPCM += maxLatencyLTP;
+				if (param->writeEnergyReport) {
+					AddRefreshWireEnergy(layer, RESETVoltage, numBatchWriteSynapse, &sumArrayWriteEnergy);
+				}
+			}
+		}
+	}
+	array->writeEnergy += sumArrayWriteEnergy;
+	layer->cost.writeEnergy[COST_REFRESH] += sumArrayWriteEnergy;
+	double writeLatency = NeuroSimSubArrayWriteLatency(subArray, 0, sumWriteLatencyAnalogPCM);
+	subArray->writeLatency += writeLatency;
+	layer->cost.AddSubArrayWriteLatency(subArray, writeLatency, COST_REFRESH);
+	activityTrace.WriteArray(layer->index, subArray, 0, sumWriteLatencyAnalogPCM);
+}
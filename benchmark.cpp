@@ -0,0 +1,587 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+/* Microbenchmarks of the simulator kernels
+ *   ./benchmark [config files] [key=value ...] [--filter=<substring>] [--min-time=<s>] [--repeat=<N>]
+ *               [--output=<file.json>] [--baseline=<file.json>]
+ * Each kernel is run in batches of numOps operations, numOps is doubled until a batch
+ * takes min-time, then the batch is timed repeat times. The inputs come from fixed seeds
+ * so every run does the same work. The results are written as JSON (one benchmark per
+ * line), and --baseline prints the speedup of the median against an earlier result.
+ *
+ * Scaling mode, on synthetic data through the real Train and Validate:
+ *   ./benchmark --scaling [--sizes=<nInput>x<nHide>,...] [--threads=<N>,...] [--images=<N>] [--output=<file.json>]
+ * reports the training and validation throughput of every array size and OpenMP thread
+ * count, the parallel efficiency against the smallest thread count and the memory footprint. */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <omp.h>
+#include "Cell.h"
+#include "Array.h"
+#include "formula.h"
+#include "NeuroSim.h"
+#include "Param.h"
+#include "IO.h"
+#include "Config.h"
+#include "Profiler.h"
+#include "Simulator.h"
+
+typedef std::function<void(int64_t)> Kernel;	// Runs numOps operations of the benchmarked kernel
+
+struct BenchmarkResult {
+	std::string name;
+	int64_t numOps;	// Operations per timed batch
+	double min, median, mean;	// ns per operation over the repeated batches
+};
+
+static volatile double sink;	// Keeps the results of the kernels alive
+
+static const char *filter = NULL;
+static double minTime = 0.1;	// s
+static int numRepeat = 5;
+static std::map<std::string, double> baseline;	// Median ns per operation of the baseline
+static std::vector<BenchmarkResult> results;
+
+static double TimeBatch(const Kernel& kernel, int64_t numOps) {
+	int64_t begin = Profiler::Now();
+	kernel(numOps);
+	return Profiler::Now() - begin;
+}
+
+static bool Selected(const std::string& name) {
+	return !filter || name.find(filter) != std::string::npos;
+}
+
+static void RunBenchmark(const std::string& name, const Kernel& kernel) {
+	if (!Selected(name))
+		return;
+	int64_t numOps = 1;
+	while (TimeBatch(kernel, numOps) < minTime * 1e9 && numOps < ((int64_t)1 << 40)) {
+		numOps *= 2;
+	}
+	std::vector<double> nsPerOp;
+	for (int r=0; r<numRepeat; r++) {
+		nsPerOp.push_back(TimeBatch(kernel, numOps) / numOps);
+	}
+	std::sort(nsPerOp.begin(), nsPerOp.end());
+	BenchmarkResult result;
+	result.name = name;
+	result.numOps = numOps;
+	result.min = nsPerOp[0];
+	result.median = nsPerOp[nsPerOp.size() / 2];
+	result.mean = 0;
+	for (int r=0; r<nsPerOp.size(); r++) {
+		result.mean += nsPerOp[r] / nsPerOp.size();
+	}
+	results.push_back(result);
+	printf("%-44s %14.2f ns/op (min %.2f, %lld ops x %d)", name.c_str(), result.median, result.min, (long long)numOps, numRepeat);
+	if (baseline.count(name))
+		printf("  %.2fx vs baseline", baseline[name] / result.median);
+	printf("\n");
+	fflush(stdout);
+}
+
+/* Read the medians of an earlier --output file */
+static void ReadBaseline(const char *fileName) {
+	FILE *fp = fopen(fileName, "r");
+	if (!fp) {
+		printf("Cannot open baseline %s\n", fileName);
+		exit(-1);
+	}
+	char line[1024];
+	while (fgets(line, sizeof(line), fp)) {
+		char *name = strstr(line, "\"name\": \"");
+		char *median = strstr(line, "\"ns_per_op_median\": ");
+		if (!name || !median)
+			continue;
+		name += strlen("\"name\": \"");
+		char *end = strchr(name, '"');
+		if (end)
+			baseline[std::string(name, end)] = atof(median + strlen("\"ns_per_op_median\": "));
+	}
+	fclose(fp);
+}
+
+static void WriteResults(const char *fileName, const Param& param) {
+	FILE *fp = fopen(fileName, "w");
+	if (!fp) {
+		printf("Cannot open %s\n", fileName);
+		exit(-1);
+	}
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"threads\": %d,\n", omp_get_max_threads());
+	fprintf(fp, "  \"min_time\": %g,\n", minTime);
+	fprintf(fp, "  \"repeat\": %d,\n", numRepeat);
+	fprintf(fp, "  \"nInput\": %d, \"nHide\": %d, \"nOutput\": %d,\n", param.nInput, param.nHide, param.nOutput);
+	fprintf(fp, "  \"benchmarks\": [\n");
+	for (int i=0; i<results.size(); i++) {
+		fprintf(fp, "    {\"name\": \"%s\", \"ops\": %lld, \"ns_per_op_min\": %.4f, \"ns_per_op_median\": %.4f, \"ns_per_op_mean\": %.4f}%s\n",
+				results[i].name.c_str(), (long long)results[i].numOps, results[i].min, results[i].median, results[i].mean, i + 1 < results.size()? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	fclose(fp);
+	printf("Results written to %s\n", fileName);
+}
+
+/* Synaptic array of the first layer (nHide x nInput) with the device type and overrides on top of param */
+static Array *NewArray(const Param& base, Param::DeviceType deviceType, const std::vector<std::string>& overrides, std::mt19937 *gen) {
+	Param param(base);
+	for (int i=0; i<overrides.size(); i++) {
+		ApplyArgument(&param, overrides[i]);
+	}
+	Array *array = new Array(param.nHide, param.nInput, param.arrayWireWidth, gen);
+	SetDeviceParams(&param);
+	switch (deviceType) {
+		case Param::IdealDeviceType:	array->Initialization<IdealDevice>(); break;
+		case Param::RealDeviceType:		array->Initialization<RealDevice>(); break;
+		case Param::MeasuredDeviceType:	array->Initialization<MeasuredDevice>(); break;
+		case Param::SRAMType:			array->Initialization<SRAM>(param.numWeightBit); break;
+		case Param::DigitalNVMType:		array->Initialization<DigitalNVM>(param.numWeightBit); break;
+		default:	puts("Unknown device type"); exit(-1);
+	}
+	CheckUnusedDeviceParams();
+	/* Spread the weights so the reads and writes do not all start from the same state */
+	std::uniform_real_distribution<double> weight(param.minWeight, param.maxWeight);
+	std::mt19937 weightGen(1);
+	for (int j=0; j<param.nHide; j++) {
+		for (int k=0; k<param.nInput; k++) {
+			array->WriteCell(j, k, weight(weightGen), param.maxWeight, param.minWeight, false);
+		}
+	}
+	return array;
+}
+
+/* Weight changes of the size seen in training */
+static std::vector<double> DeltaWeights(int size) {
+	std::vector<double> deltaWeight(size);
+	std::uniform_real_distribution<double> delta(-0.05, 0.05);
+	std::mt19937 deltaGen(2);
+	for (int i=0; i<size; i++) {
+		deltaWeight[i] = delta(deltaGen);
+	}
+	return deltaWeight;
+}
+
+struct ArrayVariant {
+	const char *name;
+	Param::DeviceType deviceType;
+	std::vector<std::string> overrides;
+};
+
+static void ArrayBenchmarks(const Param& param) {
+	std::vector<ArrayVariant> readVariants = {
+		{"IdealDevice", Param::IdealDeviceType, {}},
+		{"RealDevice/linear", Param::RealDeviceType, {"RealDevice.readNoise=0", "RealDevice.nonlinearIV=0"}},
+		{"RealDevice/readNoise", Param::RealDeviceType, {"RealDevice.readNoise=1", "RealDevice.nonlinearIV=0"}},
+		{"RealDevice/nonlinearIV", Param::RealDeviceType, {"RealDevice.readNoise=0", "RealDevice.nonlinearIV=1", "RealDevice.cmosAccess=0"}},
+		{"MeasuredDevice", Param::MeasuredDeviceType, {}},
+		{"SRAM", Param::SRAMType, {}},
+		{"DigitalNVM", Param::DigitalNVMType, {}}
+	};
+	std::vector<ArrayVariant> writeVariants = {
+		{"IdealDevice", Param::IdealDeviceType, {}},
+		{"RealDevice/RRAM", Param::RealDeviceType, {"RealDevice.PCMON=0"}},
+		{"RealDevice/PCM", Param::RealDeviceType, {"RealDevice.PCMON=1"}},
+		{"SRAM", Param::SRAMType, {}},
+		{"DigitalNVM", Param::DigitalNVMType, {}}
+	};
+	std::vector<double> deltaWeight = DeltaWeights(4096);
+	std::mt19937 gen(0);
+
+	for (int v=0; v<readVariants.size(); v++) {
+		std::string name = std::string("Array::ReadCell/") + readVariants[v].name;
+		if (!Selected(name))
+			continue;
+		Array *array = NewArray(param, readVariants[v].deviceType, readVariants[v].overrides, &gen);
+		int x = 0, y = 0;
+		RunBenchmark(name, [&](int64_t numOps) {
+			double sum = 0;
+			for (int64_t n=0; n<numOps; n++) {
+				sum += array->ReadCell(x, y);
+				if (++x == param.nHide) {
+					x = 0;
+					y = (y + 1) % param.nInput;
+				}
+			}
+			sink = sum;
+		});
+		delete array;
+	}
+
+	for (int v=0; v<writeVariants.size(); v++) {
+		std::string writeName = std::string("Array::WriteCell/") + writeVariants[v].name;
+		std::string conductanceName = std::string("Array::ConductanceToWeight/") + writeVariants[v].name;
+		bool realDevice = (writeVariants[v].deviceType == Param::RealDeviceType);
+		std::string deviceWriteName = realDevice? std::string("RealDevice::Write/") + (writeVariants[v].name + strlen("RealDevice/")) : "";
+		if (!Selected(writeName) && !Selected(conductanceName) && !(realDevice && Selected(deviceWriteName)))
+			continue;
+		Array *array = NewArray(param, writeVariants[v].deviceType, writeVariants[v].overrides, &gen);
+		int x = 0, y = 0, d = 0;
+		RunBenchmark(writeName, [&](int64_t numOps) {
+			for (int64_t n=0; n<numOps; n++) {
+				array->WriteCell(x, y, deltaWeight[d], param.maxWeight, param.minWeight, true);
+				d = (d + 1) % deltaWeight.size();
+				if (++x == param.nHide) {
+					x = 0;
+					y = (y + 1) % param.nInput;
+				}
+			}
+		});
+		RunBenchmark(conductanceName, [&](int64_t numOps) {
+			double sum = 0;
+			for (int64_t n=0; n<numOps; n++) {
+				sum += array->ConductanceToWeight(x, y, param.maxWeight, param.minWeight);
+				if (++x == param.nHide) {
+					x = 0;
+					y = (y + 1) % param.nInput;
+				}
+			}
+			sink = sum;
+		});
+		if (realDevice) {
+			/* The device write alone, without the dispatch and bookkeeping of WriteCell */
+			RunBenchmark(deviceWriteName, [&](int64_t numOps) {
+				for (int64_t n=0; n<numOps; n++) {
+					static_cast<RealDevice*>(array->cell[x][y])->Write(deltaWeight[d] / (param.maxWeight - param.minWeight));
+					d = (d + 1) % deltaWeight.size();
+					if (++x == param.nHide) {
+						x = 0;
+						y = (y + 1) % param.nInput;
+					}
+				}
+			});
+		}
+		delete array;
+	}
+}
+
+static void FormulaBenchmarks() {
+	std::vector<double> x(4096);
+	std::uniform_real_distribution<double> uniform(0, 1);
+	std::mt19937 xGen(3);
+	for (int i=0; i<x.size(); i++) {
+		x[i] = uniform(xGen);
+	}
+	std::vector<double> dataConductance(64);
+	for (int i=0; i<dataConductance.size(); i++) {
+		dataConductance[i] = 3e-9 + 3.5e-8 * sqrt((double)i / (dataConductance.size() - 1));
+	}
+	double paramA = getParamA(2.4) * 97;
+	double paramB = (3.8462e-8 - 3.0769e-9) / (1 - exp(-97 / paramA));
+
+	RunBenchmark("formula/sigmoid", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += sigmoid(x[n & 4095] * 8 - 4);
+		sink = sum;
+	});
+	RunBenchmark("formula/truncate", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += truncate(x[n & 4095], 63);
+		sink = sum;
+	});
+	RunBenchmark("formula/round_th", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += round_th(x[n & 4095] * 7, 0.5);
+		sink = sum;
+	});
+	RunBenchmark("formula/NonlinearWeight", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NonlinearWeight(x[n & 4095] * 97, 97, paramA, paramB, 3.0769e-9);
+		sink = sum;
+	});
+	RunBenchmark("formula/InvNonlinearWeight", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += InvNonlinearWeight(3.0769e-9 + x[n & 4095] * 3.5e-8, 97, paramA, paramB, 3.0769e-9);
+		sink = sum;
+	});
+	RunBenchmark("formula/MeasuredLTP", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += MeasuredLTP(x[n & 4095] * 63, 63, dataConductance);
+		sink = sum;
+	});
+	RunBenchmark("formula/InvMeasuredLTP", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += InvMeasuredLTP(3e-9 + x[n & 4095] * 3.5e-8, 63, dataConductance);
+		sink = sum;
+	});
+	RunBenchmark("formula/getParamA", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += getParamA(0.5 + x[n & 4095] * 4);
+		sink = sum;
+	});
+	RunBenchmark("formula/NonlinearConductance", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NonlinearConductance(1e-8, 10, 2, 0.5, x[n & 4095]);
+		sink = sum;
+	});
+	RandomGenerator rng(0);
+	RunBenchmark("formula/RandomGenerator::Rand", [&](int64_t numOps) {
+		int sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += rng.Rand();
+		sink = sum;
+	});
+}
+
+static void NeuroSimBenchmarks(Simulator& simulator) {
+	Layer *layer = simulator.layers[0];
+	SubArray *subArray = layer->subArray;
+	double height, width;
+	NeuroSimNeuronArea(subArray, layer->adder, layer->mux, layer->muxDecoder, layer->dff, &height, &width);
+	subArray->activityRowRead = 0.2;
+	int numWriteOperationPerRow = simulator.param->numWriteColMuxed;
+
+	RunBenchmark("NeuroSim/SubArrayReadLatency", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NeuroSimSubArrayReadLatency(subArray);
+		sink = sum;
+	});
+	RunBenchmark("NeuroSim/SubArrayReadEnergy", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NeuroSimSubArrayReadEnergy(subArray);
+		sink = sum;
+	});
+	RunBenchmark("NeuroSim/NeuronReadLatency", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NeuroSimNeuronReadLatency(subArray, layer->adder, layer->mux, layer->muxDecoder, layer->dff);
+		sink = sum;
+	});
+	RunBenchmark("NeuroSim/NeuronReadEnergy", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NeuroSimNeuronReadEnergy(subArray, layer->adder, layer->mux, layer->muxDecoder, layer->dff);
+		sink = sum;
+	});
+	RunBenchmark("NeuroSim/SubArrayWriteLatency", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NeuroSimSubArrayWriteLatency(subArray, numWriteOperationPerRow, 1e-6);
+		sink = sum;
+	});
+	RunBenchmark("NeuroSim/SubArrayWriteEnergy", [&](int64_t numOps) {
+		double sum = 0;
+		for (int64_t n=0; n<numOps; n++) sum += NeuroSimSubArrayWriteEnergy(subArray, numWriteOperationPerRow, 1);
+		sink = sum;
+	});
+}
+
+/* One training image (feed forward, backprop and weight update with the configured devices) */
+static void TrainBenchmark(Simulator& simulator) {
+	if (!Selected("Train/image"))
+		return;
+	simulator.WeightInitialize();
+	if (simulator.param->useHardwareInTraining) { simulator.WeightToConductance(); }
+	simulator.rng.Seed(0);
+	RunBenchmark("Train/image", [&](int64_t numOps) {
+		for (int64_t n=0; n<numOps; n++) {
+			simulator.Train(1, 1);
+		}
+	});
+}
+
+struct ScalingResult {
+	int nInput, nHide, numThreads;
+	double trainRate, validateRate;	// images/s
+	double trainEfficiency, validateEfficiency;	// Speedup over the smallest thread count divided by the thread ratio
+	double footprint;	// Resident memory added by the dataset and the simulator (MB)
+	double resident;	// Resident memory of the process after the setup (MB)
+};
+
+/* VmRSS of this process (MB), 0 if /proc is not available */
+static double ResidentMemory() {
+	FILE *fp = fopen("/proc/self/status", "r");
+	if (!fp)
+		return 0;
+	char line[256];
+	double rss = 0;
+	while (fgets(line, sizeof(line), fp)) {
+		if (strncmp(line, "VmRSS:", 6) == 0)
+			rss = atof(line + 6) / 1024;	// kB
+	}
+	fclose(fp);
+	return rss;
+}
+
+/* Comma separated list of integers */
+static std::vector<int> ParseList(const char *list) {
+	std::vector<int> values;
+	std::stringstream ss(list);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		values.push_back(atoi(item.c_str()));
+	}
+	return values;
+}
+
+static void ScalingBenchmarks(const Param& base, const char *sizes, const char *threads, int numImages, const char *outputFileName) {
+	std::vector<std::pair<int, int> > layerSizes;	// nInput, nHide
+	std::stringstream ss(sizes);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		int nInput, nHide;
+		if (sscanf(item.c_str(), "%dx%d", &nInput, &nHide) != 2 || nInput <= 0 || nHide <= 0) {
+			printf("Invalid size %s (expected <nInput>x<nHide>)\n", item.c_str());
+			exit(-1);
+		}
+		layerSizes.push_back(std::make_pair(nInput, nHide));
+	}
+	std::vector<int> threadCounts = ParseList(threads);
+	if (threadCounts.empty()) {
+		puts("No thread count given");
+		exit(-1);
+	}
+
+	std::vector<ScalingResult> scaling;
+	printf("%8s %8s %8s %14s %10s %14s %10s %12s\n", "nInput", "nHide", "threads", "train img/s", "eff", "validate img/s", "eff", "memory MB");
+	for (int s=0; s<layerSizes.size(); s++) {
+		Param param(base);
+		param.nInput = layerSizes[s].first;
+		param.nHide = layerSizes[s].second;
+		param.numMnistTrainImages = numImages;
+		param.numMnistTestImages = numImages;
+		param.PrintWeightdist = false;
+
+		double residentBefore = ResidentMemory();
+		Dataset dataset(param);
+		dataset.GenerateSyntheticData(0);
+		Simulator *simulator = new Simulator(param, dataset);
+		simulator->Initialize();
+		double resident = ResidentMemory();
+
+		for (int t=0; t<threadCounts.size(); t++) {
+			omp_set_num_threads(threadCounts[t]);
+			/* Same weights and training samples for every thread count */
+			simulator->WeightInitialize();
+			if (param.useHardwareInTraining) { simulator->WeightToConductance(); }
+			simulator->rng.Seed(0);
+			double trainTime = TimeBatch([&](int64_t numOps) { simulator->Train(numOps, 1); }, numImages);
+			double validateTime = TimeBatch([&](int64_t numOps) { simulator->Validate(false); }, numImages);
+
+			ScalingResult result;
+			result.nInput = param.nInput;
+			result.nHide = param.nHide;
+			result.numThreads = threadCounts[t];
+			result.trainRate = numImages / (trainTime * 1e-9);
+			result.validateRate = numImages / (validateTime * 1e-9);
+			const ScalingResult& first = (t == 0)? result : scaling[scaling.size() - t];
+			double threadRatio = (double)result.numThreads / first.numThreads;
+			result.trainEfficiency = result.trainRate / first.trainRate / threadRatio;
+			result.validateEfficiency = result.validateRate / first.validateRate / threadRatio;
+			result.footprint = resident - residentBefore;
+			result.resident = resident;
+			scaling.push_back(result);
+			printf("%8d %8d %8d %14.2f %10.2f %14.2f %10.2f %12.1f\n", result.nInput, result.nHide, result.numThreads,
+					result.trainRate, result.trainEfficiency, result.validateRate, result.validateEfficiency, result.footprint);
+			fflush(stdout);
+		}
+		delete simulator;
+	}
+
+	FILE *fp = fopen(outputFileName, "w");
+	if (!fp) {
+		printf("Cannot open %s\n", outputFileName);
+		exit(-1);
+	}
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"images\": %d,\n", numImages);
+	fprintf(fp, "  \"nOutput\": %d,\n", base.nOutput);
+	fprintf(fp, "  \"scaling\": [\n");
+	for (int i=0; i<scaling.size(); i++) {
+		fprintf(fp, "    {\"nInput\": %d, \"nHide\": %d, \"threads\": %d, \"train_images_per_s\": %.4f, \"train_efficiency\": %.4f, "
+				"\"validate_images_per_s\": %.4f, \"validate_efficiency\": %.4f, \"footprint_mb\": %.2f, \"resident_mb\": %.2f}%s\n",
+				scaling[i].nInput, scaling[i].nHide, scaling[i].numThreads, scaling[i].trainRate, scaling[i].trainEfficiency,
+				scaling[i].validateRate, scaling[i].validateEfficiency, scaling[i].footprint, scaling[i].resident, i + 1 < scaling.size()? "," : "");
+	}
+	fprintf(fp, "  ]\n}\n");
+	fclose(fp);
+	printf("Results written to %s\n", outputFileName);
+}
+
+int main(int argc, char *argv[]) {
+	Param param;
+	ParseCommandLine(&param, argc, argv);
+	/* The benchmarks only need a few images */
+	param.numMnistTrainImages = std::min(param.numMnistTrainImages, 1000);
+	param.numMnistTestImages = std::min(param.numMnistTestImages, 100);
+
+	filter = GetCommandLineOption(argc, argv, "filter");
+	if (const char *option = GetCommandLineOption(argc, argv, "min-time"))
+		minTime = atof(option);
+	if (const char *option = GetCommandLineOption(argc, argv, "repeat"))
+		numRepeat = std::max(atoi(option), 1);
+	if (const char *option = GetCommandLineOption(argc, argv, "baseline"))
+		ReadBaseline(option);
+	const char *outputFileName = GetCommandLineOption(argc, argv, "output");
+
+	for (int i=1; i<argc; i++) {
+		if (strcmp(argv[i], "--scaling") == 0) {
+			const char *sizes = GetCommandLineOption(argc, argv, "sizes");
+			const char *threads = GetCommandLineOption(argc, argv, "threads");
+			const char *images = GetCommandLineOption(argc, argv, "images");
+			std::string defaultThreads;	// Powers of 2 up to the number of cores
+			for (int n=1; n<omp_get_max_threads(); n*=2) {
+				defaultThreads += std::to_string(n) + ",";
+			}
+			defaultThreads += std::to_string(omp_get_max_threads());
+			ScalingBenchmarks(param, sizes? sizes : "400x100,784x1024,1024x1024", threads? threads : defaultThreads.c_str(),
+					images? atoi(images) : 20, outputFileName? outputFileName : "scaling.json");
+			return 0;
+		}
+	}
+
+	printf("Benchmarks with %d threads, min time %g s, %d repeats\n", omp_get_max_threads(), minTime, numRepeat);
+	ArrayBenchmarks(param);
+	FormulaBenchmarks();
+
+	Dataset dataset(param);
+	dataset.GenerateSyntheticData(0);
+	Simulator *simulator = new Simulator(param, dataset);
+	simulator->Initialize();
+	NeuroSimBenchmarks(*simulator);
+	TrainBenchmark(*simulator);
+	delete simulator;
+
+	WriteResults(outputFileName? outputFileName : "benchmark.json", param);
+	return 0;
+}
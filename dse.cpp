@@ -0,0 +1,277 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+/* Circuit-level design-space exploration of one NeuroSim synaptic core
+ *   ./dse [config] [key=value ...] [--device=<list>] [--size=<rows>x<cols>,...]
+ *         [--processNode=<list>] [--numColMuxed=<list>] [--numWriteColMuxed=<list>]
+ *         [--numBitPartialSum=<list>] [--cmosAccess=<list>] [--relaxArrayCellWidth=<list>]
+ *         [--activity=<fraction>] [--pulses=<N>] [--output=<file>]
+ * Every combination of the comma separated lists is a design point, an axis that is not
+ * given keeps the value of the configuration (rows x cols is nInput x nHide, the device and
+ * relaxArrayCellWidth are the ones of the IH array). The points are evaluated in parallel without the dataset or the MLP:
+ * each builds its synaptic core and neuron peripheries and reports
+ *   area, leakage           synaptic core and neuron peripheries
+ *   read latency/energy     one weighted sum over all columns (every column batch of
+ *                           numColMuxed), with --activity of the rows selected (default 0.5)
+ *   write latency/energy    one update of the whole array with every write batch changed,
+ *                           --activity of the cells written (digital eNVM) and --pulses per
+ *                           LTP and LTD (analog eNVM, default 1)
+ * Only the NeuroSim peripheral cost is included, the cell-level array energy of ./main
+ * depends on the weights. cmosAccess does not apply to SRAM, which is evaluated once.
+ * Points whose peripherals do not fit the array (NeuroSim prints an error and returns a
+ * negative area, e.g. a narrow array without relaxArrayCellWidth) are marked invalid. */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <omp.h>
+#include "Cell.h"
+#include "Array.h"
+#include "NeuroSim.h"
+#include "Param.h"
+#include "Config.h"
+#include "Profiler.h"
+
+static const char *deviceNames[] = {"IdealDevice", "RealDevice", "MeasuredDevice", "SRAM", "DigitalNVM"};	// Param::DeviceType order
+
+/* Synaptic core and neuron peripheries of one design point */
+struct DesignCore {
+	DesignCore(): subArray(NULL), inputParameter(), cell(), adder(inputParameter, tech, cell), mux(inputParameter, tech, cell),
+					muxDecoder(inputParameter, tech, cell), dff(inputParameter, tech, cell) {
+	}
+	~DesignCore() {
+		delete subArray;
+	}
+
+	SubArray *subArray;
+	InputParameter inputParameter;
+	Technology tech;
+	MemCell cell;
+	Adder adder;
+	Mux mux;
+	RowDecoder muxDecoder;
+	DFF dff;
+};
+
+struct DesignPoint {
+	Param param;
+	int cmosAccess;	// -1 for SRAM
+	/* Results */
+	int numColMuxed;	// After the upper bound of NeuroSimSubArrayInitialize
+	double area, leakage;
+	double readLatency, readEnergy;
+	double writeLatency, writeEnergy;
+};
+
+static double activity = 0.5;
+static int numPulse = 1;
+
+static void Evaluate(DesignPoint *point) {
+	Param *param = &point->param;
+	int numRow = param->nInput, numCol = param->nHide;
+
+	/* NeuroSim only reads the size, the wires and the first cell of the array, so the array
+	 * is initialized with one cell and sized afterwards instead of building every cell */
+	std::mt19937 gen(0);
+	Array array(1, 1, param->arrayWireWidth, &gen);
+	SetDeviceParams(param);
+	switch (param->deviceTypeIH) {
+		case Param::IdealDeviceType:	array.Initialization<IdealDevice>(); break;
+		case Param::RealDeviceType:		array.Initialization<RealDevice>(); break;
+		case Param::MeasuredDeviceType:	array.Initialization<MeasuredDevice>(); break;
+		case Param::SRAMType:			array.Initialization<SRAM>(param->numWeightBit); break;
+		case Param::DigitalNVMType:		array.Initialization<DigitalNVM>(param->numWeightBit); break;
+		default:	puts("Unknown device type"); exit(-1);
+	}
+	SetDeviceParams(NULL);	// Not CheckUnusedDeviceParams, the overrides of the other devices of the grid are expected
+	if (eNVM *cell = dynamic_cast<eNVM*>(array.cell[0][0]))
+		point->cmosAccess = cell->cmosAccess;
+	array.arrayColSize = array.tileColSize = numCol;	// One tile: the design point is one subarray
+	array.arrayRowSize = array.tileRowSize = numRow;
+
+	DesignCore *core = new DesignCore;
+	NeuroSimSubArrayInitialize(core->subArray, &array, core->inputParameter, core->tech, core->cell, param, param->relaxArrayCellWidthIH);
+	NeuroSimSubArrayArea(core->subArray);
+	NeuroSimSubArrayLeakagePower(core->subArray);
+	NeuroSimNeuronInitialize(core->subArray, core->inputParameter, core->tech, core->cell, core->adder, core->mux, core->muxDecoder, core->dff, param);
+	double heightNeuron, widthNeuron;
+	NeuroSimNeuronArea(core->subArray, core->adder, core->mux, core->muxDecoder, core->dff, &heightNeuron, &widthNeuron);
+	SubArray *subArray = core->subArray;
+	point->numColMuxed = param->numColMuxed;
+	point->area = subArray->usedArea + core->adder.area + core->mux.area + core->muxDecoder.area + core->dff.area;
+	point->leakage = subArray->leakage + NeuroSimNeuronLeakagePower(subArray, core->adder, core->mux, core->muxDecoder, core->dff);
+
+	/* Read: one call for every column batch as in Train. The peripherals keep state (e.g. load
+	 * capacitances) between calls, so a first call warms them up like the reads before in ./main */
+	subArray->activityRowRead = activity;
+	NeuroSimSubArrayReadLatency(subArray);
+	NeuroSimNeuronReadLatency(subArray, core->adder, core->mux, core->muxDecoder, core->dff);
+	NeuroSimSubArrayReadEnergy(subArray);
+	NeuroSimNeuronReadEnergy(subArray, core->adder, core->mux, core->muxDecoder, core->dff);
+	int numBatchReadSynapse = (int)ceil((double)numCol / param->numColMuxed);
+	int numReadBatch = (int)ceil((double)numCol / numBatchReadSynapse);
+	point->readLatency = numReadBatch * (NeuroSimSubArrayReadLatency(subArray) + NeuroSimNeuronReadLatency(subArray, core->adder, core->mux, core->muxDecoder, core->dff));
+	point->readEnergy = numReadBatch * (NeuroSimSubArrayReadEnergy(subArray) + NeuroSimNeuronReadEnergy(subArray, core->adder, core->mux, core->muxDecoder, core->dff));
+
+	/* Write: every write batch of every row changes */
+	int numBatchWriteSynapse = (int)ceil((double)numCol / param->numWriteColMuxed);
+	int numWriteOperationPerRow = (int)ceil((double)numCol / numBatchWriteSynapse);
+	double numWriteCellPerOperation = activity * numBatchWriteSynapse * array.numCellPerSynapse;
+	double sumWriteLatencyAnalogNVM = 0;
+	if (AnalogNVM *cell = dynamic_cast<AnalogNVM*>(array.cell[0][0])) {
+		subArray->numWritePulse = numPulse;
+		sumWriteLatencyAnalogNVM = (double)numRow * numWriteOperationPerRow * numPulse * (cell->writePulseWidthLTP + cell->writePulseWidthLTD);
+	}
+	point->writeLatency = NeuroSimSubArrayWriteLatency(subArray, numWriteOperationPerRow, sumWriteLatencyAnalogNVM);
+	point->writeEnergy = numRow * NeuroSimSubArrayWriteEnergy(subArray, numWriteOperationPerRow, numWriteCellPerOperation);
+
+	delete core;
+	array.arrayColSize = array.arrayRowSize = 1;	// Back to the allocated size for the destructor
+}
+
+/* Comma separated list of --name, or the single value given */
+static std::vector<std::string> Axis(int argc, char *argv[], const char *name, const std::string& value) {
+	std::vector<std::string> values;
+	const char *list = GetCommandLineOption(argc, argv, name);
+	if (!list) {
+		values.push_back(value);
+		return values;
+	}
+	std::stringstream ss(list);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		if (!item.empty())
+			values.push_back(item);
+	}
+	if (values.empty()) {
+		printf("Empty list for --%s\n", name);
+		exit(-1);
+	}
+	return values;
+}
+
+int main(int argc, char *argv[]) {
+	Param base;
+	ParseCommandLine(&base, argc, argv);
+	if (const char *option = GetCommandLineOption(argc, argv, "activity"))
+		activity = atof(option);
+	if (const char *option = GetCommandLineOption(argc, argv, "pulses"))
+		numPulse = atoi(option);
+	const char *outputFileName = GetCommandLineOption(argc, argv, "output");
+	if (!outputFileName)
+		outputFileName = "dse_result.txt";
+
+	std::vector<std::string> devices = Axis(argc, argv, "device", deviceNames[base.deviceTypeIH]);
+	std::vector<std::string> sizes = Axis(argc, argv, "size", std::to_string(base.nInput) + "x" + std::to_string(base.nHide));
+	std::vector<std::string> processNodes = Axis(argc, argv, "processNode", std::to_string(base.processNode));
+	std::vector<std::string> numColMuxeds = Axis(argc, argv, "numColMuxed", std::to_string(base.numColMuxed));
+	std::vector<std::string> numWriteColMuxeds = Axis(argc, argv, "numWriteColMuxed", std::to_string(base.numWriteColMuxed));
+	std::vector<std::string> numBitPartialSums = Axis(argc, argv, "numBitPartialSum", std::to_string(base.numBitPartialSum));
+	std::vector<std::string> cmosAccesses = Axis(argc, argv, "cmosAccess", "");
+	std::vector<std::string> relaxArrayCellWidths = Axis(argc, argv, "relaxArrayCellWidth", std::to_string(base.relaxArrayCellWidthIH));
+
+	/* Cartesian product of the axes */
+	std::vector<DesignPoint> points;
+	for (int d=0; d<devices.size(); d++)
+	for (int s=0; s<sizes.size(); s++)
+	for (int p=0; p<processNodes.size(); p++)
+	for (int m=0; m<numColMuxeds.size(); m++)
+	for (int w=0; w<numWriteColMuxeds.size(); w++)
+	for (int b=0; b<numBitPartialSums.size(); b++)
+	for (int c=0; c<cmosAccesses.size(); c++)
+	for (int r=0; r<relaxArrayCellWidths.size(); r++) {
+		DesignPoint point;
+		point.param = base;
+		ApplyArgument(&point.param, "deviceTypeIH=" + devices[d]);
+		int numRow, numCol;
+		if (sscanf(sizes[s].c_str(), "%dx%d", &numRow, &numCol) != 2 || numRow <= 0 || numCol <= 0) {
+			printf("Invalid size %s (expected <rows>x<cols>)\n", sizes[s].c_str());
+			exit(-1);
+		}
+		point.param.nInput = numRow;
+		point.param.nHide = numCol;
+		ApplyArgument(&point.param, "processNode=" + processNodes[p]);
+		ApplyArgument(&point.param, "numColMuxed=" + numColMuxeds[m]);
+		ApplyArgument(&point.param, "numWriteColMuxed=" + numWriteColMuxeds[w]);
+		ApplyArgument(&point.param, "numBitPartialSum=" + numBitPartialSums[b]);
+		ApplyArgument(&point.param, "relaxArrayCellWidthIH=" + relaxArrayCellWidths[r]);
+		point.cmosAccess = -1;	// Set by Evaluate for eNVM
+		if (point.param.deviceTypeIH != Param::SRAMType) {
+			if (!cmosAccesses[c].empty())
+				ApplyArgument(&point.param, devices[d] + ".cmosAccess=" + cmosAccesses[c]);
+		} else if (c > 0) {
+			continue;	// SRAM has no access device
+		}
+		point.param.UpdateDerivedParameters();
+		points.push_back(point);
+	}
+
+	int64_t begin = Profiler::Now();
+#pragma omp parallel for schedule(dynamic)
+	for (int i=0; i<points.size(); i++) {
+		Evaluate(&points[i]);
+	}
+	double seconds = (Profiler::Now() - begin) * 1e-9;
+
+	FILE *fp = fopen(outputFileName, "w");
+	if (!fp) {
+		printf("Cannot open %s\n", outputFileName);
+		exit(-1);
+	}
+	fprintf(fp, "device\tcmosAccess\tprocessNode\trows\tcols\tnumColMuxed\tnumWriteColMuxed\tnumBitPartialSum\trelaxArrayCellWidth"
+			"\tvalid\tarea(m^2)\tleakage(W)\treadLatency(s)\treadEnergy(J)\twriteLatency(s)\twriteEnergy(J)\n");
+	for (int i=0; i<points.size(); i++) {
+		const DesignPoint& point = points[i];
+		const Param& param = point.param;
+		std::string cmosAccess = "-";
+		if (point.cmosAccess >= 0)
+			cmosAccess = std::to_string(point.cmosAccess);
+		bool valid = point.area > 0 && std::isfinite(point.area) && std::isfinite(point.readLatency) && std::isfinite(point.writeLatency);
+		fprintf(fp, "%s\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%.4e\t%.4e\t%.4e\t%.4e\t%.4e\t%.4e\n",
+				deviceNames[param.deviceTypeIH], cmosAccess.c_str(), param.processNode, param.nInput, param.nHide,
+				point.numColMuxed, param.numWriteColMuxed, param.numBitPartialSum, (int)param.relaxArrayCellWidthIH, (int)valid,
+				point.area, point.leakage, point.readLatency, point.readEnergy, point.writeLatency, point.writeEnergy);
+	}
+	fclose(fp);
+	printf("%d design points in %.2f s with %d threads, results written to %s\n", (int)points.size(), seconds, omp_get_max_threads(), outputFileName);
+	return 0;
+}
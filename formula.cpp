@@ -38,6 +38,7 @@
 
 #include <cmath>
 #include <vector>
+#include "formula.h"
 
 /* Activation function */
 double sigmoid(double x) {
@@ -159,7 +160,7 @@ double getParamA(double NL) {
 	int index = (int)(fabs(NL) * 100) - 1;	// -1 because index starts from 0
 	int sign = (NL>0)? 1 : -1;
 	/* This normalized paramA table corresponds to nonlinearity label from 0.01 to 9, with step=0.01 */
-	double data[] = {	126.268958,	63.134314,	42.089359,	31.566827,	25.253264,	21.044185,	
+	static const double data[] = {	126.268958,	63.134314,	42.089359,	31.566827,	25.253264,	21.044185,	
 						18.037668,	15.782754,	14.028906,	12.625807,	11.477796,	10.521102,	
 						9.711575,	9.017679,	8.416288,	7.890057,	7.425722,	7.012968,	
 						6.643650,	6.311253,	6.010503,	5.737083,	5.487429,	5.258571,	
@@ -322,3 +323,30 @@ double NonlinearConductance(double C, double NL, double Vw, double Vr, double V)
 	return C_NL;
 }
 
+
+void RandomGenerator::Seed(unsigned int seed) {
+	if (seed == 0)
+		seed = 1;
+	state[0] = seed;
+	int32_t word = seed;
+	for (int i=1; i<31; i++) {	// Park-Miller minimal standard generator fills the state
+		long hi = word / 127773;
+		long lo = word % 127773;
+		word = 16807 * lo - 2836 * hi;
+		if (word < 0)
+			word += 2147483647;
+		state[i] = word;
+	}
+	front = 3;
+	rear = 0;
+	for (int i=0; i<310; i++)	// Discard the first outputs like glibc does
+		Rand();
+}
+
+int RandomGenerator::Rand() {
+	uint32_t value = (uint32_t)state[front] + (uint32_t)state[rear];
+	state[front] = value;
+	front = (front + 1) % 31;
+	rear = (rear + 1) % 31;
+	return value >> 1;
+}
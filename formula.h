@@ -40,6 +40,7 @@
 #define FORMULA_H_
 
 #include <vector>
+#include <stdint.h>
 
 double sigmoid(double x);
 double truncate(double x, int numBit, double threshold=0.5);
@@ -53,4 +54,16 @@ double InvMeasuredLTD(double conductance, int maxNumLevel, std::vector<double>&
 double getParamA(double NL);
 double NonlinearConductance(double C, double NL, double Vw, double Vr, double V);
 
+/* Same sequence as srand()/rand() of glibc (additive feedback generator of degree 31),
+ * but the state is owned by the caller instead of being shared by the whole process */
+class RandomGenerator {
+public:
+	RandomGenerator(unsigned int seed=1) { Seed(seed); }
+	void Seed(unsigned int seed);
+	int Rand();		// An integer between 0 and RAND_MAX
+private:
+	int32_t state[31];
+	int front, rear;	// Indices of the two taps (3 apart)
+};
+
 #endif
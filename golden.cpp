@@ -0,0 +1,407 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+/* Golden trajectory check of the simulator
+ *   ./golden [--record] [--dir=<directory>] [--filter=<substring>] [--threads=<N>] [--tolerance=<factor>] [--verbose]
+ * Runs short reduced configurations (see goldenCases) on a synthetic dataset and compares
+ * them with the traces stored in <directory> (default golden_traces/). --record rewrites the traces.
+ * A trace holds the accuracy and cumulative read/write latency and energy after every
+ * validation, the area and leakage, the latency and energy totals of every layer, and the
+ * final state of every cell of every layer. Every case must also end at twice the chance
+ * accuracy or above, so that the trajectory gates the learning and not only the costs.
+ * Tolerances (multiplied by --tolerance):
+ *   accuracy                                 exact (same number of correct images)
+ *   latency, energy, area and leakage        1e-6 relative
+ *   cell conductances (and Gp/Gn of PCM)     1e-6 relative to the value, 1e-15 S absolute
+ *   SRAM and DigitalNVM bits                 exact
+ * The runs use 1 OpenMP thread by default so the reductions and the random numbers drawn in
+ * parallel loops come out in the same order on every machine. The multithreaded cases run a
+ * noiseless configuration on more threads and are compared with the trace of their 1-thread
+ * reference case, which checks the parallel reductions and the atomic writes of the weight
+ * update. Run make check-golden after any change of Train.cpp, Test.cpp, Array.cpp, Cell.cpp or
+ * NeuroSim, and make record-golden only when the change of the numbers is intended. */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <omp.h>
+#include "Cell.h"
+#include "Array.h"
+#include "Param.h"
+#include "IO.h"
+#include "Config.h"
+#include "Simulator.h"
+
+struct GoldenCase {
+	const char *name;
+	std::vector<std::string> arguments;	// key=value on top of the common reduced configuration
+	int numThreads;		// OpenMP threads of a multithreaded case (0: --threads, default 1)
+	const char *reference;	// Case whose trace a multithreaded case is compared with (NULL: its own trace)
+};
+
+/* Small network and few images so the whole suite runs in seconds, trained long enough to learn the
+ * synthetic task on every device */
+static const char *commonArguments[] = {
+	"nInput=32", "nHide=32", "nOutput=10",
+	"numMnistTrainImages=3000", "numMnistTestImages=200",
+	"numTrainImagesPerEpoch=1000", "totalNumEpochs=3", "interNumEpochs=1",
+	"numImageperRESET=25", "NumRefHiddenLayer=4", "NumRefOutputLayer=2",
+	"PrintWeightdist=0"
+};
+
+static const std::vector<GoldenCase> goldenCases = {
+	{"IdealDevice", {"deviceTypeIH=IdealDevice", "deviceTypeHO=IdealDevice"}},
+	{"RealDevice-RRAM", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=0"}},
+	{"RealDevice-RRAM-noise", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=0",
+			"RealDevice.readNoise=1", "RealDevice.sigmaReadNoise=0.1", "RealDevice.sigmaCtoC=1e-9"}},
+	{"RealDevice-PCM", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=1", "RandomRefresh=0"}},
+	{"RealDevice-PCM-Line", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=1", "RandomRefresh=1", "mode=Line"}},
+	{"RealDevice-PCM-Sporadic", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=1", "RandomRefresh=1", "mode=Sporadic"}},
+	{"RealDevice-PCM-Sequential", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=1", "RandomRefresh=1", "mode=Sequential"}},
+	{"MeasuredDevice", {"deviceTypeIH=MeasuredDevice", "deviceTypeHO=MeasuredDevice"}},
+	{"SRAM", {"deviceTypeIH=SRAM", "deviceTypeHO=SRAM"}},
+	{"DigitalNVM", {"deviceTypeIH=DigitalNVM", "deviceTypeHO=DigitalNVM"}},
+	{"DigitalNVM-noise", {"deviceTypeIH=DigitalNVM", "deviceTypeHO=DigitalNVM", "DigitalNVM.readNoise=1"}},
+	{"DigitalNVM-noise-nonlinearIV", {"deviceTypeIH=DigitalNVM", "deviceTypeHO=DigitalNVM", "DigitalNVM.readNoise=1",
+			"DigitalNVM.sigmaReadNoise=0.1", "DigitalNVM.cmosAccess=0", "DigitalNVM.nonlinearIV=1"}},	// Unpacked reads (see Array::PackWeights)
+	{"IdealDevice-3layer", {"deviceTypeIH=IdealDevice", "deviceTypeHO=IdealDevice", "hiddenLayers=32-16"}},
+	{"RealDevice-RRAM-tiled", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=0", "subArrayRows=12", "subArrayCols=8"}},
+	/* Multi-bit inputs, for the bit planes of ReadColumn */
+	{"RealDevice-RRAM-tiled-4bit", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=0", "subArrayRows=12", "subArrayCols=8", "numBitInput=4"}},
+	{"MeasuredDevice-4bit", {"deviceTypeIH=MeasuredDevice", "deviceTypeHO=MeasuredDevice", "numBitInput=4"}},
+	{"SRAM-4bit", {"deviceTypeIH=SRAM", "deviceTypeHO=SRAM", "numBitInput=4"}},
+	{"DigitalNVM-4bit", {"deviceTypeIH=DigitalNVM", "deviceTypeHO=DigitalNVM", "numBitInput=4"}},
+	{"IdealDevice-4threads", {"deviceTypeIH=IdealDevice", "deviceTypeHO=IdealDevice"}, 4, "IdealDevice"},
+	{"SRAM-4threads", {"deviceTypeIH=SRAM", "deviceTypeHO=SRAM"}, 4, "SRAM"},
+	{"DigitalNVM-4threads", {"deviceTypeIH=DigitalNVM", "deviceTypeHO=DigitalNVM"}, 4, "DigitalNVM"},
+	{"RealDevice-RRAM-4threads", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=0"}, 4, "RealDevice-RRAM"},
+	{"RealDevice-PCM-4threads", {"deviceTypeIH=RealDevice", "deviceTypeHO=RealDevice", "RealDevice.PCMON=1", "RandomRefresh=0"}, 4, "RealDevice-PCM"}
+};
+
+static double tolerance = 1;	// Factor on all the tolerances
+
+/* Trajectory and final state of one run */
+struct Trace {
+	std::vector<SimulationResult> history;
+	double area, leakage;
+	std::vector< std::vector<double> > layerCosts;	// NUM_LAYER_COSTS totals of every layer (see LayerCosts)
+	std::vector<std::string> cellNames;		// Name of every layer
+	std::vector< std::vector<double> > cells;	// 3 values per cell of every layer (see CellState)
+};
+
+/* Cumulative latency and energy of the layer, in the order of layerCostNames */
+static const int NUM_LAYER_COSTS = 6;
+static const char *layerCostNames[NUM_LAYER_COSTS] = {"read latency", "write latency", "array read energy", "array write energy", "NeuroSim read energy", "NeuroSim write energy"};
+
+static std::vector<double> LayerCosts(const Layer *layer) {
+	double costs[NUM_LAYER_COSTS] = {
+		layer->subArray->readLatency, layer->subArray->writeLatency,
+		layer->array->readEnergy, layer->array->writeEnergy,
+		layer->subArray->readDynamicEnergy, layer->subArray->writeDynamicEnergy
+	};
+	return std::vector<double>(costs, costs + NUM_LAYER_COSTS);
+}
+
+/* conductance, conductanceGp and conductanceGn of eNVM, the stored bit of SRAM */
+static void CellState(Cell *cell, std::vector<double> *values) {
+	if (SRAM *sram = dynamic_cast<SRAM*>(cell)) {
+		values->push_back(sram->bit);
+		values->push_back(0);
+		values->push_back(0);
+	} else {
+		eNVM *device = static_cast<eNVM*>(cell);
+		values->push_back(device->conductance);
+		values->push_back(device->conductanceGp);
+		values->push_back(device->conductanceGn);
+	}
+}
+
+static void ArrayState(Array *array, std::vector<double> *values) {
+	for (int x=0; x<array->arrayColSize * array->numCellPerSynapse; x++) {
+		for (int y=0; y<array->arrayRowSize; y++) {
+			CellState(array->cell[x][y], values);
+		}
+	}
+}
+
+static Trace RunCase(const Param& base, const Dataset& dataset, bool verbose) {
+	Simulator *simulator = new Simulator(base, dataset);
+	SimulationResult result;
+	/* Keep the report of Run out of the check output */
+	fflush(stdout);
+	int savedStdout = dup(STDOUT_FILENO);
+	if (!verbose) {
+		int devNull = open("/dev/null", O_WRONLY);
+		dup2(devNull, STDOUT_FILENO);
+		close(devNull);
+	}
+	simulator->Run(&result);
+	fflush(stdout);
+	dup2(savedStdout, STDOUT_FILENO);
+	close(savedStdout);
+
+	Trace trace;
+	trace.history = simulator->history;
+	trace.area = result.area;
+	trace.leakage = result.leakage;
+	trace.cellNames.resize(simulator->layers.size());
+	trace.cells.resize(simulator->layers.size());
+	for (int l=0; l<simulator->layers.size(); l++) {
+		trace.layerCosts.push_back(LayerCosts(simulator->layers[l]));
+		trace.cellNames[l] = simulator->layers[l]->name;
+		ArrayState(simulator->layers[l]->array, &trace.cells[l]);
+	}
+	delete simulator;
+	return trace;
+}
+
+static void WriteCells(FILE *fp, const std::string& name, const std::vector<double>& values) {
+	fprintf(fp, "cells %s %d\n", name.c_str(), (int)values.size() / 3);
+	for (int i=0; i<values.size(); i+=3) {
+		fprintf(fp, "%.17g %.17g %.17g\n", values[i], values[i+1], values[i+2]);
+	}
+}
+
+static void WriteTrace(const char *fileName, const GoldenCase& goldenCase, const Trace& trace) {
+	FILE *fp = fopen(fileName, "w");
+	if (!fp) {
+		printf("Cannot write %s\n", fileName);
+		exit(-1);
+	}
+	fprintf(fp, "# Golden trace of %s, written by ./golden --record\n", goldenCase.name);
+	fprintf(fp, "# epoch accuracy readLatency writeLatency readEnergy writeEnergy\n");
+	for (int i=0; i<trace.history.size(); i++) {
+		const SimulationResult& r = trace.history[i];
+		fprintf(fp, "epoch %d %.17g %.17g %.17g %.17g %.17g\n", r.stopEpoch, r.accuracy, r.readLatency, r.writeLatency, r.readEnergy, r.writeEnergy);
+	}
+	fprintf(fp, "area %.17g\n", trace.area);
+	fprintf(fp, "leakage %.17g\n", trace.leakage);
+	for (int l=0; l<trace.layerCosts.size(); l++) {
+		fprintf(fp, "layer %s", trace.cellNames[l].c_str());
+		for (int c=0; c<NUM_LAYER_COSTS; c++) {
+			fprintf(fp, " %.17g", trace.layerCosts[l][c]);
+		}
+		fprintf(fp, "\n");
+	}
+	for (int l=0; l<trace.cells.size(); l++) {
+		WriteCells(fp, trace.cellNames[l], trace.cells[l]);
+	}
+	fclose(fp);
+}
+
+/* Read one cell section, return 0 at the end of the file and -1 on a malformed section */
+static int ReadCells(FILE *fp, std::string *name, std::vector<double> *values) {
+	char section[16];
+	int numCells;
+	int numRead = fscanf(fp, " cells %15s %d", section, &numCells);
+	if (numRead == EOF)
+		return 0;
+	if (numRead != 2)
+		return -1;
+	*name = section;
+	values->resize(numCells * 3);
+	for (int i=0; i<values->size(); i++) {
+		if (fscanf(fp, "%lf", &(*values)[i]) != 1)
+			return -1;
+	}
+	return 1;
+}
+
+static bool ReadTrace(const char *fileName, Trace *trace) {
+	FILE *fp = fopen(fileName, "r");
+	if (!fp)
+		return false;
+	char line[1024];
+	long position = ftell(fp);
+	while (fgets(line, sizeof(line), fp)) {
+		SimulationResult r;
+		char layerName[16];
+		std::vector<double> costs(NUM_LAYER_COSTS);
+		if (line[0] == '#') {
+		} else if (sscanf(line, "epoch %d %lf %lf %lf %lf %lf", &r.stopEpoch, &r.accuracy, &r.readLatency, &r.writeLatency, &r.readEnergy, &r.writeEnergy) == 6) {
+			trace->history.push_back(r);
+		} else if (sscanf(line, "area %lf", &trace->area) == 1) {
+		} else if (sscanf(line, "leakage %lf", &trace->leakage) == 1) {
+		} else if (sscanf(line, "layer %15s %lf %lf %lf %lf %lf %lf", layerName, &costs[0], &costs[1], &costs[2], &costs[3], &costs[4], &costs[5]) == NUM_LAYER_COSTS + 1) {
+			trace->layerCosts.push_back(costs);
+		} else {
+			fseek(fp, position, SEEK_SET);	// Start of the cell sections
+			break;
+		}
+		position = ftell(fp);
+	}
+	int status;
+	std::string name;
+	std::vector<double> values;
+	while ((status = ReadCells(fp, &name, &values)) > 0) {
+		trace->cellNames.push_back(name);
+		trace->cells.push_back(values);
+	}
+	fclose(fp);
+	return status == 0 && !trace->cells.empty();
+}
+
+/* Compare one value and print the first mismatches of each quantity */
+class Checker {
+public:
+	Checker(): numMismatches(0) {}
+	void Check(const std::string& what, double value, double golden, double relative, double absolute) {
+		double allowed = (fabs(golden) * relative + absolute) * tolerance;
+		if (fabs(value - golden) <= allowed && !std::isnan(value))
+			return;
+		numMismatches++;
+		if (numMismatches <= 10)
+			printf("\t%s: %.10g, golden %.10g (allowed difference %.3g)\n", what.c_str(), value, golden, allowed);
+	}
+	int numMismatches;
+};
+
+static void CompareCells(Checker *checker, const std::string& name, const std::vector<double>& values, const std::vector<double>& golden) {
+	if (values.size() != golden.size()) {
+		checker->Check("# of cells of " + name, values.size() / 3, golden.size() / 3, 0, 0);
+		return;
+	}
+	static const char *field[3] = {"conductance", "conductanceGp", "conductanceGn"};
+	for (int i=0; i<values.size(); i++) {
+		checker->Check(name + " cell " + std::to_string(i / 3) + " " + field[i % 3], values[i], golden[i], 1e-6, 1e-15);
+	}
+}
+
+static int Compare(const Trace& trace, const Trace& golden) {
+	Checker checker;
+	checker.Check("# of validations", trace.history.size(), golden.history.size(), 0, 0);
+	for (int i=0; i<trace.history.size() && i<golden.history.size(); i++) {
+		const SimulationResult& r = trace.history[i];
+		const SimulationResult& g = golden.history[i];
+		std::string epoch = "epoch " + std::to_string(g.stopEpoch) + " ";
+		checker.Check(epoch + "accuracy", r.accuracy, g.accuracy, 0, 1e-9);
+		checker.Check(epoch + "read latency", r.readLatency, g.readLatency, 1e-6, 0);
+		checker.Check(epoch + "write latency", r.writeLatency, g.writeLatency, 1e-6, 0);
+		checker.Check(epoch + "read energy", r.readEnergy, g.readEnergy, 1e-6, 0);
+		checker.Check(epoch + "write energy", r.writeEnergy, g.writeEnergy, 1e-6, 0);
+	}
+	checker.Check("area", trace.area, golden.area, 1e-6, 0);
+	checker.Check("leakage", trace.leakage, golden.leakage, 1e-6, 0);
+	checker.Check("# of layers", trace.cells.size(), golden.cells.size(), 0, 0);
+	checker.Check("# of layer costs", trace.layerCosts.size(), golden.layerCosts.size(), 0, 0);
+	for (int l=0; l<trace.layerCosts.size() && l<golden.layerCosts.size(); l++) {
+		for (int c=0; c<NUM_LAYER_COSTS; c++) {
+			checker.Check(trace.cellNames[l] + " " + layerCostNames[c], trace.layerCosts[l][c], golden.layerCosts[l][c], 1e-6, 0);
+		}
+	}
+	for (int l=0; l<trace.cells.size() && l<golden.cells.size(); l++) {
+		if (trace.cellNames[l] != golden.cellNames[l]) {
+			checker.numMismatches++;
+			printf("\tlayer %d: %s, golden %s\n", l + 1, trace.cellNames[l].c_str(), golden.cellNames[l].c_str());
+			continue;
+		}
+		CompareCells(&checker, trace.cellNames[l], trace.cells[l], golden.cells[l]);
+	}
+	return checker.numMismatches;
+}
+
+int main(int argc, char *argv[]) {
+	bool record = false, verbose = false;
+	for (int i=1; i<argc; i++) {
+		if (strcmp(argv[i], "--record") == 0) record = true;
+		if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+	}
+	const char *dir = GetCommandLineOption(argc, argv, "dir");
+	const char *filter = GetCommandLineOption(argc, argv, "filter");
+	const char *threads = GetCommandLineOption(argc, argv, "threads");
+	if (const char *option = GetCommandLineOption(argc, argv, "tolerance"))
+		tolerance = atof(option);
+	int numThreads = threads? atoi(threads) : 1;
+
+	int numFailed = 0, numRun = 0;
+	for (int c=0; c<goldenCases.size(); c++) {
+		const GoldenCase& goldenCase = goldenCases[c];
+		if (filter && !strstr(goldenCase.name, filter))
+			continue;
+		Param param;
+		for (int i=0; i<sizeof(commonArguments)/sizeof(commonArguments[0]); i++) {
+			ApplyArgument(&param, commonArguments[i]);
+		}
+		for (int i=0; i<goldenCase.arguments.size(); i++) {
+			ApplyArgument(&param, goldenCase.arguments[i]);
+		}
+		if (record && goldenCase.reference)	// No trace of its own
+			continue;
+		Dataset dataset(param);
+		dataset.GenerateSyntheticData(0);
+		omp_set_num_threads(goldenCase.numThreads > 0? goldenCase.numThreads : numThreads);
+		Trace trace = RunCase(param, dataset, verbose);
+		numRun++;
+
+		double finalAccuracy = trace.history.empty()? 0 : trace.history.back().accuracy;
+		double minAccuracy = 2 * 100.0 / param.nOutput;	// Twice the chance accuracy
+		if (finalAccuracy < minAccuracy) {
+			printf("%-28s FAIL (final accuracy %.2f%% below %.2f%%, the network does not learn)\n", goldenCase.name, finalAccuracy, minAccuracy);
+			numFailed++;
+			continue;
+		}
+		std::string fileName = std::string(dir? dir : "golden_traces") + "/" + (goldenCase.reference? goldenCase.reference : goldenCase.name) + ".txt";
+		if (record) {
+			WriteTrace(fileName.c_str(), goldenCase, trace);
+			printf("%-28s recorded to %s\n", goldenCase.name, fileName.c_str());
+			continue;
+		}
+		Trace golden;
+		if (!ReadTrace(fileName.c_str(), &golden)) {
+			printf("%-28s FAIL (cannot read %s, see make record-golden)\n", goldenCase.name, fileName.c_str());
+			numFailed++;
+			continue;
+		}
+		int numMismatches = Compare(trace, golden);
+		if (numMismatches > 0) {
+			printf("%-28s FAIL (%d mismatches)\n", goldenCase.name, numMismatches);
+			numFailed++;
+		} else {
+			printf("%-28s ok (final accuracy %.2f%%)\n", goldenCase.name, finalAccuracy);
+		}
+	}
+	if (!record) {
+		printf("%d of %d golden cases passed\n", numRun - numFailed, numRun);
+	}
+	return numFailed > 0? -1 : 0;
+}
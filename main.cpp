@@ -37,99 +37,37 @@
 ********************************************************************************/
 
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
-#include <random>
-#include <vector>
-#include "Cell.h"
-#include "Array.h"
-#include "formula.h"
-#include "NeuroSim.h"
 #include "Param.h"
 #include "IO.h"
-#include "Train.h"
-#include "Test.h"
-#include "Mapping.h"
-#include "Definition.h"
+#include "Config.h"
+#include "Simulator.h"
+#include "Sweep.h"
 
-int main() {
-	gen.seed(0);
-	
-	/* Load in MNIST data */
-	ReadTrainingDataFromFile("patch60000_train.txt", "label60000_train.txt");
-	ReadTestingDataFromFile("patch10000_test.txt", "label10000_test.txt");
-
-	/* Initialization of synaptic array from input to hidden layer */
-	//arrayIH->Initialization<IdealDevice>();
-	arrayIH->Initialization<RealDevice>();
-	//arrayIH->Initialization<MeasuredDevice>();
-	//arrayIH->Initialization<SRAM>(param->numWeightBit);
-	//arrayIH->Initialization<DigitalNVM>(param->numWeightBit);
-	
-	/* Initialization of synaptic array from hidden to output layer */
-	//arrayHO->Initialization<IdealDevice>();
-	arrayHO->Initialization<RealDevice>();
-	//arrayHO->Initialization<MeasuredDevice>();
-	//arrayHO->Initialization<SRAM>(param->numWeightBit);
-	//arrayHO->Initialization<DigitalNVM>(param->numWeightBit);
+int main(int argc, char *argv[]) {
+	/* Load the config files and command line overrides (see Config.h) */
+	Param param;
+	ParseCommandLine(&param, argc, argv);
 
-	/* Initialization of NeuroSim synaptic cores */
-	param->relaxArrayCellWidth = 0;
-	NeuroSimSubArrayInitialize(subArrayIH, arrayIH, inputParameterIH, techIH, cellIH);
-	param->relaxArrayCellWidth = 1;
-	NeuroSimSubArrayInitialize(subArrayHO, arrayHO, inputParameterHO, techHO, cellHO);
-	/* Calculate synaptic core area */
-	NeuroSimSubArrayArea(subArrayIH);
-	NeuroSimSubArrayArea(subArrayHO);
-	/* Calculate synaptic core standby leakage power */
-	NeuroSimSubArrayLeakagePower(subArrayIH);
-	NeuroSimSubArrayLeakagePower(subArrayHO);
-	
-	/* Initialize the neuron peripheries */
-	NeuroSimNeuronInitialize(subArrayIH, inputParameterIH, techIH, cellIH, adderIH, muxIH, muxDecoderIH, dffIH);
-	NeuroSimNeuronInitialize(subArrayHO, inputParameterHO, techHO, cellHO, adderHO, muxHO, muxDecoderHO, dffHO);
-	/* Calculate the area and standby leakage power of neuron peripheries below subArrayIH */
-	double heightNeuronIH, widthNeuronIH;
-	NeuroSimNeuronArea(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH, &heightNeuronIH, &widthNeuronIH);
-	double leakageNeuronIH = NeuroSimNeuronLeakagePower(subArrayIH, adderIH, muxIH, muxDecoderIH, dffIH);
-	/* Calculate the area and standby leakage power of neuron peripheries below subArrayHO */
-	double heightNeuronHO, widthNeuronHO;
-	NeuroSimNeuronArea(subArrayHO, adderHO, muxHO, muxDecoderHO, dffHO, &heightNeuronHO, &widthNeuronHO);
-	double leakageNeuronHO = NeuroSimNeuronLeakagePower(subArrayHO, adderHO, muxHO, muxDecoderHO, dffHO);
-	
-	/* Print the area of synaptic core and neuron peripheries */
-	double totalSubArrayArea = subArrayIH->usedArea + subArrayHO->usedArea;
-	double totalNeuronAreaIH = adderIH.area + muxIH.area + muxDecoderIH.area + dffIH.area;
-	double totalNeuronAreaHO = adderHO.area + muxHO.area + muxDecoderHO.area + dffHO.area;
-	printf("Total SubArray (synaptic core) area=%.4e m^2\n", totalSubArrayArea);
-	printf("Total Neuron (neuron peripheries) area=%.4e m^2\n", totalNeuronAreaIH + totalNeuronAreaHO);
-	printf("Total area=%.4e m^2\n", totalSubArrayArea + totalNeuronAreaIH + totalNeuronAreaHO);
-
-	/* Print the standby leakage power of synaptic core and neuron peripheries */
-	printf("Leakage power of subArrayIH is : %.4e W\n", subArrayIH->leakage);
-	printf("Leakage power of subArrayHO is : %.4e W\n", subArrayHO->leakage);
-	printf("Leakage power of NeuronIH is : %.4e W\n", leakageNeuronIH);
-	printf("Leakage power of NeuronHO is : %.4e W\n", leakageNeuronHO);
-	printf("Total leakage power of subArray is : %.4e W\n", subArrayIH->leakage + subArrayHO->leakage);
-	printf("Total leakage power of Neuron is : %.4e W\n", leakageNeuronIH + leakageNeuronHO);
-	
-	/* Initialize weights and map weights to conductances for hardware implementation */
-	WeightInitialize();
-	if (param->useHardwareInTraining) { WeightToConductance(); }
+	/* Load in MNIST data */
+	Dataset dataset(param);
+	dataset.ReadTrainingDataFromFile("patch60000_train.txt", "label60000_train.txt");
+	dataset.ReadTestingDataFromFile("patch10000_test.txt", "label10000_test.txt");
 
-	srand(0);	// Pseudorandom number seed
-	for (int i=1; i<=param->totalNumEpochs/param->interNumEpochs; i++) {
-		Train(param->numTrainImagesPerEpoch, param->interNumEpochs);
-		if (!param->useHardwareInTraining && param->useHardwareInTestingFF) { WeightToConductance(); }
-		Validate();
-		printf("Accuracy at %d epochs is : %.2f%\n", i*param->interNumEpochs, (double)correct/param->numMnistTestImages*100);
-		/* Here the performance metrics of subArray also includes that of neuron peripheries (see Train.cpp and Test.cpp) */
-		printf("\tRead latency=%.4e s\n", subArrayIH->readLatency + subArrayHO->readLatency);
-		printf("\tWrite latency=%.4e s\n", subArrayIH->writeLatency + subArrayHO->writeLatency);
-		printf("\tRead energy=%.4e J\n", arrayIH->readEnergy + subArrayIH->readDynamicEnergy + arrayHO->readEnergy + subArrayHO->readDynamicEnergy);
-		printf("\tWrite energy=%.4e J\n", arrayIH->writeEnergy + subArrayIH->writeDynamicEnergy + arrayHO->writeEnergy + subArrayHO->writeDynamicEnergy);
+	/* Sweep mode: ./main [config] --sweep=<file> [--jobs=N] [--output=<file>] */
+	const char *sweepFileName = GetCommandLineOption(argc, argv, "sweep");
+	if (sweepFileName) {
+		const char *numJobs = GetCommandLineOption(argc, argv, "jobs");
+		const char *outputFileName = GetCommandLineOption(argc, argv, "output");
+		RunSweep(sweepFileName, numJobs? atoi(numJobs) : 1, outputFileName? outputFileName : "sweep_result.txt", param, dataset);
+		return 0;
 	}
+
+	SimulationResult result;
+	Simulator *simulator = new Simulator(param, dataset);
+	simulator->Run(&result);
+	delete simulator;
 	printf("\n");
 	return 0;
 }
-
-
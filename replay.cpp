@@ -0,0 +1,125 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+/* Offline NeuroSim cost of a recorded run (see ActivityTrace.h)
+ *   ./main [config] activityTraceFile=run.act
+ *   ./replay --trace=run.act [config] [key=value ...] [--sweep=<file>] [--output=<file>]
+ * The configuration is the one of the recording run with any peripheral parameter changed
+ * (numColMuxed, clkFreq, processNode, relaxArrayCellHeight/Width, ...). processNode only
+ * re-evaluates the NeuroSim peripherals, the cell-level array energy stays the recorded one.
+ * Parameters that change the recorded activity (network size, device types, numBitInput,
+ * numWeightBit, numWriteColMuxed, numBitPartialSum, useHardwareInTraining*) must stay the same.
+ * The aggregated replay evaluates the first record of a core warm, so SRAM runs differ from
+ * ./main by the cold first call of the recording run (it fades out with the run length).
+ * Without --sweep the cumulative latency and energy are printed after every recorded
+ * validation; with --sweep every line of the sweep file is replayed on top of the
+ * configuration and the results are written to --output (default replay_result.txt). */
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Param.h"
+#include "IO.h"
+#include "Config.h"
+#include "NeuroSim.h"
+#include "Simulator.h"
+#include "ActivityTrace.h"
+#include "Sweep.h"
+
+int main(int argc, char *argv[]) {
+	const char *traceFileName = GetCommandLineOption(argc, argv, "trace");
+	if (!traceFileName) {
+		puts("Usage: ./replay --trace=<file> [config] [key=value ...] [--sweep=<file>] [--output=<file>]");
+		exit(-1);
+	}
+	Param param;
+	ParseCommandLine(&param, argc, argv);
+
+	const char *sweepFileName = GetCommandLineOption(argc, argv, "sweep");
+	if (!sweepFileName) {
+		ReplayConfiguration configuration;
+		ReplayActivityTrace(traceFileName, param, &configuration);
+		printf("Total area=%.4e m^2\n", configuration.area);
+		printf("Total leakage power=%.4e W\n", configuration.leakage);
+		for (int i=0; i<configuration.results.size(); i++) {
+			const ReplayResult& r = configuration.results[i];
+			printf("Accuracy at %d epochs is : %.2f%% (recorded)\n", r.epoch, r.accuracy);
+			printf("\tRead latency=%.4e s\n", r.readLatency);
+			printf("\tWrite latency=%.4e s\n", r.writeLatency);
+			printf("\tRead energy=%.4e J\n", r.readEnergy);
+			printf("\tWrite energy=%.4e J\n", r.writeEnergy);
+		}
+		return 0;
+	}
+
+	std::vector<std::string> configs = ReadSweepFile(sweepFileName);
+	const char *outputFileName = GetCommandLineOption(argc, argv, "output");
+	if (!outputFileName)
+		outputFileName = "replay_result.txt";
+	FILE *fp = fopen(outputFileName, "w");
+	if (!fp) {
+		printf("Cannot open %s\n", outputFileName);
+		exit(-1);
+	}
+	fprintf(fp, "id\tepoch\tarea(m^2)\tleakage(W)\treadLatency(s)\twriteLatency(s)\treadEnergy(J)\twriteEnergy(J)\tconfiguration\n");
+	for (int c=0; c<configs.size(); c++) {
+		Param configParam(param);
+		std::istringstream args(configs[c]);
+		std::string arg;
+		while (args >> arg) {
+			ApplyArgument(&configParam, arg);
+		}
+		ReplayConfiguration configuration;
+		ReplayActivityTrace(traceFileName, configParam, &configuration);
+		if (configuration.results.empty()) {
+			printf("%s has no completed section\n", traceFileName);
+			exit(-1);
+		}
+		const ReplayResult& r = configuration.results.back();
+		fprintf(fp, "%d\t%d\t%.4e\t%.4e\t%.4e\t%.4e\t%.4e\t%.4e\t%s\n", c, r.epoch, configuration.area, configuration.leakage,
+				r.readLatency, r.writeLatency, r.readEnergy, r.writeEnergy, configs[c].c_str());
+		printf("Configuration %d: read latency=%.4e s, write latency=%.4e s, read energy=%.4e J, write energy=%.4e J (%s)\n",
+				c, r.readLatency, r.writeLatency, r.readEnergy, r.writeEnergy, configs[c].c_str());
+		fflush(stdout);
+	}
+	fclose(fp);
+	printf("%d configurations written to %s\n", (int)configs.size(), outputFileName);
+	return 0;
+}
@@ -0,0 +1,260 @@
+/*******************************************************************************
+* Copyright (c) 2015-2017
+* School of Electrical, Computer and Energy Engineering, Arizona State University
+* PI: Prof. Shimeng Yu
+* All rights reserved.
+*   
+* This source code is part of NeuroSim - a device-circuit-algorithm framework to benchmark 
+* neuro-inspired architectures with synaptic devices(e.g., SRAM and emerging non-volatile memory). 
+* Copyright of the model is maintained by the developers, and the model is distributed under 
+* the terms of the Creative Commons Attribution-NonCommercial 4.0 International Public License 
+* http://creativecommons.org/licenses/by-nc/4.0/legalcode.
+* The source code is free and you can redistribute and/or modify it
+* by providing that the following conditions are met:
+*   
+*  1) Redistributions of source code must retain the above copyright notice,
+*     this list of conditions and the following disclaimer. 
+*   
+*  2) Redistributions in binary form must reproduce the above copyright notice,
+*     this list of conditions and the following disclaimer in the documentation
+*     and/or other materials provided with the distribution.
+*   
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+* ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+* 
+* Developer list: 
+*   Pai-Yu Chen     Email: pchen72 at asu dot edu 
+*                     
+*   Xiaochen Peng   Email: xpeng15 at asu dot edu
+********************************************************************************/
+
+/* Energy-delay tuner of the peripheral circuit parameters
+ *   ./tune [config] [key=value ...] [--devices=<list>] [--numColMuxed=<list>]
+ *          [--numWriteColMuxed=<list>] [--numBitPartialSum=<list>] [--min-accuracy=<%>]
+ *          [--max-accuracy-loss=<%>] [--probe-epochs=<N>] [--probe-test-images=<N>]
+ *          [--jobs=<N>] [--output=<file>]
+ * numBitPartialSum changes the accuracy (the ADC quantization of CurrentToDigits) and
+ * numWriteColMuxed the recorded write activity, so every (device, numWriteColMuxed,
+ * numBitPartialSum) is trained by a short accuracy probe (probe-epochs epochs of the
+ * configuration, validated on the first probe-test-images testing images) that records
+ * an activity trace. numColMuxed only changes the NeuroSim cost, so it is swept by
+ * replaying the trace of every probe (see ActivityTrace.h) instead of more training.
+ * The accuracy floor of a device is the larger of min-accuracy and its best probe
+ * accuracy minus max-accuracy-loss (default 1%). Among the points above the floor the
+ * energy-latency Pareto front is marked and the point with the lowest energy-delay
+ * product of the probe is recommended per device. SRAM does not use numBitPartialSum and
+ * is only probed with the first value of the list. The probes log to tune_<i>.log and
+ * keep their traces in tune_<i>.act for ./replay; all points are written to --output
+ * (default tune_result.txt). */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "Param.h"
+#include "IO.h"
+#include "Config.h"
+#include "Simulator.h"
+#include "ActivityTrace.h"
+#include "Sweep.h"
+
+static const char *deviceNames[] = {"IdealDevice", "RealDevice", "MeasuredDevice", "SRAM", "DigitalNVM"};	// Param::DeviceType order
+
+/* One tuned configuration */
+struct TunePoint {
+	int device;		// Index in the --devices list
+	int numColMuxed, numWriteColMuxed, numBitPartialSum;
+	bool valid;		// Replayed and the peripherals fit the arrays
+	double accuracy;	// Probe accuracy (%)
+	double area, leakage;
+	double latency;	// Read and write latency of the probe (s)
+	double energy;	// Read and write energy of the probe (J)
+	bool feasible;	// Valid and above the accuracy floor of the device
+	bool pareto;	// Not dominated in energy and latency by a feasible point of the same device
+};
+
+/* Comma separated list of --name, or defaultList */
+static std::vector<std::string> List(int argc, char *argv[], const char *name, const std::string& defaultList) {
+	const char *list = GetCommandLineOption(argc, argv, name);
+	std::stringstream ss(list? list : defaultList);
+	std::vector<std::string> values;
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		if (!item.empty())
+			values.push_back(item);
+	}
+	if (values.empty()) {
+		printf("Empty list for --%s\n", name);
+		exit(-1);
+	}
+	return values;
+}
+
+int main(int argc, char *argv[]) {
+	Param param;
+	ParseCommandLine(&param, argc, argv);
+	std::vector<std::string> devices = List(argc, argv, "devices", deviceNames[param.deviceTypeIH]);
+	std::vector<std::string> numColMuxeds = List(argc, argv, "numColMuxed", "4,8,16,32");
+	std::vector<std::string> numWriteColMuxeds = List(argc, argv, "numWriteColMuxed", "4,8,16,32");
+	std::vector<std::string> numBitPartialSums = List(argc, argv, "numBitPartialSum", "4,5,6,7,8");
+	double minAccuracy = 0, maxAccuracyLoss = 1;
+	int probeEpochs = 2, probeTestImages = 1000;
+	int numJobs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (const char *option = GetCommandLineOption(argc, argv, "min-accuracy"))
+		minAccuracy = atof(option);
+	if (const char *option = GetCommandLineOption(argc, argv, "max-accuracy-loss"))
+		maxAccuracyLoss = atof(option);
+	if (const char *option = GetCommandLineOption(argc, argv, "probe-epochs"))
+		probeEpochs = atoi(option);
+	if (const char *option = GetCommandLineOption(argc, argv, "probe-test-images"))
+		probeTestImages = atoi(option);
+	if (const char *option = GetCommandLineOption(argc, argv, "jobs"))
+		numJobs = atoi(option);
+	const char *outputFileName = GetCommandLineOption(argc, argv, "output");
+	if (!outputFileName)
+		outputFileName = "tune_result.txt";
+	if (probeEpochs < 1 || probeTestImages < 1) {
+		puts("The probes need at least 1 epoch and 1 testing image");
+		exit(-1);
+	}
+
+	/* Short probes: one validation at the end, on a smaller testing set */
+	param.totalNumEpochs = probeEpochs;
+	param.interNumEpochs = probeEpochs;
+	if (probeTestImages < param.numMnistTestImages)
+		param.numMnistTestImages = probeTestImages;
+	Dataset dataset(param);
+	dataset.ReadTrainingDataFromFile("patch60000_train.txt", "label60000_train.txt");
+	dataset.ReadTestingDataFromFile("patch10000_test.txt", "label10000_test.txt");
+
+	/* One probe per parameter set that changes the recorded activity */
+	std::vector<std::string> probes;
+	std::vector<TunePoint> probePoints;
+	for (int d=0; d<devices.size(); d++)
+	for (int w=0; w<numWriteColMuxeds.size(); w++)
+	for (int b=0; b<numBitPartialSums.size(); b++) {
+		if (devices[d] == "SRAM" && b > 0)
+			break;	// The digital SRAM read does not use numBitPartialSum
+		std::string probe = "deviceTypeIH=" + devices[d] + " deviceTypeHO=" + devices[d]
+				+ " numWriteColMuxed=" + numWriteColMuxeds[w] + " numBitPartialSum=" + numBitPartialSums[b]
+				+ " activityTraceFile=tune_" + std::to_string(probes.size()) + ".act";
+		probes.push_back(probe);
+		TunePoint point = TunePoint();
+		point.device = d;
+		point.numWriteColMuxed = atoi(numWriteColMuxeds[w].c_str());
+		point.numBitPartialSum = atoi(numBitPartialSums[b].c_str());
+		probePoints.push_back(point);
+	}
+	printf("[Tune] %d probes of %d epochs x %d images, %d numColMuxed values replayed per probe\n",
+			(int)probes.size(), probeEpochs, param.numTrainImagesPerEpoch, (int)numColMuxeds.size());
+	std::vector<SimulationResult> probeResults;
+	std::vector<bool> succeeded;
+	RunConfigurations(probes, numJobs, "tune", param, dataset, &probeResults, &succeeded);
+
+	/* Cost of every numColMuxed from the trace of its probe */
+	std::vector<TunePoint> points;
+	for (int p=0; p<probes.size(); p++) {
+		for (int m=0; m<numColMuxeds.size(); m++) {
+			TunePoint point = probePoints[p];
+			point.numColMuxed = atoi(numColMuxeds[m].c_str());
+			point.valid = false;
+			if (succeeded[p]) {
+				Param replayParam(param);
+				std::istringstream args(probes[p] + " numColMuxed=" + numColMuxeds[m]);
+				std::string arg;
+				while (args >> arg) {
+					ApplyArgument(&replayParam, arg);
+				}
+				ReplayConfiguration configuration;
+				ReplayActivityTrace(replayParam.activityTraceFile.c_str(), replayParam, &configuration);
+				if (!configuration.results.empty()) {
+					const ReplayResult& r = configuration.results.back();
+					point.accuracy = probeResults[p].accuracy;
+					point.area = configuration.area;
+					point.leakage = configuration.leakage;
+					point.latency = r.readLatency + r.writeLatency;
+					point.energy = r.readEnergy + r.writeEnergy;
+					point.valid = point.area > 0 && std::isfinite(point.area) && std::isfinite(point.latency) && std::isfinite(point.energy);
+				}
+			}
+			points.push_back(point);
+		}
+	}
+
+	/* Accuracy floor, Pareto front and recommendation per device */
+	std::vector<int> recommended(devices.size(), -1);
+	for (int d=0; d<devices.size(); d++) {
+		double bestAccuracy = -1;
+		for (int i=0; i<points.size(); i++) {
+			if (points[i].device == d && points[i].valid && points[i].accuracy > bestAccuracy)
+				bestAccuracy = points[i].accuracy;
+		}
+		double floor = std::max(minAccuracy, bestAccuracy - maxAccuracyLoss);
+		for (int i=0; i<points.size(); i++) {
+			points[i].feasible = points[i].feasible || (points[i].device == d && points[i].valid && points[i].accuracy >= floor);
+		}
+		for (int i=0; i<points.size(); i++) {
+			TunePoint& point = points[i];
+			if (point.device != d || !point.feasible)
+				continue;
+			point.pareto = true;
+			for (int j=0; j<points.size(); j++) {
+				const TunePoint& other = points[j];
+				if (other.device == d && other.feasible && other.energy <= point.energy && other.latency <= point.latency
+						&& (other.energy < point.energy || other.latency < point.latency)) {
+					point.pareto = false;
+					break;
+				}
+			}
+			if (recommended[d] < 0 || point.energy * point.latency < points[recommended[d]].energy * points[recommended[d]].latency)
+				recommended[d] = i;
+		}
+		printf("[Tune] %s: best probe accuracy %.2f%%, accuracy floor %.2f%%\n", devices[d].c_str(), bestAccuracy, floor);
+		for (int i=0; i<points.size(); i++) {
+			const TunePoint& point = points[i];
+			if (point.device == d && point.pareto) {
+				printf("\tPareto numColMuxed=%d numWriteColMuxed=%d numBitPartialSum=%d: accuracy=%.2f%%, latency=%.4e s, energy=%.4e J, EDP=%.4e J*s\n",
+						point.numColMuxed, point.numWriteColMuxed, point.numBitPartialSum, point.accuracy, point.latency, point.energy, point.energy * point.latency);
+			}
+		}
+		if (recommended[d] < 0) {
+			printf("\tNo configuration reaches the accuracy floor\n");
+		} else {
+			const TunePoint& point = points[recommended[d]];
+			printf("\tRecommended: deviceTypeIH=%s deviceTypeHO=%s numColMuxed=%d numWriteColMuxed=%d numBitPartialSum=%d\n",
+					devices[d].c_str(), devices[d].c_str(), point.numColMuxed, point.numWriteColMuxed, point.numBitPartialSum);
+		}
+	}
+
+	FILE *fp = fopen(outputFileName, "w");
+	if (!fp) {
+		printf("Cannot open %s\n", outputFileName);
+		exit(-1);
+	}
+	fprintf(fp, "device\tnumColMuxed\tnumWriteColMuxed\tnumBitPartialSum\tstatus\taccuracy(%%)\tarea(m^2)\tleakage(W)\tlatency(s)\tenergy(J)\tEDP(J*s)\tpareto\trecommended\n");
+	for (int i=0; i<points.size(); i++) {
+		const TunePoint& point = points[i];
+		fprintf(fp, "%s\t%d\t%d\t%d\t", devices[point.device].c_str(), point.numColMuxed, point.numWriteColMuxed, point.numBitPartialSum);
+		if (!point.valid) {
+			fprintf(fp, "failed\t\t\t\t\t\t\t\t\n");
+			continue;
+		}
+		fprintf(fp, "%s\t%.2f\t%.4e\t%.4e\t%.4e\t%.4e\t%.4e\t%d\t%d\n", point.feasible? "ok" : "below floor", point.accuracy, point.area, point.leakage,
+				point.latency, point.energy, point.energy * point.latency, (int)point.pareto, (int)(recommended[point.device] == i));
+	}
+	fclose(fp);
+	printf("[Tune] %d points written to %s\n", (int)points.size(), outputFileName);
+	return 0;
+}